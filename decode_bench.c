@@ -0,0 +1,269 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Message decoder benchmark: decodes the downlink messages read from
+// stdin (e.g. the decompressed sample data) with uat_decode_adsb_mdb_fields()
+// and every combination of sections, and reports the time of each in
+// ns/frame.
+// It also compares uat_decode_uplink_mdb() and the uplink info frame
+// iterator for finding NEXRAD products.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "uat.h"
+#include "reader.h"
+#include "uat_decode.h"
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct frame_list {
+    uint8_t (*frames)[LONG_FRAME_DATA_BYTES];
+    int count, size;
+};
+
+struct uplink_list {
+    uint8_t (*frames)[UPLINK_FRAME_DATA_BYTES];
+    int count, size;
+};
+
+struct input {
+    struct frame_list downlink;
+    struct uplink_list uplink;
+};
+
+// Make room for one more element in an array of 'size' elements
+static void *grow(void *array, int count, int *size, size_t element_size)
+{
+    if (count < *size)
+        return array;
+
+    *size = (*size ? *size * 2 : 1024);
+    if (!(array = realloc(array, *size * element_size))) {
+        perror("realloc");
+        exit(1);
+    }
+    return array;
+}
+
+static void collect_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    struct input *input = d;
+
+    if (t == UAT_DOWNLINK) {
+        struct frame_list *list = &input->downlink;
+
+        list->frames = grow(list->frames, list->count, &list->size, sizeof(*list->frames));
+        memset(list->frames[list->count], 0, LONG_FRAME_DATA_BYTES);
+        memcpy(list->frames[list->count], f, l);
+        ++list->count;
+    } else if (t == UAT_UPLINK) {
+        struct uplink_list *list = &input->uplink;
+
+        list->frames = grow(list->frames, list->count, &list->size, sizeof(*list->frames));
+        memcpy(list->frames[list->count], f, UPLINK_FRAME_DATA_BYTES);
+        ++list->count;
+    }
+}
+
+// Every combination of sections; the header is always decoded
+#define N_COMBINATIONS 32
+
+static unsigned combination(int i)
+{
+    return UAT_DECODE_HDR | (i << 1);
+}
+
+static void describe(unsigned fields, char *buf)
+{
+    static const struct {
+        unsigned bit;
+        const char *name;
+    } names[] = {
+        { UAT_DECODE_POSITION, "pos" },
+        { UAT_DECODE_VELOCITY, "vel" },
+        { UAT_DECODE_DIMENSIONS, "dim" },
+        { UAT_DECODE_MS, "ms" },
+        { UAT_DECODE_AUXSV, "auxsv" },
+    };
+    unsigned i;
+
+    strcpy(buf, "hdr");
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (fields & names[i].bit) {
+            strcat(buf, "+");
+            strcat(buf, names[i].name);
+        }
+    }
+}
+
+static volatile uint32_t sink;
+
+static double time_fields(const struct frame_list *list, unsigned fields, int repeat)
+{
+    struct uat_adsb_mdb mdb;
+    uint32_t sum = 0;
+    double start;
+    int i, j;
+
+    memset(&mdb, 0, sizeof(mdb));
+    start = now();
+    for (i = 0; i < repeat; ++i) {
+        for (j = 0; j < list->count; ++j) {
+            uat_decode_adsb_mdb_fields(list->frames[j], &mdb, fields);
+            sum += mdb.address;
+        }
+    }
+    sink = sum;
+
+    return (now() - start) * 1e9 / ((double) repeat * list->count);
+}
+
+// Finding the NEXRAD (product 63 and 64) APDUs in each uplink frame, as
+// extract_nexrad does, by decoding the whole message or with the iterator
+static void bench_uplink(const struct uplink_list *list, int repeat)
+{
+    static struct uat_uplink_mdb mdb;
+    double start, mdb_time, iter_time;
+    uint32_t sum = 0;
+    int i, j;
+    unsigned k;
+
+    repeat = repeat / 10 + 1;
+
+    start = now();
+    for (i = 0; i < repeat; ++i) {
+        for (j = 0; j < list->count; ++j) {
+            uat_decode_uplink_mdb(list->frames[j], &mdb);
+            if (!mdb.app_data_valid)
+                continue;
+            for (k = 0; k < mdb.num_info_frames; ++k) {
+                struct uat_uplink_info_frame *info = &mdb.info_frames[k];
+                if (info->is_fisb && (info->fisb.product_id == 63 || info->fisb.product_id == 64))
+                    sum += info->fisb.hours;
+            }
+        }
+    }
+    mdb_time = (now() - start) * 1e9 / ((double) repeat * list->count);
+
+    start = now();
+    for (i = 0; i < repeat; ++i) {
+        for (j = 0; j < list->count; ++j) {
+            struct uat_uplink_iter iter;
+            struct uat_uplink_info_frame info;
+
+            uat_uplink_iter_init(&iter, list->frames[j]);
+            while (uat_uplink_iter_next(&iter, &info)) {
+                int product_id = uat_uplink_info_frame_product_id(&info);
+                if ((product_id == 63 || product_id == 64) && uat_decode_info_frame_fisb(&info))
+                    sum += info.fisb.hours;
+            }
+        }
+    }
+    iter_time = (now() - start) * 1e9 / ((double) repeat * list->count);
+    sink = sum;
+
+    printf("\nfinding NEXRAD APDUs in %d uplink messages %d times:\n", list->count, repeat);
+    printf("%-26s %10s %8s\n", "method", "ns/frame", "speedup");
+    printf("%-26s %10.1f %7.2fx\n", "uat_decode_uplink_mdb", mdb_time, 1.0);
+    printf("%-26s %10.1f %7.2fx\n", "uat_uplink_iter", iter_time, mdb_time / iter_time);
+}
+
+static void usage(int argc, char **argv)
+{
+    fprintf(stderr,
+            "Syntax: %s [-n REPEAT]\n"
+            "\n"
+            "Benchmarks decoding selected sections of the downlink messages, and finding\n"
+            "NEXRAD products in the uplink messages, on stdin, e.g.:\n"
+            "  zcat sample-data.txt.gz | %s\n"
+            "\n"
+            "  -n REPEAT  Times to decode each message per combination (default 1000)\n"
+            "  -h         Show this usage message\n",
+            argv[0], argv[0]);
+}
+
+int main(int argc, char **argv)
+{
+    struct dump978_reader *reader;
+    struct input input;
+    struct frame_list *list = &input.downlink;
+    double full_time;
+    int repeat = 1000;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "hn:")) > 0) {
+        switch (opt) {
+        case 'h':
+            usage(argc, argv);
+            return 0;
+        case 'n':
+            repeat = atoi(optarg);
+            if (repeat <= 0) {
+                fprintf(stderr, "repeat count must be positive\n");
+                return 1;
+            }
+            break;
+        default:
+            usage(argc, argv);
+            return 1;
+        }
+    }
+
+    reader = dump978_reader_new(0, 0);
+    memset(&input, 0, sizeof(input));
+    while (dump978_read_frames(reader, collect_frame, &input) > 0)
+        ;
+    dump978_reader_free(reader);
+
+    if (list->count == 0) {
+        fprintf(stderr, "no downlink messages to benchmark\n");
+        return 1;
+    }
+
+    // speedups are relative to a full decode
+    time_fields(list, UAT_DECODE_ALL, repeat / 10 + 1); // warm up
+    full_time = time_fields(list, UAT_DECODE_ALL, repeat);
+
+    printf("decoding %d downlink messages %d times:\n", list->count, repeat);
+    printf("%-26s %10s %8s\n", "sections", "ns/frame", "speedup");
+
+    for (i = 0; i < N_COMBINATIONS; ++i) {
+        unsigned fields = combination(i);
+        char name[64];
+        double t = time_fields(list, fields, repeat);
+
+        describe(fields, name);
+        printf("%-26s %10.1f %7.2fx\n", name, t, full_time / t);
+    }
+
+    if (input.uplink.count > 0)
+        bench_uplink(&input.uplink, repeat);
+
+    free(input.downlink.frames);
+    free(input.uplink.frames);
+    return 0;
+}
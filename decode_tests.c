@@ -0,0 +1,341 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Tests for the message decoder.
+//
+// Decoding selected sections of the test frames must match a full
+// decode, leaving the unrequested fields alone. The uplink info frame
+// iterator must find the same info frames as a full uplink decode.
+//
+// Track, speed and callsigns are decoded with integer arithmetic and
+// tables generated at build time, which must give exactly the results of
+// the floating point and division formulas they replaced, for every
+// possible input.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "uat.h"
+#include "reader.h"
+#include "uat_decode.h"
+
+static uint8_t (*downlink)[LONG_FRAME_DATA_BYTES];
+static int n_downlink;
+static uint8_t (*uplink)[UPLINK_FRAME_DATA_BYTES];
+static int n_uplink;
+
+// Make room for one more element in an array of 'size' elements
+static void *grow(void *array, int count, int *size, size_t element_size)
+{
+    if (count < *size)
+        return array;
+
+    *size = (*size ? *size * 2 : 1024);
+    if (!(array = realloc(array, *size * element_size))) {
+        perror("realloc");
+        exit(1);
+    }
+    return array;
+}
+
+static void load_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    static int downlink_size, uplink_size;
+
+    if (t == UAT_DOWNLINK) {
+        // short frames are zero padded, as the decoder expects
+        downlink = grow(downlink, n_downlink, &downlink_size, sizeof(*downlink));
+        memset(downlink[n_downlink], 0, LONG_FRAME_DATA_BYTES);
+        memcpy(downlink[n_downlink], f, l);
+        ++n_downlink;
+    } else if (t == UAT_UPLINK) {
+        uplink = grow(uplink, n_uplink, &uplink_size, sizeof(*uplink));
+        memcpy(uplink[n_uplink], f, UPLINK_FRAME_DATA_BYTES);
+        ++n_uplink;
+    }
+}
+
+static int load_frames(const char *path)
+{
+    struct dump978_reader *reader;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        perror(path);
+        return 0;
+    }
+
+    reader = dump978_reader_new(fd, 0);
+    while (dump978_read_frames(reader, load_frame, NULL) > 0)
+        ;
+    dump978_reader_free(reader);
+    close(fd);
+
+    return (n_downlink > 0 && n_uplink > 0);
+}
+
+// The velocity decode computes track and speed with integer arithmetic
+// and tables; check it against the floating point formulas it replaced,
+// for every possible pair of velocities
+static int test_velocity(void)
+{
+    int state, raw_ns, raw_ew, checked = 0;
+
+    fprintf(stderr, "checking track and speed for all velocities: ");
+
+    for (state = AG_SUBSONIC; state <= AG_SUPERSONIC; ++state) {
+        for (raw_ns = 0; raw_ns < 2048; ++raw_ns) {
+            for (raw_ew = 0; raw_ew < 2048; ++raw_ew) {
+                uint8_t frame[LONG_FRAME_DATA_BYTES];
+                struct uat_adsb_mdb mdb;
+                track_type_t track_type = TT_INVALID;
+                uint16_t track = 0, speed = 0;
+
+                memset(frame, 0, sizeof(frame));
+                frame[12] = (state << 6) | (raw_ns >> 6);
+                frame[13] = ((raw_ns & 0x3f) << 2) | (raw_ew >> 9);
+                frame[14] = (raw_ew >> 1) & 0xff;
+                frame[15] = (raw_ew & 1) << 7;
+                uat_decode_adsb_mdb_fields(frame, &mdb, UAT_DECODE_HDR | UAT_DECODE_VELOCITY);
+
+                if (!mdb.ns_vel_valid || !mdb.ew_vel_valid)
+                    continue;
+
+                if (mdb.ns_vel != 0 || mdb.ew_vel != 0) {
+                    track_type = TT_TRACK;
+                    track = (uint16_t)round((360.0 + 90.0 - atan2(mdb.ns_vel, mdb.ew_vel) * 180.0 / M_PI)) % 360;
+                }
+                speed = (int)round(sqrt(mdb.ns_vel * mdb.ns_vel + mdb.ew_vel * mdb.ew_vel));
+
+                if (mdb.track_type != track_type || mdb.track != track || !mdb.speed_valid || mdb.speed != speed) {
+                    fprintf(stderr, "FAIL: ns_vel %d ew_vel %d: track %u speed %u, expected track %u speed %u\n",
+                            mdb.ns_vel, mdb.ew_vel, mdb.track, mdb.speed, track, speed);
+                    return 0;
+                }
+                ++checked;
+            }
+        }
+    }
+
+    fprintf(stderr, "PASS (%d pairs)\n", checked);
+    return 1;
+}
+
+// Likewise for the base 40 callsign decode, for every 16-bit value
+static int test_callsign(void)
+{
+    static const char alphabet[40] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ  ..";
+    unsigned v;
+
+    fprintf(stderr, "checking callsign decoding for all values: ");
+
+    for (v = 0; v < 65536; ++v) {
+        uint8_t frame[LONG_FRAME_DATA_BYTES];
+        struct uat_adsb_mdb mdb;
+        char callsign[9];
+        int i;
+
+        memset(frame, 0, sizeof(frame));
+        frame[0] = 1 << 3; // HDR SV MS AUXSV
+        for (i = 17; i < 23; i += 2) {
+            frame[i] = v >> 8;
+            frame[i + 1] = v & 0xff;
+        }
+        uat_decode_adsb_mdb_fields(frame, &mdb, UAT_DECODE_HDR | UAT_DECODE_MS);
+
+        callsign[0] = alphabet[(v / 40) % 40];
+        callsign[1] = alphabet[v % 40];
+        for (i = 2; i < 8; i += 3) {
+            callsign[i] = alphabet[(v / 1600) % 40];
+            callsign[i + 1] = alphabet[(v / 40) % 40];
+            callsign[i + 2] = alphabet[v % 40];
+        }
+        callsign[8] = 0;
+        for (i = 7; i >= 0 && callsign[i] == ' '; --i)
+            callsign[i] = 0;
+
+        if (mdb.emitter_category != (v / 1600) % 40 || memcmp(mdb.callsign, callsign, sizeof(callsign))) {
+            fprintf(stderr, "FAIL: value %u: emitter category %u callsign '%s', expected %u '%s'\n",
+                    v, mdb.emitter_category, mdb.callsign, (v / 1600) % 40, callsign);
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "PASS\n");
+    return 1;
+}
+
+#define SAME(field) (a->field == b->field)
+
+// Compare the fields that belong to the sections in 'fields'
+static int same_fields(const struct uat_adsb_mdb *a, const struct uat_adsb_mdb *b, unsigned fields)
+{
+    if ((fields & UAT_DECODE_HDR) &&
+        !(SAME(mdb_type) && SAME(address_qualifier) && SAME(address)))
+        return 0;
+
+    if ((fields & UAT_DECODE_POSITION) &&
+        !(SAME(position_valid) && SAME(lat) && SAME(lon) && SAME(altitude_type) && SAME(altitude) &&
+          SAME(nic) && SAME(utc_coupled) && SAME(tisb_site_id)))
+        return 0;
+
+    if ((fields & UAT_DECODE_VELOCITY) &&
+        !(SAME(airground_state) && SAME(ns_vel_valid) && SAME(ns_vel) && SAME(ew_vel_valid) && SAME(ew_vel) &&
+          SAME(track_type) && SAME(track) && SAME(speed_valid) && SAME(speed) &&
+          SAME(vert_rate_source) && SAME(vert_rate)))
+        return 0;
+
+    if ((fields & UAT_DECODE_DIMENSIONS) &&
+        !(SAME(dimensions_valid) && SAME(length) && SAME(width) && SAME(position_offset)))
+        return 0;
+
+    if ((fields & UAT_DECODE_MS) &&
+        !(SAME(emitter_category) && SAME(callsign_type) && !memcmp(a->callsign, b->callsign, sizeof(a->callsign)) &&
+          SAME(emergency_status) && SAME(uat_version) && SAME(sil) && SAME(transmit_mso) &&
+          SAME(nac_p) && SAME(nac_v) && SAME(nic_baro) && SAME(has_cdti) && SAME(has_acas) &&
+          SAME(acas_ra_active) && SAME(ident_active) && SAME(atc_services) && SAME(heading_type)))
+        return 0;
+
+    if ((fields & UAT_DECODE_AUXSV) &&
+        !(SAME(sec_altitude_type) && SAME(sec_altitude)))
+        return 0;
+
+    return 1;
+}
+
+#undef SAME
+
+// Every combination of sections; the header is always decoded
+#define N_COMBINATIONS 32
+
+// uat_decode_adsb_mdb_fields() must decode the requested sections of the
+// test frames exactly as uat_decode_adsb_mdb() does, and leave the fields
+// of the others alone
+static int test_fields(void)
+{
+    int i, j, ok = 1;
+
+    fprintf(stderr, "checking %d combinations of sections on %d frames: ", N_COMBINATIONS, n_downlink);
+
+    for (i = 0; i < N_COMBINATIONS && ok; ++i) {
+        unsigned fields = UAT_DECODE_HDR | (i << 1);
+
+        for (j = 0; j < n_downlink; ++j) {
+            struct uat_adsb_mdb ref, poison, mdb;
+
+            uat_decode_adsb_mdb(downlink[j], &ref);
+            memset(&poison, 0xA5, sizeof(poison));
+            mdb = poison;
+            uat_decode_adsb_mdb_fields(downlink[j], &mdb, fields);
+
+            if (!same_fields(&mdb, &ref, fields) ||
+                !same_fields(&mdb, &poison, UAT_DECODE_ALL & ~fields) ||
+                mdb.has_sv != (ref.has_sv && (fields & (UAT_DECODE_POSITION | UAT_DECODE_VELOCITY | UAT_DECODE_DIMENSIONS))) ||
+                mdb.has_ms != (ref.has_ms && (fields & UAT_DECODE_MS)) ||
+                mdb.has_auxsv != (ref.has_auxsv && (fields & UAT_DECODE_AUXSV))) {
+                fprintf(stderr, "FAIL: sections %02x differ from a full decode on frame %d\n", fields, j);
+                ok = 0;
+                break;
+            }
+        }
+    }
+
+    if (ok)
+        fprintf(stderr, "PASS\n");
+    return ok;
+}
+
+static int same_apdu(const struct fisb_apdu *a, const struct fisb_apdu *b)
+{
+    return (a->a_flag == b->a_flag && a->g_flag == b->g_flag && a->p_flag == b->p_flag && a->s_flag == b->s_flag &&
+            a->monthday_valid == b->monthday_valid && a->seconds_valid == b->seconds_valid &&
+            a->product_id == b->product_id && a->hours == b->hours && a->minutes == b->minutes &&
+            (!a->monthday_valid || (a->month == b->month && a->day == b->day)) &&
+            (!a->seconds_valid || a->seconds == b->seconds) &&
+            a->length == b->length);
+}
+
+// The uplink iterator must find the same info frames in the test frames
+// as uat_decode_uplink_mdb(), pointing at the same data in the frame
+static int test_uplink(void)
+{
+    static struct uat_uplink_mdb mdb;
+    int i, info_frames = 0;
+
+    fprintf(stderr, "checking the uplink iterator on %d frames: ", n_uplink);
+
+    for (i = 0; i < n_uplink; ++i) {
+        uint8_t *frame = uplink[i];
+        struct uat_uplink_iter iter;
+        struct uat_uplink_info_frame info;
+        unsigned n = 0;
+        int has_data;
+
+        uat_decode_uplink_mdb(frame, &mdb);
+        has_data = uat_uplink_iter_init(&iter, frame);
+        if (has_data != mdb.app_data_valid)
+            goto fail;
+
+        while (uat_uplink_iter_next(&iter, &info)) {
+            const struct uat_uplink_info_frame *ref = &mdb.info_frames[n];
+            int product_id = uat_uplink_info_frame_product_id(&info);
+
+            if (n >= mdb.num_info_frames || info.length != ref->length || info.type != ref->type ||
+                info.data - frame != ref->data - mdb.app_data + 8 || info.is_fisb)
+                goto fail;
+            if (product_id != (ref->is_fisb ? ref->fisb.product_id : -1))
+                goto fail;
+            if (uat_decode_info_frame_fisb(&info) != ref->is_fisb ||
+                (info.is_fisb && (!same_apdu(&info.fisb, &ref->fisb) ||
+                                  info.fisb.data - frame != ref->fisb.data - mdb.app_data + 8)))
+                goto fail;
+            ++n;
+        }
+
+        if (has_data && n != mdb.num_info_frames)
+            goto fail;
+        info_frames += n;
+        continue;
+
+    fail:
+        fprintf(stderr, "FAIL: uplink frame %d, info frame %u differs from uat_decode_uplink_mdb()\n", i, n);
+        return 0;
+    }
+
+    fprintf(stderr, "PASS (%d info frames)\n", info_frames);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    int ok = 1;
+
+    if (!load_frames(argc > 1 ? argv[1] : "scripts/samples.txt"))
+        return 1;
+
+    ok = test_velocity() && ok;
+    ok = test_callsign() && ok;
+    ok = test_fields() && ok;
+    ok = test_uplink() && ok;
+
+    return ok ? 0 : 1;
+}
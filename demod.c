@@ -0,0 +1,584 @@
+//
+// Copyright 2015, Oliver Jowett <oliver@mutability.co.uk>
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it  
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your  
+// option) any later version.  
+//
+// This file is distributed in the hope that it will be useful, but  
+// WITHOUT ANY WARRANTY; without even the implied warranty of  
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU  
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License  
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#ifdef RUNTIME_TABLES
+#include <pthread.h>
+#endif
+
+#include "uat.h"
+#include "fec.h"
+#include "tables.h"
+#include "demod.h"
+
+struct dump978_demod {
+    struct dump978_demod_config config;
+    struct dump978_demod_stats stats;
+    uint64_t offset;            // absolute index of the first sample in buffer
+    int used;                   // bytes in buffer
+    uint16_t buffer[65536];     // raw input, converted to phase up to 'used & ~1'
+};
+
+#ifdef RUNTIME_TABLES
+static void make_atan2_table(void);
+#endif
+static int check_sync_word(uint16_t *phi, uint64_t pattern, int16_t *center);
+static void convert_to_phi(uint16_t *buffer, int n);
+static int process_buffer(struct dump978_demod *demod, uint16_t *phi, int len);
+static int demod_adsb_frame(struct dump978_demod *demod, uint16_t *phi, uint8_t *to, int *rs_errors);
+static int demod_uplink_frame(struct dump978_demod *demod, uint16_t *phi, uint8_t *to, int *rs_errors);
+static void demod_frame(uint16_t *phi, uint8_t *frame, int bytes, int16_t center_dphi);
+static void demod_frame_confidence(uint16_t *phi, uint8_t *frame, uint16_t *confidence, int bytes, int16_t center_dphi);
+
+// relying on signed overflow is theoretically bad. Let's do it properly.
+
+#ifdef USE_SIGNED_OVERFLOW
+#define phi_difference(from,to) ((int16_t)((to) - (from)))
+#else
+inline int16_t phi_difference(uint16_t from, uint16_t to)
+{
+    int32_t difference = to - from; // lies in the range -65535 .. +65535
+    if (difference >= 32768)        //   +32768..+65535
+        return difference - 65536;  //   -> -32768..-1: always in range
+    else if (difference < -32768)   //   -65535..-32769
+        return difference + 65536;  //   -> +1..32767: always in range
+    else
+        return difference;
+}
+#endif
+
+#ifdef RUNTIME_TABLES
+static uint16_t iqphase[65536]; // contains value [0..65536) -> [0, 2*pi)
+static pthread_once_t iqphase_once = PTHREAD_ONCE_INIT;
+
+void make_atan2_table(void)
+{
+    unsigned i,q;
+
+    for (i = 0; i < 256; ++i) {
+        for (q = 0; q < 256; ++q)
+            iqphase[i | (q << 8)] = iq_to_phase(i, q);
+    }
+}
+#endif
+
+double dump978_monotonic_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct dump978_demod *dump978_demod_new(const struct dump978_demod_config *config)
+{
+    struct dump978_demod *demod;
+
+    if (!config || !config->frame_handler) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    demod = calloc(1, sizeof(*demod));
+    if (!demod)
+        return NULL;
+
+#ifdef RUNTIME_TABLES
+    pthread_once(&iqphase_once, make_atan2_table);
+#endif
+    init_fec();
+
+    demod->config = *config;
+    demod->offset = 0;
+    demod->used = 0;
+    return demod;
+}
+
+void dump978_demod_free(struct dump978_demod *demod)
+{
+    if (!demod)
+        return;
+
+    free(demod);
+}
+
+size_t dump978_demod_space(const struct dump978_demod *demod)
+{
+    return sizeof(demod->buffer) - demod->used;
+}
+
+const struct dump978_demod_stats *dump978_demod_stats(const struct dump978_demod *demod)
+{
+    return &demod->stats;
+}
+
+void dump978_demod_discard(struct dump978_demod *demod)
+{
+    // keep any odd byte, so that I/Q alignment is preserved
+    int discard = demod->used & ~1;
+    char *buffer = (char *) demod->buffer;
+
+    memmove(buffer, buffer+discard, demod->used-discard);
+    demod->used -= discard;
+    demod->offset += discard/2;
+}
+
+void dump978_demod_push(struct dump978_demod *demod, const uint8_t *data, size_t len)
+{
+    char *buffer = (char *) demod->buffer;
+
+    while (len > 0) {
+        size_t n = dump978_demod_space(demod);
+        int processed;
+
+        if (n > len)
+            n = len;
+
+        memcpy(buffer+demod->used, data, n);
+        convert_to_phi((uint16_t*) (buffer+(demod->used&~1)), ((demod->used&1)+n)/2);
+
+        demod->used += n;
+        processed = process_buffer(demod, demod->buffer, demod->used/2);
+        demod->used -= processed * 2;
+        demod->offset += processed;
+        if (demod->used > 0) {
+            memmove(buffer, buffer+processed*2, demod->used);
+        }
+
+        data += n;
+        len -= n;
+    }
+}
+
+// Pass a sync word candidate starting 'index' samples into the buffer
+// to the candidate handler
+static void report_candidate(struct dump978_demod *demod, frame_type_t t, int index, int samples, int rs)
+{
+    if (demod->config.candidate_handler)
+        demod->config.candidate_handler(t, demod->offset + index, samples, rs, demod->config.handler_data);
+}
+
+static void handle_adsb_frame(struct dump978_demod *demod, int index, uint8_t *frame, int rs)
+{
+    ++demod->stats.adsb_frames;
+    demod->config.frame_handler(UAT_DOWNLINK, demod->offset + index, frame,
+                                (frame[0]>>3) == 0 ? SHORT_FRAME_DATA_BYTES : LONG_FRAME_DATA_BYTES,
+                                rs, demod->config.handler_data);
+}
+
+static void handle_uplink_frame(struct dump978_demod *demod, int index, uint8_t *frame, int rs)
+{
+    ++demod->stats.uplink_frames;
+    demod->config.frame_handler(UAT_UPLINK, demod->offset + index, frame, UPLINK_FRAME_DATA_BYTES,
+                                rs, demod->config.handler_data);
+}
+
+static void convert_to_phi(uint16_t *buffer, int n)
+{
+    int i;
+
+    // unroll the loop. n is always > 2048, usually 36864
+    for (i = 0; i+8 <= n; i += 8) {
+        buffer[i] = iqphase[IQPHASE_INDEX(buffer[i])];
+        buffer[i+1] = iqphase[IQPHASE_INDEX(buffer[i+1])];
+        buffer[i+2] = iqphase[IQPHASE_INDEX(buffer[i+2])];
+        buffer[i+3] = iqphase[IQPHASE_INDEX(buffer[i+3])];
+        buffer[i+4] = iqphase[IQPHASE_INDEX(buffer[i+4])];
+        buffer[i+5] = iqphase[IQPHASE_INDEX(buffer[i+5])];
+        buffer[i+6] = iqphase[IQPHASE_INDEX(buffer[i+6])];
+        buffer[i+7] = iqphase[IQPHASE_INDEX(buffer[i+7])];
+    }
+    for (; i < n; ++i)
+        buffer[i] = iqphase[IQPHASE_INDEX(buffer[i])];
+}
+
+
+// Return 1 if word is "equal enough" to expected
+static inline int sync_word_fuzzy_compare(uint64_t word, uint64_t expected)
+{
+    uint64_t diff;
+
+    if (word == expected)
+        return 1;
+
+    diff = word ^ expected; // guaranteed nonzero
+
+    // This is a bit-twiddling popcount
+    // hack, tweaked as we only care about
+    // "<N" or ">=N" set bits for fixed N -
+    // so we can bail out early after seeing N
+    // set bits.
+    //
+    // It relies on starting with a nonzero value
+    // with zero or more trailing clear bits
+    // after the last set bit:
+    //
+    //    010101010101010000
+    //                 ^
+    // Subtracting one, will flip the 
+    // bits starting at the last set bit:
+    //
+    //    010101010101001111
+    //                 ^
+    // then we can use that as a bitwise-and 
+    // mask to clear the lowest set bit:
+    //
+    //    010101010101000000
+    //                 ^
+    // And repeat until the value is zero
+    // or we have seen too many set bits.
+    
+    // >= 1 bit
+    diff &= (diff-1);   // clear lowest set bit
+    if (!diff)
+        return 1; // 1 bit error
+
+    // >= 2 bits
+    diff &= (diff-1);   // clear lowest set bit
+    if (!diff)
+        return 1; // 2 bits error
+
+    // >= 3 bits
+    diff &= (diff-1);   // clear lowest set bit
+    if (!diff)
+        return 1; // 3 bits error
+
+    // >= 4 bits
+    diff &= (diff-1);   // clear lowest set bit
+    if (!diff)
+        return 1; // 4 bits error
+
+    // > 4 bits in error, give up
+    return 0;
+}
+
+#define MAX_SYNC_ERRORS 4
+
+// check that there is a valid sync word starting at 'phi'
+// that matches the sync word 'pattern'. Place the dphi
+// threshold to use for bit slicing in '*center'. Return 1
+// if the sync word is OK, 0 on failure
+static int check_sync_word(uint16_t *phi, uint64_t pattern, int16_t *center)
+{
+    int i;
+    int32_t dphi_zero_total = 0;
+    int zero_bits = 0;
+    int32_t dphi_one_total = 0;
+    int one_bits = 0;
+    int error_bits;
+
+    // find mean dphi for zero and one bits;
+    // take the mean of the two as our central value
+
+    for (i = 0; i < SYNC_BITS; ++i) {
+        int16_t dphi = phi_difference(phi[i*2], phi[i*2+1]);
+
+        if (pattern & (1UL << (35-i))) {
+            ++one_bits;
+            dphi_one_total += dphi;
+        } else {
+            ++zero_bits;
+            dphi_zero_total += dphi;
+        }
+    }
+
+    dphi_zero_total /= zero_bits;
+    dphi_one_total /= one_bits;
+
+    *center = (dphi_one_total + dphi_zero_total) / 2;
+
+    // recheck sync word using our center value
+    error_bits = 0;
+    for (i = 0; i < SYNC_BITS; ++i) {
+        int16_t dphi = phi_difference(phi[i*2], phi[i*2+1]);
+
+        if (pattern & (1UL << (35-i))) {
+            if (dphi < *center)
+                ++error_bits;
+        } else {
+            if (dphi >= *center)
+                ++error_bits;
+        }
+    }
+
+    //fprintf(stdout, "check_sync_word: center=%.0fkHz, errors=%d\n", *center * 2083334.0 / 65536 / 1000, error_bits);
+
+    return (error_bits <= MAX_SYNC_ERRORS);
+}
+
+#define SYNC_MASK ((((uint64_t)1)<<SYNC_BITS)-1)
+
+static int process_buffer(struct dump978_demod *demod, uint16_t *phi, int len)
+{
+    uint64_t sync0 = 0, sync1 = 0;
+    int lenbits;
+    int bit;
+
+    uint8_t demod_buf_a[UPLINK_FRAME_BYTES];
+    uint8_t demod_buf_b[UPLINK_FRAME_BYTES];
+
+    // We expect samples at twice the UAT bitrate.
+    // We look at phase difference between pairs of adjacent samples, i.e.
+    //  sample 1 - sample 0   -> sync0
+    //  sample 2 - sample 1   -> sync1
+    //  sample 3 - sample 2   -> sync0
+    //  sample 4 - sample 3   -> sync1
+    // ...
+    //
+    // We accumulate bits into two buffers, sync0 and sync1.
+    // Then we compare those buffers to the expected 36-bit sync word that
+    // should be at the start of each UAT frame. When (if) we find it,
+    // that tells us which sample to start decoding from.
+
+    // Stop when we run out of remaining samples for a max-sized frame.
+    // Arrange for our caller to pass the trailing data back to us next time;
+    // ensure we don't consume any partial sync word we might be part-way
+    // through. This means we don't need to maintain state between calls.
+
+    // In low-latency mode, stop when we run out of samples for a
+    // max-sized downlink frame instead, so that downlink frames near the
+    // end of the buffer are output immediately. Uplink candidates that
+    // don't fit are deferred until the next call.
+
+    if (demod->config.low_latency)
+        lenbits = len/2 - (SYNC_BITS + LONG_FRAME_BITS);
+    else
+        lenbits = len/2 - (SYNC_BITS + UPLINK_FRAME_BITS);
+    for (bit = 0; bit < lenbits; ++bit) {
+        int16_t dphi0 = phi_difference(phi[bit*2], phi[bit*2+1]);
+        int16_t dphi1 = phi_difference(phi[bit*2+1], phi[bit*2+2]);
+
+        sync0 = ((sync0 << 1) | (dphi0 > 0 ? 1 : 0)) & SYNC_MASK;
+        sync1 = ((sync1 << 1) | (dphi1 > 0 ? 1 : 0)) & SYNC_MASK;
+
+        if (bit < SYNC_BITS)
+            continue; // haven't fully populated sync0/1 yet
+
+        // see if we have (the start of) a valid sync word
+        // It would be nice to look at popcount(expected ^ sync) 
+        // so we can tolerate some errors, but that turns out
+        // to be very expensive to do on every sample
+
+        // when we find a match, try to demodulate both with that match
+        // and with the next position, and pick the one with fewer
+        // errors.
+
+        // check for downlink frames:
+        if (sync_word_fuzzy_compare(sync0, ADSB_SYNC_WORD) || sync_word_fuzzy_compare(sync1, ADSB_SYNC_WORD)) {
+            int startbit = (bit-SYNC_BITS+1);
+            int shift = (sync_word_fuzzy_compare(sync0, ADSB_SYNC_WORD) ? 0 : 1);
+            int index = startbit*2+shift;
+
+            int skip_0, skip_1;
+            int rs_0 = -1, rs_1 = -1;
+
+            skip_0 = demod_adsb_frame(demod, phi+index, demod_buf_a, &rs_0);
+            skip_1 = demod_adsb_frame(demod, phi+index+1, demod_buf_b, &rs_1);
+            if (skip_0 && rs_0 <= rs_1) {
+                report_candidate(demod, UAT_DOWNLINK, index, skip_0*2, rs_0);
+                handle_adsb_frame(demod, index, demod_buf_a, rs_0);
+                bit = startbit + skip_0;
+                continue;
+            } else if (skip_1 && rs_1 <= rs_0) {
+                report_candidate(demod, UAT_DOWNLINK, index+1, skip_1*2, rs_1);
+                handle_adsb_frame(demod, index+1, demod_buf_b, rs_1);
+                bit = startbit + skip_1;
+                continue;
+            } else {
+                // demod failed
+                report_candidate(demod, UAT_DOWNLINK, index, (SYNC_BITS+LONG_FRAME_BITS)*2, -1);
+            }
+        }
+
+        // check for uplink frames:
+        else if (sync_word_fuzzy_compare(sync0, UPLINK_SYNC_WORD) || sync_word_fuzzy_compare(sync1, UPLINK_SYNC_WORD)) {
+            int startbit = (bit-SYNC_BITS+1);
+            int shift = (sync_word_fuzzy_compare(sync0, UPLINK_SYNC_WORD) ? 0 : 1);
+            int index = startbit*2+shift;
+
+            int skip_0, skip_1;
+            int rs_0 = -1, rs_1 = -1;
+
+            if ((startbit + SYNC_BITS + UPLINK_FRAME_BITS) * 2 + 2 > len) {
+                // low-latency mode: not enough samples yet, rescan
+                // this sync word next time
+                break;
+            }
+
+            skip_0 = demod_uplink_frame(demod, phi+index, demod_buf_a, &rs_0);
+            skip_1 = demod_uplink_frame(demod, phi+index+1, demod_buf_b, &rs_1);
+            if (skip_0 && rs_0 <= rs_1) {
+                report_candidate(demod, UAT_UPLINK, index, skip_0*2, rs_0);
+                handle_uplink_frame(demod, index, demod_buf_a, rs_0);
+                bit = startbit + skip_0;
+                continue;
+            } else if (skip_1 && rs_1 <= rs_0) {
+                report_candidate(demod, UAT_UPLINK, index+1, skip_1*2, rs_1);
+                handle_uplink_frame(demod, index+1, demod_buf_b, rs_1);
+                bit = startbit + skip_1;
+                continue;
+            } else {
+                // demod failed
+                report_candidate(demod, UAT_UPLINK, index, (SYNC_BITS+UPLINK_FRAME_BITS)*2, -1);
+            }
+        }
+    }
+
+    if (bit <= SYNC_BITS)
+        return 0; // not enough data to have consumed anything yet
+    return (bit - SYNC_BITS)*2;
+}
+
+// demodulate 'bytes' bytes from samples at 'phi' into 'frame',
+// using 'center_dphi' as the bit slicing threshold
+static void demod_frame(uint16_t *phi, uint8_t *frame, int bytes, int16_t center_dphi)
+{
+    while (--bytes >= 0) {
+        uint8_t b = 0;
+        if (phi_difference(phi[0], phi[1]) > center_dphi) b |= 0x80;
+        if (phi_difference(phi[2], phi[3]) > center_dphi) b |= 0x40;
+        if (phi_difference(phi[4], phi[5]) > center_dphi) b |= 0x20;
+        if (phi_difference(phi[6], phi[7]) > center_dphi) b |= 0x10;
+        if (phi_difference(phi[8], phi[9]) > center_dphi) b |= 0x08;
+        if (phi_difference(phi[10], phi[11]) > center_dphi) b |= 0x04;
+        if (phi_difference(phi[12], phi[13]) > center_dphi) b |= 0x02;
+        if (phi_difference(phi[14], phi[15]) > center_dphi) b |= 0x01;
+        *frame++ = b;
+        phi += 16;
+    }
+}
+
+// Erasure decoding (dump978 -e): candidates that fail the plain
+// Reed-Solomon decode are retried with their least reliable bytes as
+// erasures. The reliability of a byte is that of its weakest bit, i.e.
+// how close its phase difference came to the slicing threshold.
+
+// As demod_frame, also storing the confidence of each byte: the
+// smallest distance of any of its bits from the threshold
+static void demod_frame_confidence(uint16_t *phi, uint8_t *frame, uint16_t *confidence, int bytes, int16_t center_dphi)
+{
+    while (--bytes >= 0) {
+        uint8_t b = 0;
+        int bit, weakest = 65535;
+
+        for (bit = 0; bit < 8; ++bit) {
+            int delta = phi_difference(phi[bit*2], phi[bit*2+1]) - center_dphi;
+
+            if (delta > 0)
+                b |= 0x80 >> bit;
+            if (abs(delta) < weakest)
+                weakest = abs(delta);
+        }
+
+        *frame++ = b;
+        *confidence++ = weakest;
+        phi += 16;
+    }
+}
+
+// Account for an erasure-decoding attempt that took 'elapsed' seconds
+static void count_erasure_retry(struct dump978_demod *demod, int erasures, int ok, int uplink, double elapsed)
+{
+    // a retry happens whenever the plain decode fails
+    if (!ok || erasures > 0) {
+        ++demod->stats.erasure_retries;
+        demod->stats.erasure_time += elapsed;
+        if (ok && uplink)
+            ++demod->stats.uplink_recovered;
+        else if (ok)
+            ++demod->stats.adsb_recovered;
+    }
+}
+
+// Demodulate an ADSB (Long UAT or Basic UAT) downlink frame
+// with the first sync bit in 'phi', storing the frame into 'to'
+// of length up to LONG_FRAME_BYTES. Set '*rs_errors' to the
+// number of corrected errors, or 9999 if demodulation failed.
+// Return 0 if demodulation failed, or the number of bits (not
+// samples) consumed if demodulation was OK.
+static int demod_adsb_frame(struct dump978_demod *demod, uint16_t *phi, uint8_t *to, int *rs_errors)
+{
+    int16_t center_dphi;
+    int frametype;
+
+    if (!check_sync_word(phi, ADSB_SYNC_WORD, &center_dphi)) {
+        *rs_errors = 9999;
+        return 0;
+    }
+
+    if (demod->config.erasure_decoding) {
+        uint16_t confidence[LONG_FRAME_BYTES];
+        double start;
+        int erasures;
+
+        demod_frame_confidence(phi + SYNC_BITS*2, to, confidence, LONG_FRAME_BYTES, center_dphi);
+        start = dump978_monotonic_now();
+        frametype = correct_adsb_frame_eras(to, confidence, rs_errors, &erasures);
+        count_erasure_retry(demod, erasures, frametype > 0, 0, dump978_monotonic_now() - start);
+    } else {
+        demod_frame(phi + SYNC_BITS*2, to, LONG_FRAME_BYTES, center_dphi);    
+        frametype = correct_adsb_frame(to, rs_errors);
+    }
+    if (frametype == 1)
+        return (SYNC_BITS + SHORT_FRAME_BITS);
+    else if (frametype == 2)
+        return (SYNC_BITS + LONG_FRAME_BITS);
+    else
+        return 0;
+}
+
+// Demodulate an uplink frame
+// with the first sync bit in 'phi', storing the frame into 'to'
+// of length up to UPLINK_FRAME_BYTES. Set '*rs_errors' to the
+// number of corrected errors, or 9999 if demodulation failed.
+// Return 0 if demodulation failed, or the number of bits (not
+// samples) consumed if demodulation was OK.
+static int demod_uplink_frame(struct dump978_demod *demod, uint16_t *phi, uint8_t *to, int *rs_errors)
+{
+    int16_t center_dphi;
+    uint8_t interleaved[UPLINK_FRAME_BYTES];
+    int ok;
+
+    if (!check_sync_word(phi, UPLINK_SYNC_WORD, &center_dphi)) {
+        *rs_errors = 9999;
+        return 0;
+    }
+
+    // deinterleave and correct
+    if (demod->config.erasure_decoding) {
+        uint16_t confidence[UPLINK_FRAME_BYTES];
+        double start;
+        int erasures;
+
+        demod_frame_confidence(phi + SYNC_BITS*2, interleaved, confidence, UPLINK_FRAME_BYTES, center_dphi);
+        start = dump978_monotonic_now();
+        ok = (correct_uplink_frame_eras(interleaved, confidence, to, rs_errors, &erasures) == 1);
+        count_erasure_retry(demod, erasures, ok, 1, dump978_monotonic_now() - start);
+    } else {
+        demod_frame(phi + SYNC_BITS*2, interleaved, UPLINK_FRAME_BYTES, center_dphi);
+        ok = (correct_uplink_frame(interleaved, to, rs_errors) == 1);
+    }
+
+    if (ok)
+        return (UPLINK_FRAME_BITS+SYNC_BITS);
+    else
+        return 0;
+}
@@ -0,0 +1,99 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DUMP978_DEMOD_H
+#define DUMP978_DEMOD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "reader.h"
+
+// The demodulator as a library: 8-bit I/Q samples at 2.083334MHz are
+// pushed in, and demodulated, Reed-Solomon corrected frames come out via
+// a callback. All state lives in the struct dump978_demod, so any number
+// of demodulators can run at once, each in its own thread; only the
+// read-only lookup tables are shared. A single demodulator must not be
+// used from more than one thread at a time.
+
+struct dump978_demod;
+
+// Called for each frame that is demodulated and corrected:
+//   t: frame type (UAT_UPLINK or UAT_DOWNLINK)
+//   offset: index of the first sample of the sync word, counting
+//           from the first sample ever pushed
+//   f: frame data, without the Reed-Solomon parity
+//   l: length of frame data
+//   rs: number of corrected Reed-Solomon errors
+//   d: the 'handler_data' from the config
+// The frame data buffer is owned by the demodulator and is only valid
+// until the handler returns.
+typedef void (*demod_frame_handler_t)(frame_type_t t, uint64_t offset, uint8_t *f, int l, int rs, void *d);
+
+// Called for each sync word candidate, whether it decoded or not:
+//   offset: index of the first sample of the sync word, as above
+//   samples: number of samples spanned by the frame
+//   rs: number of corrected errors, or -1 if the candidate failed
+// Candidates that decoded are reported just before their frame.
+typedef void (*demod_candidate_handler_t)(frame_type_t t, uint64_t offset, int samples, int rs, void *d);
+
+struct dump978_demod_config {
+    int low_latency;            // output downlink frames with the minimum lookahead (dump978 -l)
+    int erasure_decoding;       // retry failed frames with erasures (dump978 -e)
+    demod_frame_handler_t frame_handler;
+    demod_candidate_handler_t candidate_handler; // may be NULL
+    void *handler_data;
+};
+
+struct dump978_demod_stats {
+    uint64_t adsb_frames;       // downlink frames output
+    uint64_t uplink_frames;     // uplink frames output
+    uint64_t erasure_retries;   // candidates that needed an erasure retry
+    uint64_t adsb_recovered;    // of which, decoded as downlink frames
+    uint64_t uplink_recovered;  // of which, decoded as uplink frames
+    double erasure_time;        // seconds spent on those candidates
+};
+
+// Allocate a new demodulator. The config is copied.
+// Returns the demodulator, or NULL on error with errno set.
+struct dump978_demod *dump978_demod_new(const struct dump978_demod_config *config);
+
+// Free a demodulator previously created by dump978_demod_new.
+// Samples that were pushed but not yet processed are dropped.
+void dump978_demod_free(struct dump978_demod *demod);
+
+// Push 'len' bytes of raw I/Q input, which need not be a whole number
+// of samples. Frames found are passed to the handlers before this
+// returns. Input is processed in chunks of at most
+// dump978_demod_space() bytes.
+void dump978_demod_push(struct dump978_demod *demod, const uint8_t *data, size_t len);
+
+// Return the number of bytes that the next push can process in one go.
+size_t dump978_demod_space(const struct dump978_demod *demod);
+
+// Drop the pushed samples that have not been processed yet, so that
+// frames are not built from samples on both sides of a gap in the
+// input. Sample offsets continue to count the dropped samples.
+void dump978_demod_discard(struct dump978_demod *demod);
+
+// Return the demodulator's counters.
+const struct dump978_demod_stats *dump978_demod_stats(const struct dump978_demod *demod);
+
+// Seconds on the monotonic clock, as used for the demodulator's timings.
+double dump978_monotonic_now(void);
+
+#endif
@@ -0,0 +1,326 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Stress test for running several demodulators at once: a synthetic
+// signal is demodulated and decoded by one demodulator per config on
+// its own, then by many threads at once, each with its own demodulator
+// and pushing the input in different sized pieces. Every thread must
+// produce exactly the same frames, decoded text and FEC statistics as
+// the reference run for its config.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "uat.h"
+#include "fec.h"
+#include "demod.h"
+#include "reader.h"
+#include "uat_decode.h"
+#include "modulator.h"
+
+#define TEST_FRAMES 300
+#define TEST_SNR 9.0
+#define TEST_CONFIGS 4     // low latency and erasure decoding, on and off
+#define TEST_THREADS 8
+#define TEST_REPEATS 3
+
+static struct {
+    frame_type_t type;
+    uint8_t data[UPLINK_FRAME_DATA_BYTES];
+    int len;
+} frames[TEST_FRAMES];
+static int n_frames;
+
+static uint8_t *signal;
+static size_t signal_len;
+
+struct run {
+    int config;                 // low_latency in bit 0, erasure_decoding in bit 1
+    unsigned chunk_seed;        // 0: push dump978_demod_space() bytes at a time
+    int repeats;
+
+    // results
+    char *log;                  // frames and decoded text, from the first repeat
+    int matched;                // frames that matched the modulated frames, in order
+    int ok;
+    struct dump978_demod_stats stats;
+    struct fec_stats fec;       // this thread's FEC statistics, over all repeats
+};
+
+struct run_output {
+    FILE *log;
+    int next_frame;
+    int matched;
+};
+
+static void load_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    if (n_frames >= TEST_FRAMES)
+        return;
+
+    frames[n_frames].type = t;
+    memcpy(frames[n_frames].data, f, l);
+    frames[n_frames].len = l;
+    ++n_frames;
+}
+
+static int load_frames(const char *path)
+{
+    struct dump978_reader *reader;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        perror(path);
+        return 0;
+    }
+
+    reader = dump978_reader_new(fd, 0);
+    while (dump978_read_frames(reader, load_frame, NULL) > 0)
+        ;
+    dump978_reader_free(reader);
+    close(fd);
+
+    return (n_frames > 0);
+}
+
+// Modulate the test frames with random gaps of noise between them
+static void make_signal(void)
+{
+    struct uat_modulator mod;
+    uint8_t encoded[UPLINK_FRAME_BYTES];
+    size_t max_len = 0;
+    int i, n;
+
+    for (i = 0; i < n_frames; ++i)
+        max_len += 4096 + MODULATOR_SAMPLES(UPLINK_FRAME_BITS);
+    max_len += 2 * MODULATOR_SAMPLES(UPLINK_FRAME_BITS);
+
+    signal = malloc(max_len * 2);
+    signal_len = 0;
+
+    modulator_init(&mod, TEST_SNR, 5000, 0.25, 978);
+    for (i = 0; i < n_frames; ++i) {
+        n = 64 + (int) (modulator_random(&mod) * 4000);
+        modulate_noise(&mod, signal + signal_len * 2, n);
+        signal_len += n;
+
+        if (frames[i].type == UAT_DOWNLINK) {
+            int frametype;
+
+            memcpy(encoded, frames[i].data, frames[i].len);
+            frametype = encode_adsb_frame(encoded);
+            n = modulate_adsb_frame(&mod, encoded, frametype, signal + signal_len * 2);
+        } else {
+            encode_uplink_frame(frames[i].data, encoded);
+            n = modulate_uplink_frame(&mod, encoded, signal + signal_len * 2);
+        }
+        signal_len += n;
+    }
+
+    // trailing noise, so the demodulator has enough lookahead
+    n = 2 * MODULATOR_SAMPLES(UPLINK_FRAME_BITS);
+    modulate_noise(&mod, signal + signal_len * 2, n);
+    signal_len += n;
+}
+
+// Log a frame along with its decoded contents, which exercises the
+// message decoder from several threads too
+static void handle_frame(frame_type_t t, uint64_t offset, uint8_t *f, int l, int rs, void *d)
+{
+    struct run_output *out = d;
+    int i;
+
+    fprintf(out->log, "%c%llu;rs=%d;", t == UAT_UPLINK ? '+' : '-', (unsigned long long) offset, rs);
+    for (i = 0; i < l; ++i)
+        fprintf(out->log, "%02x", f[i]);
+    fprintf(out->log, "\n");
+
+    if (t == UAT_UPLINK) {
+        struct uat_uplink_mdb mdb;
+        uat_decode_uplink_mdb(f, &mdb);
+        uat_display_uplink_mdb(&mdb, out->log);
+    } else {
+        struct uat_adsb_mdb mdb;
+        uat_decode_adsb_mdb(f, &mdb);
+        uat_display_adsb_mdb(&mdb, out->log);
+    }
+
+    // frames that failed to decode are skipped over
+    while (out->next_frame < n_frames) {
+        int k = out->next_frame++;
+        if (frames[k].type == t && frames[k].len == l && !memcmp(frames[k].data, f, l)) {
+            ++out->matched;
+            break;
+        }
+    }
+}
+
+static void *run_demod(void *arg)
+{
+    struct run *r = arg;
+    int repeat;
+
+    r->ok = 1;
+    for (repeat = 0; repeat < r->repeats; ++repeat) {
+        struct dump978_demod_config config;
+        struct dump978_demod *demod;
+        struct run_output out;
+        char *log = NULL;
+        size_t log_size = 0;
+        unsigned seed = r->chunk_seed;
+        size_t pos = 0;
+
+        memset(&config, 0, sizeof(config));
+        config.low_latency = (r->config & 1);
+        config.erasure_decoding = (r->config & 2) >> 1;
+        config.frame_handler = handle_frame;
+        config.handler_data = &out;
+
+        out.log = open_memstream(&log, &log_size);
+        out.next_frame = 0;
+        out.matched = 0;
+
+        demod = dump978_demod_new(&config);
+        while (pos < signal_len * 2) {
+            size_t n;
+
+            if (!seed) {
+                n = dump978_demod_space(demod);
+            } else {
+                // pieces of 1..8192 bytes, often odd
+                seed = seed * 1103515245 + 12345;
+                n = 1 + (seed >> 8) % 8192;
+            }
+            if (n > signal_len * 2 - pos)
+                n = signal_len * 2 - pos;
+
+            dump978_demod_push(demod, signal + pos, n);
+            pos += n;
+        }
+        r->stats = *dump978_demod_stats(demod);
+        dump978_demod_free(demod);
+        fclose(out.log);
+
+        if (repeat == 0) {
+            r->log = log;
+            r->matched = out.matched;
+        } else {
+            if (strcmp(r->log, log) != 0)
+                r->ok = 0;
+            free(log);
+        }
+    }
+
+    r->fec = *fec_thread_stats();
+    return NULL;
+}
+
+// Compare a thread's FEC statistics against 'repeats' times the reference's
+static int check_fec_stats(const struct fec_stats *s, const struct fec_stats *ref, int repeats)
+{
+    int code, i;
+
+    for (code = 0; code < FEC_STATS_CODES; ++code) {
+        if (s->code[code].codewords != ref->code[code].codewords * repeats ||
+            s->code[code].failed != ref->code[code].failed * repeats)
+            return 0;
+        for (i = 0; i <= FEC_STATS_MAX_CORRECTED; ++i)
+            if (s->code[code].corrected[i] != ref->code[code].corrected[i] * repeats)
+                return 0;
+    }
+
+    return (s->uplink_frames == ref->uplink_frames * repeats);
+}
+
+int main(int argc, char **argv)
+{
+    struct run refs[TEST_CONFIGS];
+    struct run runs[TEST_THREADS];
+    pthread_t threads[TEST_THREADS];
+    int i, all_ok = 1;
+
+    if (!load_frames(argc > 1 ? argv[1] : "scripts/samples.txt"))
+        return 1;
+
+    init_fec();
+    make_signal();
+
+    // references, each in a fresh thread so that they get their own FEC
+    // statistics
+    for (i = 0; i < TEST_CONFIGS; ++i) {
+        memset(&refs[i], 0, sizeof(refs[i]));
+        refs[i].config = i;
+        refs[i].chunk_seed = 0;
+        refs[i].repeats = 1;
+        pthread_create(&threads[0], NULL, run_demod, &refs[i]);
+        pthread_join(threads[0], NULL);
+
+        fprintf(stderr, "demod reference (low latency %s, erasures %s): %d of %d frames decoded: ",
+                (i & 1) ? "on" : "off", (i & 2) ? "on" : "off", refs[i].matched, n_frames);
+        if (refs[i].matched < n_frames * 3 / 4 ||
+            refs[i].matched != refs[i].stats.adsb_frames + refs[i].stats.uplink_frames) {
+            fprintf(stderr, "FAIL\n");
+            all_ok = 0;
+        } else {
+            fprintf(stderr, "PASS\n");
+        }
+    }
+
+    // all threads at once
+    for (i = 0; i < TEST_THREADS; ++i) {
+        memset(&runs[i], 0, sizeof(runs[i]));
+        runs[i].config = i % TEST_CONFIGS;
+        runs[i].chunk_seed = (i < TEST_CONFIGS ? 0 : i);
+        runs[i].repeats = TEST_REPEATS;
+        if (pthread_create(&threads[i], NULL, run_demod, &runs[i]) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+
+    for (i = 0; i < TEST_THREADS; ++i) {
+        struct run *ref = &refs[runs[i].config];
+
+        pthread_join(threads[i], NULL);
+        fprintf(stderr, "demod thread %d (config %d, %s): ", i, runs[i].config,
+                runs[i].chunk_seed ? "random pieces" : "whole buffers");
+        if (!runs[i].ok) {
+            fprintf(stderr, "FAIL: output differs between repeats\n");
+            all_ok = 0;
+        } else if (strcmp(runs[i].log, ref->log) != 0) {
+            fprintf(stderr, "FAIL: output differs from the reference\n");
+            all_ok = 0;
+        } else if (runs[i].stats.adsb_frames != ref->stats.adsb_frames ||
+                   runs[i].stats.uplink_frames != ref->stats.uplink_frames ||
+                   runs[i].stats.erasure_retries != ref->stats.erasure_retries) {
+            fprintf(stderr, "FAIL: demodulator statistics differ from the reference\n");
+            all_ok = 0;
+        } else if (!check_fec_stats(&runs[i].fec, &ref->fec, TEST_REPEATS)) {
+            fprintf(stderr, "FAIL: FEC statistics differ from the reference\n");
+            all_ok = 0;
+        } else {
+            fprintf(stderr, "PASS\n");
+        }
+    }
+
+    return all_ok ? 0 : 1;
+}
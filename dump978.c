@@ -15,52 +15,214 @@
 // You should have received a copy of the GNU General Public License  
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#define _GNU_SOURCE // for F_GETPIPE_SZ
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
-#include <math.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/ioctl.h>
 
 #include "uat.h"
 #include "fec.h"
-
-static void make_atan2_table();
-static void read_from_stdin();
-static int check_sync_word(uint16_t *phi, uint64_t pattern, int16_t *center);
-static int process_buffer(uint16_t *phi, int len, uint64_t offset);
-static int demod_adsb_frame(uint16_t *phi, uint8_t *to, int *rs_errors);
-static int demod_uplink_frame(uint16_t *phi, uint8_t *to, int *rs_errors);
-static void demod_frame(uint16_t *phi, uint8_t *frame, int bytes, int16_t center_dphi);
-static void handle_adsb_frame(uint64_t timestamp, uint8_t *frame, int rs);
-static void handle_uplink_frame(uint64_t timestamp, uint8_t *frame, int rs);
-
-#define SYNC_BITS (36)
-#define ADSB_SYNC_WORD   0xEACDDA4E2UL
-#define UPLINK_SYNC_WORD 0x153225B1DUL
-
-// relying on signed overflow is theoretically bad. Let's do it properly.
-
-#ifdef USE_SIGNED_OVERFLOW
-#define phi_difference(from,to) ((int16_t)((to) - (from)))
-#else
-inline int16_t phi_difference(uint16_t from, uint16_t to)
+#include "demod.h"
+
+static void read_from_stdin(struct dump978_demod *demod);
+static void handle_frame(frame_type_t t, uint64_t offset, uint8_t *frame, int len, int rs, void *data);
+static void capture_raw_input(const char *data, int n);
+static void capture_candidate(frame_type_t t, uint64_t sync_offset, int frame_samples, int rs, void *data);
+static int monitor_input_read(int n);
+static void record_arrival(uint64_t end);
+static void message_latency(uint64_t end);
+static void periodic_stats(int final);
+static void write_fec_stats(void);
+
+// Sparse I/Q capture (-c): a rolling window of raw input is kept in
+// memory, and the samples around each sync word candidate are appended
+// to the capture file. See README.md for the record format.
+
+#define CAPTURE_WINDOW_BYTES (1 << 20)   // must be a power of two
+#define CAPTURE_PRE_SAMPLES (64)         // samples kept before the sync word
+#define CAPTURE_POST_SAMPLES (64)        // samples kept after the frame
+#define CAPTURE_MAGIC (0x43544155)       // "UATC"
+#define CAPTURE_VERSION (1)
+
+static FILE *capture_file;
+static int capture_failures_only;
+static uint8_t capture_window[CAPTURE_WINDOW_BYTES];
+static uint64_t capture_bytes_read;     // total raw bytes seen so far
+static uint64_t capture_last_end;       // end of the last captured frame
+
+// Low-latency mode (-l): see process_buffer in demod.c. Reads are
+// limited to LOW_LATENCY_READ bytes unless more input is already queued.
+
+#define LOW_LATENCY_READ (4096)
+
+// -l and -e are handled by the demodulator
+static struct dump978_demod_config demod_config;
+
+// Sample-to-output latency measurement (enabled with -s): the wall clock
+// time of each read is recorded along with the sample count, and the
+// latency of each message is measured from the arrival of its last sample.
+
+#define ARRIVAL_HISTORY (64)
+
+static int measure_latency;
+static struct {
+    uint64_t end;              // absolute sample index just past the read
+    double when;               // monotonic time of the read
+} arrivals[ARRIVAL_HISTORY];
+static unsigned arrival_count;
+
+static struct {
+    uint64_t messages;
+    double total;
+    double max;
+} latency_stats;
+
+// Live input monitoring (-m): the number of samples that have arrived
+// (consumed plus still queued in the input pipe, via FIONREAD) is
+// compared against the number that should have arrived according to
+// the wall clock. A sudden jump in the shortfall means the upstream
+// source dropped samples; a large queue means we are falling behind.
+
+#define SAMPLE_RATE (2083334.0)
+#define DISCONTINUITY_THRESHOLD (262144)  // samples; twice rtl_sdr's default transfer size
+#define BACKLOG_WARNING_TIME (0.5)        // seconds the input pipe must stay full before warning
+
+static int monitor_input;
+static int reset_on_discontinuity;
+static double stats_interval;
+
+// Reed-Solomon statistics (-j): see fec.h for the format
+static FILE *fec_stats_file;
+
+static const struct dump978_demod_stats *demod_stats;
+
+static struct {
+    uint64_t bytes;            // bytes read
+    uint64_t reads;            // read() calls that returned data
+    int backlog;               // bytes queued in the input after the last read
+    int max_backlog;           // largest backlog seen
+    uint64_t backlog_warnings; // times the input pipe stayed full for BACKLOG_WARNING_TIME
+    uint64_t discontinuities;  // detected gaps in the input
+    uint64_t lost_samples;     // estimated samples missing from those gaps
+} input_stats;
+
+static void usage(int argc, char **argv)
 {
-    int32_t difference = to - from; // lies in the range -65535 .. +65535
-    if (difference >= 32768)        //   +32768..+65535
-        return difference - 65536;  //   -> -32768..-1: always in range
-    else if (difference < -32768)   //   -65535..-32769
-        return difference + 65536;  //   -> +1..32767: always in range
-    else
-        return difference;
+    fprintf(stderr,
+            "Syntax: %s [-c FILE] [-e] [-f] [-j FILE] [-l] [-m] [-r] [-s SECS]\n"
+            "\n"
+            "Reads 8-bit I/Q samples at 2.083334MHz on stdin,\n"
+            "writes demodulated UAT messages to stdout.\n"
+            "\n"
+            "  -c FILE  Append raw I/Q samples around each sync word candidate to FILE\n"
+            "  -e       Retry failed frames with the least reliable bytes as erasures\n"
+            "  -f       With -c, only capture candidates that failed demodulation\n"
+            "  -j FILE  Append Reed-Solomon correction statistics to FILE as JSON,\n"
+            "           one line every SECS seconds (with -s) and on exit\n"
+            "  -l       Low-latency mode: output downlink messages as soon as possible\n"
+            "  -m       Monitor live input for backlog and dropped samples\n"
+            "  -r       With -m, restart the frame search after dropped samples\n"
+            "  -s SECS  Report statistics to stderr every SECS seconds, and on exit\n"
+            "  -h       Show this usage message\n",
+            argv[0]);
 }
-#endif
 
 int main(int argc, char **argv)
 {
-    make_atan2_table();
-    init_fec();
-    read_from_stdin();
+    struct dump978_demod *demod;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hc:efj:lmrs:")) > 0) {
+        switch (opt) {
+        case 'h':
+            usage(argc, argv);
+            return 0;
+
+        case 'c':
+            capture_file = fopen(optarg, "ab");
+            if (!capture_file) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+
+        case 'e':
+            demod_config.erasure_decoding = 1;
+            break;
+
+        case 'f':
+            capture_failures_only = 1;
+            break;
+
+        case 'j':
+            fec_stats_file = fopen(optarg, "a");
+            if (!fec_stats_file) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+
+        case 'l':
+            demod_config.low_latency = 1;
+            break;
+
+        case 'm':
+            monitor_input = 1;
+            break;
+
+        case 'r':
+            monitor_input = 1;
+            reset_on_discontinuity = 1;
+            break;
+
+        case 's':
+            stats_interval = atof(optarg);
+            if (stats_interval <= 0) {
+                fprintf(stderr, "statistics interval must be positive\n");
+                return 1;
+            }
+            measure_latency = 1;
+            break;
+
+        default:
+            usage(argc, argv);
+            return 1;
+        }
+    }
+
+    if (optind < argc) {
+        usage(argc, argv);
+        return 1;
+    }
+
+    demod_config.frame_handler = handle_frame;
+    if (capture_file)
+        demod_config.candidate_handler = capture_candidate;
+
+    demod = dump978_demod_new(&demod_config);
+    if (!demod) {
+        perror("dump978_demod_new");
+        return 1;
+    }
+    demod_stats = dump978_demod_stats(demod);
+
+    read_from_stdin(demod);
+
+    if (stats_interval > 0)
+        periodic_stats(1);
+    else if (fec_stats_file)
+        write_fec_stats();
+
+    dump978_demod_free(demod);
+    if (capture_file)
+        fclose(capture_file);
     return 0;
 }
 
@@ -78,364 +240,321 @@ static void dump_raw_message(char updown, uint8_t *data, int len, int rs_errors)
     fprintf(stdout, ";\n");
 }
 
-static void handle_adsb_frame(uint64_t timestamp, uint8_t *frame, int rs)
+static void handle_frame(frame_type_t t, uint64_t offset, uint8_t *frame, int len, int rs, void *data)
 {
-    dump_raw_message('-', frame, (frame[0]>>3) == 0 ? SHORT_FRAME_DATA_BYTES : LONG_FRAME_DATA_BYTES, rs);
+    int bits;
+
+    if (t == UAT_UPLINK) {
+        dump_raw_message('+', frame, len, rs);
+        bits = UPLINK_FRAME_BITS;
+    } else {
+        dump_raw_message('-', frame, len, rs);
+        bits = (len == SHORT_FRAME_DATA_BYTES ? SHORT_FRAME_BITS : LONG_FRAME_BITS);
+    }
     fflush(stdout);
-}
 
-static void handle_uplink_frame(uint64_t timestamp, uint8_t *frame, int rs)
-{
-    dump_raw_message('+', frame, UPLINK_FRAME_DATA_BYTES, rs);
-    fflush(stdout);
+    if (measure_latency)
+        message_latency(offset + (SYNC_BITS + bits) * 2);
 }
 
-static uint16_t iqphase[65536]; // contains value [0..65536) -> [0, 2*pi)
-
-void make_atan2_table()
+// Copy newly read raw input into the rolling capture window
+static void capture_raw_input(const char *data, int n)
 {
-    unsigned i,q;
-    union {
-        uint8_t iq[2];
-        uint16_t iq16;
-    } u;
-
-    for (i = 0; i < 256; ++i) {
-        double d_i = (i - 127.5);
-        for (q = 0; q < 256; ++q) {
-            double d_q = (q - 127.5);
-            double ang = atan2(d_q, d_i) + M_PI; // atan2 returns [-pi..pi], normalize to [0..2*pi]
-            double scaled_ang = round(32768 * ang / M_PI);
-
-            u.iq[0] = i;
-            u.iq[1] = q;
-            iqphase[u.iq16] = (scaled_ang < 0 ? 0 : scaled_ang > 65535 ? 65535 : (uint16_t)scaled_ang);
-        }
+    while (n > 0) {
+        unsigned pos = capture_bytes_read & (CAPTURE_WINDOW_BYTES - 1);
+        int chunk = CAPTURE_WINDOW_BYTES - pos;
+        if (chunk > n)
+            chunk = n;
+
+        memcpy(capture_window + pos, data, chunk);
+        capture_bytes_read += chunk;
+        data += chunk;
+        n -= chunk;
     }
 }
 
-static void convert_to_phi(uint16_t *buffer, int n)
+static uint8_t *put_le(uint8_t *p, uint64_t value, int bytes)
 {
-    int i;
-
-    // unroll the loop. n is always > 2048, usually 36864
-    for (i = 0; i+8 <= n; i += 8) {
-        buffer[i] = iqphase[buffer[i]];
-        buffer[i+1] = iqphase[buffer[i+1]];
-        buffer[i+2] = iqphase[buffer[i+2]];
-        buffer[i+3] = iqphase[buffer[i+3]];
-        buffer[i+4] = iqphase[buffer[i+4]];
-        buffer[i+5] = iqphase[buffer[i+5]];
-        buffer[i+6] = iqphase[buffer[i+6]];
-        buffer[i+7] = iqphase[buffer[i+7]];
+    while (--bytes >= 0) {
+        *p++ = value & 0xFF;
+        value >>= 8;
     }
-    for (; i < n; ++i)
-        buffer[i] = iqphase[buffer[i]];
+    return p;
 }
 
-void read_from_stdin()
+// Append a capture record for a sync word candidate starting at
+// absolute sample 'sync_offset' and spanning 'frame_samples' samples.
+// 'rs' is the number of corrected errors, or -1 if demodulation failed.
+static void capture_candidate(frame_type_t t, uint64_t sync_offset, int frame_samples, int rs, void *data)
 {
-    char buffer[65536*2];
-    int n;
-    int used = 0;
-    uint64_t offset = 0;
-    
-    while ( (n = read(0, buffer+used, sizeof(buffer)-used)) > 0 ) {
-        int processed;
-
-        convert_to_phi((uint16_t*) (buffer+(used&~1)), ((used&1)+n)/2);
-
-        used += n;
-        processed = process_buffer((uint16_t*) buffer, used/2, offset);
-        used -= processed * 2;
-        offset += processed;
-        if (used > 0) {
-            memmove(buffer, buffer+processed*2, used);
-        }
+    uint8_t header[40], *p;
+    uint64_t start, end, oldest, newest;
+    struct timeval now;
+
+    if (rs >= 0 && capture_failures_only)
+        return;
+
+    // a failed sync word tends to match again at the next few bit
+    // positions, and stale sync bits can match just after a frame;
+    // don't record failures that lie within the previous record
+    if (rs < 0 && sync_offset < capture_last_end)
+        return;
+    capture_last_end = sync_offset + frame_samples;
+
+    // clip to what is still in the window
+    newest = capture_bytes_read / 2;
+    oldest = (capture_bytes_read > CAPTURE_WINDOW_BYTES ? (capture_bytes_read - CAPTURE_WINDOW_BYTES + 1) / 2 : 0);
+    start = (sync_offset > oldest + CAPTURE_PRE_SAMPLES ? sync_offset - CAPTURE_PRE_SAMPLES : oldest);
+    end = sync_offset + frame_samples + CAPTURE_POST_SAMPLES;
+    if (end > newest)
+        end = newest;
+    if (end <= start)
+        return;
+
+    gettimeofday(&now, NULL);
+
+    p = header;
+    p = put_le(p, CAPTURE_MAGIC, 4);
+    p = put_le(p, CAPTURE_VERSION, 2);
+    p = put_le(p, sizeof(header), 2);
+    p = put_le(p, (uint64_t)now.tv_sec * 1000000 + now.tv_usec, 8);
+    p = put_le(p, start, 8);
+    p = put_le(p, sync_offset - start, 4);
+    p = put_le(p, end - start, 4);
+    p = put_le(p, (uint32_t)rs, 4);
+    *p++ = (t == UAT_UPLINK ? '+' : '-');
+    p = put_le(p, 0, 3);
+
+    fwrite(header, sizeof(header), 1, capture_file);
+
+    // samples, handling wraparound of the window
+    start *= 2;
+    end *= 2;
+    while (start < end) {
+        unsigned pos = start & (CAPTURE_WINDOW_BYTES - 1);
+        uint64_t chunk = CAPTURE_WINDOW_BYTES - pos;
+        if (chunk > end - start)
+            chunk = end - start;
+
+        fwrite(capture_window + pos, 1, chunk, capture_file);
+        start += chunk;
     }
-}
 
+    fflush(capture_file);
+}
 
-// Return 1 if word is "equal enough" to expected
-static inline int sync_word_fuzzy_compare(uint64_t word, uint64_t expected)
+// Note that samples up to (but not including) absolute sample 'end'
+// have now been read
+static void record_arrival(uint64_t end)
 {
-    uint64_t diff;
-
-    if (word == expected)
-        return 1;
-
-    diff = word ^ expected; // guaranteed nonzero
-
-    // This is a bit-twiddling popcount
-    // hack, tweaked as we only care about
-    // "<N" or ">=N" set bits for fixed N -
-    // so we can bail out early after seeing N
-    // set bits.
-    //
-    // It relies on starting with a nonzero value
-    // with zero or more trailing clear bits
-    // after the last set bit:
-    //
-    //    010101010101010000
-    //                 ^
-    // Subtracting one, will flip the 
-    // bits starting at the last set bit:
-    //
-    //    010101010101001111
-    //                 ^
-    // then we can use that as a bitwise-and 
-    // mask to clear the lowest set bit:
-    //
-    //    010101010101000000
-    //                 ^
-    // And repeat until the value is zero
-    // or we have seen too many set bits.
-    
-    // >= 1 bit
-    diff &= (diff-1);   // clear lowest set bit
-    if (!diff)
-        return 1; // 1 bit error
-
-    // >= 2 bits
-    diff &= (diff-1);   // clear lowest set bit
-    if (!diff)
-        return 1; // 2 bits error
-
-    // >= 3 bits
-    diff &= (diff-1);   // clear lowest set bit
-    if (!diff)
-        return 1; // 3 bits error
-
-    // >= 4 bits
-    diff &= (diff-1);   // clear lowest set bit
-    if (!diff)
-        return 1; // 4 bits error
-
-    // > 4 bits in error, give up
-    return 0;
+    unsigned slot = (arrival_count++) % ARRIVAL_HISTORY;
+    arrivals[slot].end = end;
+    arrivals[slot].when = dump978_monotonic_now();
 }
 
-#define MAX_SYNC_ERRORS 4
-
-// check that there is a valid sync word starting at 'phi'
-// that matches the sync word 'pattern'. Place the dphi
-// threshold to use for bit slicing in '*center'. Return 1
-// if the sync word is OK, 0 on failure
-int check_sync_word(uint16_t *phi, uint64_t pattern, int16_t *center)
+// Measure the latency of a message that was just output,
+// ending at absolute sample 'end'
+static void message_latency(uint64_t end)
 {
-    int i;
-    int32_t dphi_zero_total = 0;
-    int zero_bits = 0;
-    int32_t dphi_one_total = 0;
-    int one_bits = 0;
-    int error_bits;
-
-    // find mean dphi for zero and one bits;
-    // take the mean of the two as our central value
-
-    for (i = 0; i < SYNC_BITS; ++i) {
-        int16_t dphi = phi_difference(phi[i*2], phi[i*2+1]);
-
-        if (pattern & (1UL << (35-i))) {
-            ++one_bits;
-            dphi_one_total += dphi;
-        } else {
-            ++zero_bits;
-            dphi_zero_total += dphi;
-        }
+    double now = dump978_monotonic_now();
+    double arrived = now;
+    unsigned i;
+
+    // find the earliest recorded read that included the last sample
+    for (i = 0; i < ARRIVAL_HISTORY && i < arrival_count; ++i) {
+        unsigned slot = (arrival_count - 1 - i) % ARRIVAL_HISTORY;
+        if (arrivals[slot].end < end)
+            break;
+        arrived = arrivals[slot].when;
     }
 
-    dphi_zero_total /= zero_bits;
-    dphi_one_total /= one_bits;
-
-    *center = (dphi_one_total + dphi_zero_total) / 2;
+    ++latency_stats.messages;
+    latency_stats.total += now - arrived;
+    if (now - arrived > latency_stats.max)
+        latency_stats.max = now - arrived;
+}
 
-    // recheck sync word using our center value
-    error_bits = 0;
-    for (i = 0; i < SYNC_BITS; ++i) {
-        int16_t dphi = phi_difference(phi[i*2], phi[i*2+1]);
+// Update the input counters after a read of 'n' bytes.
+// Return 1 if a discontinuity in the input was detected.
+static int monitor_input_read(int n)
+{
+    static double start_time = -1;
+    static uint64_t start_samples;
+    static double shortfall_baseline;
+    static int pipe_size;
+    static double backlog_since = -1;
+    static int backlog_warned;
+
+    int queued = 0;
+    double now = dump978_monotonic_now();
+    double shortfall;
+    uint64_t arrived;
+
+    input_stats.bytes += n;
+    ++input_stats.reads;
+
+    if (ioctl(0, FIONREAD, &queued) < 0)
+        queued = 0;
+
+    input_stats.backlog = queued;
+    if (queued > input_stats.max_backlog)
+        input_stats.max_backlog = queued;
+
+    arrived = (input_stats.bytes + queued) / 2;
+
+    if (start_time < 0) {
+        // first read; everything so far is the startup burst
+#ifdef F_GETPIPE_SZ
+        pipe_size = fcntl(0, F_GETPIPE_SZ);
+#endif
+        if (pipe_size <= 0)
+            pipe_size = 65536;
+        start_time = now;
+        start_samples = arrived;
+        shortfall_baseline = 0;
+        return 0;
+    }
 
-        if (pattern & (1UL << (35-i))) {
-            if (dphi < *center)
-                ++error_bits;
-        } else {
-            if (dphi >= *center)
-                ++error_bits;
+    // A full pipe means the writer is blocked, and a live source like
+    // rtl_sdr will start dropping samples. Upstream writes are often larger
+    // than the pipe, so it is only a problem if the pipe stays full.
+    if (queued >= pipe_size * 3 / 4) {
+        if (backlog_since < 0)
+            backlog_since = now;
+        if (now - backlog_since >= BACKLOG_WARNING_TIME && !backlog_warned) {
+            ++input_stats.backlog_warnings;
+            fprintf(stderr, "dump978: input backlog of %d bytes for %.1fs; not keeping up with the input\n",
+                    queued, now - backlog_since);
+            backlog_warned = 1;
         }
+    } else {
+        backlog_since = -1;
+        backlog_warned = 0;
     }
 
-    //fprintf(stdout, "check_sync_word: center=%.0fkHz, errors=%d\n", *center * 2083334.0 / 65536 / 1000, error_bits);
+    // Samples that should have arrived by now but did not. This jitters by
+    // up to one upstream transfer and drifts slowly with the difference
+    // between the sample clock and our clock; the baseline follows the
+    // minimum quickly and the drift slowly.
+    shortfall = (now - start_time) * SAMPLE_RATE - (double)(arrived - start_samples);
+    if (shortfall < shortfall_baseline) {
+        shortfall_baseline = shortfall;
+    } else if (shortfall - shortfall_baseline > DISCONTINUITY_THRESHOLD) {
+        uint64_t lost = (uint64_t)(shortfall - shortfall_baseline);
+        ++input_stats.discontinuities;
+        input_stats.lost_samples += lost;
+        fprintf(stderr, "dump978: input discontinuity after sample %llu: about %llu samples (%.0fms) missing\n",
+                (unsigned long long)input_stats.bytes / 2,
+                (unsigned long long)lost, lost / SAMPLE_RATE * 1000);
+        shortfall_baseline = shortfall;
+        return 1;
+    } else {
+        shortfall_baseline += (shortfall - shortfall_baseline) / 1024;
+    }
 
-    return (error_bits <= MAX_SYNC_ERRORS);
+    return 0;
 }
 
-#define SYNC_MASK ((((uint64_t)1)<<SYNC_BITS)-1)
-
-int process_buffer(uint16_t *phi, int len, uint64_t offset)    
+// Report statistics to stderr if the reporting interval has passed,
+// or unconditionally if 'final' is set.
+static void periodic_stats(int final)
 {
-    uint64_t sync0 = 0, sync1 = 0;
-    int lenbits;
-    int bit;
-
-    uint8_t demod_buf_a[UPLINK_FRAME_BYTES];
-    uint8_t demod_buf_b[UPLINK_FRAME_BYTES];
-
-    // We expect samples at twice the UAT bitrate.
-    // We look at phase difference between pairs of adjacent samples, i.e.
-    //  sample 1 - sample 0   -> sync0
-    //  sample 2 - sample 1   -> sync1
-    //  sample 3 - sample 2   -> sync0
-    //  sample 4 - sample 3   -> sync1
-    // ...
-    //
-    // We accumulate bits into two buffers, sync0 and sync1.
-    // Then we compare those buffers to the expected 36-bit sync word that
-    // should be at the start of each UAT frame. When (if) we find it,
-    // that tells us which sample to start decoding from.
-
-    // Stop when we run out of remaining samples for a max-sized frame.
-    // Arrange for our caller to pass the trailing data back to us next time;
-    // ensure we don't consume any partial sync word we might be part-way
-    // through. This means we don't need to maintain state between calls.
-
-    lenbits = len/2 - (SYNC_BITS + UPLINK_FRAME_BITS);
-    for (bit = 0; bit < lenbits; ++bit) {
-        int16_t dphi0 = phi_difference(phi[bit*2], phi[bit*2+1]);
-        int16_t dphi1 = phi_difference(phi[bit*2+1], phi[bit*2+2]);
-
-        sync0 = ((sync0 << 1) | (dphi0 > 0 ? 1 : 0)) & SYNC_MASK;
-        sync1 = ((sync1 << 1) | (dphi1 > 0 ? 1 : 0)) & SYNC_MASK;
-
-        if (bit < SYNC_BITS)
-            continue; // haven't fully populated sync0/1 yet
-
-        // see if we have (the start of) a valid sync word
-        // It would be nice to look at popcount(expected ^ sync) 
-        // so we can tolerate some errors, but that turns out
-        // to be very expensive to do on every sample
-
-        // when we find a match, try to demodulate both with that match
-        // and with the next position, and pick the one with fewer
-        // errors.
-
-        // check for downlink frames:
-        if (sync_word_fuzzy_compare(sync0, ADSB_SYNC_WORD) || sync_word_fuzzy_compare(sync1, ADSB_SYNC_WORD)) {
-            int startbit = (bit-SYNC_BITS+1);
-            int shift = (sync_word_fuzzy_compare(sync0, ADSB_SYNC_WORD) ? 0 : 1);
-            int index = startbit*2+shift;
-
-            int skip_0, skip_1;
-            int rs_0 = -1, rs_1 = -1;
-
-            skip_0 = demod_adsb_frame(phi+index, demod_buf_a, &rs_0);
-            skip_1 = demod_adsb_frame(phi+index+1, demod_buf_b, &rs_1);
-            if (skip_0 && rs_0 <= rs_1) {
-                handle_adsb_frame(offset+index, demod_buf_a, rs_0);
-                bit = startbit + skip_0;
-                continue;
-            } else if (skip_1 && rs_1 <= rs_0) {
-                handle_adsb_frame(offset+index+1, demod_buf_b, rs_1);
-                bit = startbit + skip_1;
-                continue;
-            } else {
-                // demod failed
-            }
-        }
+    static double next_report = -1;
+    double now = dump978_monotonic_now();
+
+    if (next_report < 0)
+        next_report = now + stats_interval;
+
+    if (!final && now < next_report)
+        return;
+    next_report = now + stats_interval;
+
+    fprintf(stderr, "dump978: messages: %llu downlink, %llu uplink\n",
+            (unsigned long long)demod_stats->adsb_frames,
+            (unsigned long long)demod_stats->uplink_frames);
+
+    if (demod_config.erasure_decoding) {
+        fprintf(stderr, "dump978: erasures: %llu candidates retried, %llu downlink and %llu uplink recovered, %.1fms spent on them\n",
+                (unsigned long long)demod_stats->erasure_retries,
+                (unsigned long long)demod_stats->adsb_recovered,
+                (unsigned long long)demod_stats->uplink_recovered,
+                demod_stats->erasure_time * 1000);
+    }
 
-        // check for uplink frames:
-        else if (sync_word_fuzzy_compare(sync0, UPLINK_SYNC_WORD) || sync_word_fuzzy_compare(sync1, UPLINK_SYNC_WORD)) {
-            int startbit = (bit-SYNC_BITS+1);
-            int shift = (sync_word_fuzzy_compare(sync0, UPLINK_SYNC_WORD) ? 0 : 1);
-            int index = startbit*2+shift;
-
-            int skip_0, skip_1;
-            int rs_0 = -1, rs_1 = -1;
-
-            skip_0 = demod_uplink_frame(phi+index, demod_buf_a, &rs_0);
-            skip_1 = demod_uplink_frame(phi+index+1, demod_buf_b, &rs_1);
-            if (skip_0 && rs_0 <= rs_1) {
-                handle_uplink_frame(offset+index, demod_buf_a, rs_0);
-                bit = startbit + skip_0;
-                continue;
-            } else if (skip_1 && rs_1 <= rs_0) {
-                handle_uplink_frame(offset+index+1, demod_buf_b, rs_1);
-                bit = startbit + skip_1;
-                continue;
-            } else {
-                // demod failed
-            }
-        }
+    if (latency_stats.messages > 0) {
+        fprintf(stderr, "dump978: latency: mean %.2fms, max %.2fms from the last sample of a message arriving to output\n",
+                latency_stats.total / latency_stats.messages * 1000,
+                latency_stats.max * 1000);
     }
 
-    return (bit - SYNC_BITS)*2;
+    if (monitor_input) {
+        fprintf(stderr,
+                "dump978: input: %llu samples in %llu reads, backlog %d bytes (max %d), "
+                "%llu backlog warnings, %llu discontinuities (about %llu samples lost)\n",
+                (unsigned long long)input_stats.bytes / 2,
+                (unsigned long long)input_stats.reads,
+                input_stats.backlog, input_stats.max_backlog,
+                (unsigned long long)input_stats.backlog_warnings,
+                (unsigned long long)input_stats.discontinuities,
+                (unsigned long long)input_stats.lost_samples);
+    }
+
+    if (fec_stats_file)
+        write_fec_stats();
 }
 
-// demodulate 'bytes' bytes from samples at 'phi' into 'frame',
-// using 'center_dphi' as the bit slicing threshold
-static void demod_frame(uint16_t *phi, uint8_t *frame, int bytes, int16_t center_dphi)
+// Append one line of JSON with the current time and the FEC counters
+static void write_fec_stats(void)
 {
-    while (--bytes >= 0) {
-        uint8_t b = 0;
-        if (phi_difference(phi[0], phi[1]) > center_dphi) b |= 0x80;
-        if (phi_difference(phi[2], phi[3]) > center_dphi) b |= 0x40;
-        if (phi_difference(phi[4], phi[5]) > center_dphi) b |= 0x20;
-        if (phi_difference(phi[6], phi[7]) > center_dphi) b |= 0x10;
-        if (phi_difference(phi[8], phi[9]) > center_dphi) b |= 0x08;
-        if (phi_difference(phi[10], phi[11]) > center_dphi) b |= 0x04;
-        if (phi_difference(phi[12], phi[13]) > center_dphi) b |= 0x02;
-        if (phi_difference(phi[14], phi[15]) > center_dphi) b |= 0x01;
-        *frame++ = b;
-        phi += 16;
-    }
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    fprintf(fec_stats_file, "{\"time\":%llu.%03u,\"fec\":",
+            (unsigned long long)now.tv_sec, (unsigned)(now.tv_usec / 1000));
+    fec_stats_write_json(fec_stats_file, fec_thread_stats());
+    fprintf(fec_stats_file, "}\n");
+    fflush(fec_stats_file);
 }
 
-// Demodulate an ADSB (Long UAT or Basic UAT) downlink frame
-// with the first sync bit in 'phi', storing the frame into 'to'
-// of length up to LONG_FRAME_BYTES. Set '*rs_errors' to the
-// number of corrected errors, or 9999 if demodulation failed.
-// Return 0 if demodulation failed, or the number of bits (not
-// samples) consumed if demodulation was OK.
-static int demod_adsb_frame(uint16_t *phi, uint8_t *to, int *rs_errors)
+static void read_from_stdin(struct dump978_demod *demod)
 {
-    int16_t center_dphi;
-    int frametype;
+    uint8_t buffer[65536*2];
+    int n;
+    uint64_t bytes_read = 0;
+
+    for (;;) {
+        int want = dump978_demod_space(demod);
+
+        if (demod_config.low_latency) {
+            // Read in small chunks while we are keeping up, so each
+            // frame is processed as soon as it arrives; read as much as
+            // is queued if we fall behind.
+            int queued = 0;
+            if (ioctl(0, FIONREAD, &queued) < 0 || queued < LOW_LATENCY_READ)
+                queued = LOW_LATENCY_READ;
+            if (want > queued)
+                want = queued;
+        }
 
-    if (!check_sync_word(phi, ADSB_SYNC_WORD, &center_dphi)) {
-        *rs_errors = 9999;
-        return 0;
-    }
+        if ((n = read(0, buffer, want)) <= 0)
+            break;
 
-    demod_frame(phi + SYNC_BITS*2, to, LONG_FRAME_BYTES, center_dphi);    
-    frametype = correct_adsb_frame(to, rs_errors);
-    if (frametype == 1)
-        return (SYNC_BITS + SHORT_FRAME_BITS);
-    else if (frametype == 2)
-        return (SYNC_BITS + LONG_FRAME_BITS);
-    else
-        return 0;
-}
+        bytes_read += n;
+        if (measure_latency)
+            record_arrival(bytes_read / 2);
 
-// Demodulate an uplink frame
-// with the first sync bit in 'phi', storing the frame into 'to'
-// of length up to UPLINK_FRAME_BYTES. Set '*rs_errors' to the
-// number of corrected errors, or 9999 if demodulation failed.
-// Return 0 if demodulation failed, or the number of bits (not
-// samples) consumed if demodulation was OK.
-static int demod_uplink_frame(uint16_t *phi, uint8_t *to, int *rs_errors)
-{
-    int16_t center_dphi;
-    uint8_t interleaved[UPLINK_FRAME_BYTES];
+        if (capture_file)
+            capture_raw_input((const char *) buffer, n);
 
-    if (!check_sync_word(phi, UPLINK_SYNC_WORD, &center_dphi)) {
-        *rs_errors = 9999;
-        return 0;
-    }
+        if (monitor_input && monitor_input_read(n) && reset_on_discontinuity) {
+            // Don't build frames across the gap: discard the unprocessed
+            // samples left over from before it.
+            dump978_demod_discard(demod);
+        }
 
-    demod_frame(phi + SYNC_BITS*2, interleaved, UPLINK_FRAME_BYTES, center_dphi);
+        dump978_demod_push(demod, buffer, n);
 
-    // deinterleave and correct
-    if (correct_uplink_frame(interleaved, to, rs_errors) == 1)
-        return (UPLINK_FRAME_BITS+SYNC_BITS);
-    else
-        return 0;
+        if (stats_interval > 0)
+            periodic_stats(0);
+    }
 }
@@ -16,7 +16,11 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "uat.h"
 #include "uat_decode.h"
@@ -140,7 +144,7 @@ void block_location(int bn, int ns, int sf, double *latN, double *lonW, double *
     }
 }
 
-void decode_nexrad(struct fisb_apdu *fisb)
+void decode_nexrad(struct fisb_apdu *fisb, FILE *out)
 {
     // Header:
     //
@@ -162,7 +166,7 @@ void decode_nexrad(struct fisb_apdu *fisb)
         double latN = 0, lonW = 0, latSize = 0, lonSize = 0;
         block_location(block_num, ns_flag, scale_factor, &latN, &lonW, &latSize, &lonSize);
 
-        fprintf(stdout, "NEXRAD %s %02d:%02d %d %.0f %.0f %.0f %.0f ",
+        fprintf(out, "NEXRAD %s %02d:%02d %d %.0f %.0f %.0f %.0f ",
                 fisb->product_id == 63 ? "Regional" : "CONUS",
                 fisb->hours,
                 fisb->minutes,
@@ -181,9 +185,9 @@ void decode_nexrad(struct fisb_apdu *fisb)
             int runlength = (fisb->data[i] >> 3) + 1;
 
             while (runlength-- > 0)
-                fprintf(stdout, "%d", intensity);
+                fprintf(out, "%d", intensity);
         }
-        fprintf(stdout, "\n");
+        fprintf(out, "\n");
     } else {
         int L = fisb->data[3] & 15;
         int i;
@@ -242,7 +246,7 @@ void decode_nexrad(struct fisb_apdu *fisb)
                     int k;
                     block_location(bn, ns_flag, scale_factor, &latN, &lonW, &latSize, &lonSize);
 
-                    fprintf(stdout, "NEXRAD %s %02d:%02d %d %.0f %.0f %.0f %.0f ",
+                    fprintf(out, "NEXRAD %s %02d:%02d %d %.0f %.0f %.0f %.0f ",
                             fisb->product_id == 63 ? "Regional" : "CONUS",
                             fisb->hours,
                             fisb->minutes,
@@ -256,45 +260,98 @@ void decode_nexrad(struct fisb_apdu *fisb)
                     // CONUS empty blocks = intensity 1 (valid data, but no precipitation)
                     // regional empty blocks = intensity 0 (valid data <5dBz)
                     for (k = 0; k < 128; ++k)
-                        fprintf(stdout, "%d", (fisb->product_id == 63 ? 0 : 1));
-                    fprintf(stdout, "\n");
+                        fprintf(out, "%d", (fisb->product_id == 63 ? 0 : 1));
+                    fprintf(out, "\n");
                 }
             }
         }
     }
 }
 
-void handle_frame(frame_type_t type, uint8_t *frame, int len, void *extra)
+static void nexrad_frame(frame_type_t type, uint8_t *frame, int len, FILE *out, void *extra)
 {
     if (type == UAT_UPLINK) {
-        struct uat_uplink_mdb mdb;
-        int i;
-
-        uat_decode_uplink_mdb(frame, &mdb);
-        if (!mdb.app_data_valid)
-            return;
+        struct uat_uplink_iter iter;
+        struct uat_uplink_info_frame info;
 
-        for (i = 0; i < mdb.num_info_frames; ++i) {
-            struct fisb_apdu *fisb;
-
-            if (!mdb.info_frames[i].is_fisb)
-                continue;
+        // only the NEXRAD frames are decoded, in place
+        uat_uplink_iter_init(&iter, frame);
+        while (uat_uplink_iter_next(&iter, &info)) {
+            int product_id = uat_uplink_info_frame_product_id(&info);
 
-            fisb = &mdb.info_frames[i].fisb;
-            if (fisb->product_id != 63 && fisb->product_id != 64)
+            if (product_id != 63 && product_id != 64)
                 continue;
 
-            decode_nexrad(fisb);
+            if (uat_decode_info_frame_fisb(&info))
+                decode_nexrad(&info.fisb, out);
         }
     }
+}
 
+void handle_frame(frame_type_t type, uint8_t *frame, int len, void *extra)
+{
+    nexrad_frame(type, frame, len, stdout, extra);
     fflush(stdout);
 }        
 
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-j THREADS [-u]]\n"
+            "\n"
+            "Reads UAT messages from stdin and writes the NEXRAD blocks in them to stdout.\n"
+            "\n"
+            "  -j THREADS  If stdin is a file, decode it on THREADS threads\n"
+            "  -u          With -j, write blocks in the order they are decoded\n"
+            "              rather than the order they are in the file\n"
+            "  -h          Show this usage message\n",
+            argv0);
+}
+
 int main(int argc, char **argv)
 {
     struct dump978_reader *reader;
+    struct stat st;
     int framecount;
+    int threads = 0, ordered = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hj:u")) > 0) {
+        switch (opt) {
+        case 'j':
+            threads = atoi(optarg);
+            break;
+        case 'u':
+            ordered = 0;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind < argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (threads > 0 && fstat(0, &st) == 0 && S_ISREG(st.st_mode)) {
+        struct dump978_parallel_config config;
+
+        memset(&config, 0, sizeof(config));
+        config.threads = threads;
+        config.ordered = ordered;
+        config.parallel_handler = nexrad_frame;
+        config.output = stdout;
+        if (dump978_read_parallel(0, &config) < 0) {
+            perror("dump978_read_parallel");
+            return 1;
+        }
+        return 0;
+    }
 
     reader = dump978_reader_new(0,0);
     if (!reader) {
@@ -312,4 +369,3 @@ int main(int argc, char **argv)
 
     return 0;
 }
-
@@ -21,42 +21,198 @@
 #include <string.h>
 #include <math.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "uat.h"
+#include "fec.h"
 #include "fec/rs.h"
+#include "tables.h"
+#include "fec_simd.h"
+#include "fec_decoders.h"
 
 static void *rs_uplink;
 static void *rs_adsb_short;
 static void *rs_adsb_long;
+static const struct fec_simd_impl *simd;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+
+// Correction statistics, per thread so that counting needs no locks or
+// atomics
+static __thread struct fec_stats stats;
 
 #define UPLINK_POLY 0x187
 #define ADSB_POLY 0x187
 
-void init_fec(void)
+static void do_init_fec(void)
 {
+#ifdef RUNTIME_TABLES
+    // gen_tables.c uses the same parameters to generate the tables
     rs_adsb_short = init_rs_char(8, /* gfpoly */ ADSB_POLY, /* fcr */ 120, /* prim */ 1, /* nroots */ 12, /* pad */ 225);
     rs_adsb_long  = init_rs_char(8, /* gfpoly */ ADSB_POLY, /* fcr */ 120, /* prim */ 1, /* nroots */ 14, /* pad */ 207);
     rs_uplink     = init_rs_char(8, /* gfpoly */ UPLINK_POLY, /* fcr */ 120, /* prim */ 1, /* nroots */ 20, /* pad */ 163);
+#else
+    // the decoder doesn't modify the control blocks
+    rs_adsb_short = (void *) &rs_adsb_short_table;
+    rs_adsb_long  = (void *) &rs_adsb_long_table;
+    rs_uplink     = (void *) &rs_uplink_table;
+#endif
+
+    simd = fec_simd_select();
 }
 
-int correct_adsb_frame(uint8_t *to, int *rs_errors)
+void init_fec(void)
+{
+    pthread_once(&init_once, do_init_fec);
+}
+
+// Count one decoded codeword of 'code': 'before' is the received
+// codeword (with stride 'stride'), 'after' the corrected one, and
+// 'n_corrected' the decoder's result (-1 if uncorrectable)
+static void count_codeword(int code, const uint8_t *before, int stride, const uint8_t *after, int len, int n_corrected)
+{
+    struct fec_code_stats *cs = &stats.code[code];
+    int i;
+
+    ++cs->codewords;
+    if (n_corrected < 0) {
+        ++cs->failed;
+        return;
+    }
+
+    ++cs->corrected[n_corrected];
+    if (n_corrected > 0) {
+        for (i = 0; i < len; ++i) {
+            if (before[i * stride] != after[i])
+                ++cs->positions[i];
+        }
+    }
+}
+
+// Count the outcome of correcting the downlink frame 'raw' into 'to'.
+// A frame that failed is counted against the code its MDB type suggests.
+static void count_adsb_frame(const uint8_t *raw, const uint8_t *to, int frametype, int rs_errors)
+{
+    if (frametype == 1)
+        count_codeword(FEC_STATS_ADSB_SHORT, raw, 1, to, SHORT_FRAME_BYTES, rs_errors);
+    else if (frametype == 2)
+        count_codeword(FEC_STATS_ADSB_LONG, raw, 1, to, LONG_FRAME_BYTES, rs_errors);
+    else
+        count_codeword((raw[0]>>3) == 0 ? FEC_STATS_ADSB_SHORT : FEC_STATS_ADSB_LONG, NULL, 1, NULL, 0, -1);
+}
+
+// Decode as a Long UAT, in place, skipping the decoder if the syndromes
+// are all zero. Returns the number of corrected errors, or -1 if
+// uncorrectable (in which case 'to' is unmodified)
+static int decode_adsb_long(uint8_t *to, const uint8_t *syndromes, int nonzero)
+{
+    return (nonzero ? decode_rs_adsb_long(to, syndromes, NULL, 0) : 0);
+}
+
+// Decode as a Basic UAT, in place; as above
+static int decode_adsb_short(uint8_t *to, const uint8_t *syndromes, int nonzero)
 {
+    return (nonzero ? decode_rs_adsb_short(to, syndromes, NULL, 0) : 0);
+}
+
+// Erasure decoding. Each erasure costs one parity symbol rather than
+// two, but erasing all of the parity would leave nothing to reject
+// garbage with, so erase the least reliable half and keep the other
+// half for correcting (and detecting) errors elsewhere.
+#define ERASURES(nroots) ((nroots) / 2)
+
+// Decode 'len' bytes at 'data' (a code with 'nroots' parity bytes) in
+// place, with the least reliable bytes erased. The confidence of byte i
+// is confidence[i * stride]. Returns the number of corrected symbols, or
+// -1 if uncorrectable (in which case 'data' may have been modified).
+static int decode_with_erasures(uint8_t *data, int len, int nroots,
+                                const uint16_t *confidence, int stride,
+                                int (*decode)(uint8_t *data, const uint8_t *syndromes, int *eras_pos, int no_eras))
+{
+    uint8_t syndromes[RS_SYNDROME_ROOTS];
+    uint8_t erased[UPLINK_BLOCK_BYTES];
+    int eras_pos[RS_SYNDROME_ROOTS];
+    int i, k, n_corrected;
+
+    // pick the ERASURES(nroots) lowest confidences
+    memset(erased, 0, len);
+    for (k = 0; k < ERASURES(nroots); ++k) {
+        int worst = -1;
+        for (i = 0; i < len; ++i) {
+            if (!erased[i] && (worst < 0 || confidence[i * stride] < confidence[worst * stride]))
+                worst = i;
+        }
+        erased[worst] = 1;
+        eras_pos[k] = worst + 255 - len;   // libfec counts positions from the start of the padding
+    }
+
+    simd->syndromes(data, len, nroots, syndromes);
+    n_corrected = decode(data, syndromes, eras_pos, ERASURES(nroots));
+    if (n_corrected < 0)
+        return -1;
+
+    // On return, eras_pos holds the positions of all corrected symbols.
+    // The decoder quietly skips any that fall in the padding, but that
+    // is known to be zero, so such a result is really a miscorrection.
+    // Without this check, erasure decoding of noise often "succeeds".
+    for (k = 0; k < n_corrected; ++k) {
+        if (eras_pos[k] < 255 - len)
+            return -1;
+    }
+
+    return n_corrected;
+}
+
+static int correct_adsb(uint8_t *to, int *rs_errors)
+{
+    uint8_t s_short[SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES];
+    uint8_t s_long[LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES];
+    int basic_hint = ((to[0]>>3) == 0);
+    int nonzero, n_corrected;
+
+    // Syndromes for both codes, in one pass. Most candidates are either
+    // error-free or garbage; the syndromes alone settle the first case,
+    // and avoid computing them twice in the second.
+    nonzero = simd->syndromes_adsb(to, s_short, s_long);
+
+    if (basic_hint) {
+        // The MDB type says this is a Basic UAT, so try that first.
+        // Decode a copy, so that a decode that turns out to have the
+        // wrong MDB type doesn't disturb the Long decode that follows.
+        uint8_t copy[SHORT_FRAME_BYTES];
+
+        memcpy(copy, to, SHORT_FRAME_BYTES);
+        n_corrected = decode_adsb_short(copy, s_short, nonzero & RS_SHORT_SYNDROMES_NONZERO);
+        if (n_corrected >= 0 && n_corrected <= 6 && (copy[0]>>3) == 0) {
+            // Valid short frame
+            memcpy(to, copy, SHORT_FRAME_BYTES);
+            *rs_errors = n_corrected;
+            return 1;
+        }
+    }
+
     // Try decoding as a Long UAT.
-    // We rely on decode_rs_char not modifying the data if there were
+    // We rely on the decoder not modifying the data if there were
     // uncorrectable errors.
-    int n_corrected = decode_rs_char(rs_adsb_long, to, NULL, 0);
+    n_corrected = decode_adsb_long(to, s_long, nonzero & RS_LONG_SYNDROMES_NONZERO);
     if (n_corrected >= 0 && n_corrected <= 7 && (to[0]>>3) != 0) {
         // Valid long frame.
         *rs_errors = n_corrected;
         return 2;
     }
 
-    // Retry as Basic UAT
-    n_corrected = decode_rs_char(rs_adsb_short, to, NULL, 0);
-    if (n_corrected >= 0 && n_corrected <= 6 && (to[0]>>3) == 0) {
-        // Valid short frame
-        *rs_errors = n_corrected;
-        return 1;
+    // Retry as Basic UAT, unless we already tried that above on the
+    // same data.
+    if (!basic_hint || n_corrected > 0) {
+        // if the Long decode corrected something, the Basic syndromes are stale
+        if (n_corrected > 0)
+            nonzero = (simd->syndromes(to, SHORT_FRAME_BYTES, sizeof(s_short), s_short) ? RS_SHORT_SYNDROMES_NONZERO : 0);
+
+        n_corrected = decode_adsb_short(to, s_short, nonzero & RS_SHORT_SYNDROMES_NONZERO);
+        if (n_corrected >= 0 && n_corrected <= 6 && (to[0]>>3) == 0) {
+            // Valid short frame
+            *rs_errors = n_corrected;
+            return 1;
+        }
     }
 
     // Failed.
@@ -64,30 +220,419 @@ int correct_adsb_frame(uint8_t *to, int *rs_errors)
     return -1;
 }
 
-int correct_uplink_frame(uint8_t *from, uint8_t *to, int *rs_errors)
+static int correct_adsb_eras(uint8_t *to, const uint16_t *confidence, int *rs_errors, int *erasures)
 {
-    int block;
+    uint8_t raw[LONG_FRAME_BYTES];
+    int basic_hint = ((to[0]>>3) == 0);
+    int attempt, frametype;
+
+    *erasures = 0;
+    memcpy(raw, to, LONG_FRAME_BYTES);
+    frametype = correct_adsb(to, rs_errors);
+    if (frametype > 0)
+        return frametype;
+
+    // Retry each code with erasures, starting with the one the MDB type suggests
+    for (attempt = 0; attempt < 2; ++attempt) {
+        int basic = ((attempt == 0) == basic_hint);
+        int n_corrected;
+
+        memcpy(to, raw, LONG_FRAME_BYTES);
+        if (basic) {
+            n_corrected = decode_with_erasures(to, SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES,
+                                               confidence, 1, decode_rs_adsb_short);
+            if (n_corrected >= 0 && (to[0]>>3) == 0) {
+                *rs_errors = n_corrected;
+                *erasures = ERASURES(SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES);
+                return 1;
+            }
+        } else {
+            n_corrected = decode_with_erasures(to, LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES,
+                                               confidence, 1, decode_rs_adsb_long);
+            if (n_corrected >= 0 && (to[0]>>3) != 0) {
+                *rs_errors = n_corrected;
+                *erasures = ERASURES(LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES);
+                return 2;
+            }
+        }
+    }
+
+    // Failed.
+    memcpy(to, raw, LONG_FRAME_BYTES);
+    *rs_errors = 9999;
+    return -1;
+}
+
+int correct_adsb_frame(uint8_t *to, int *rs_errors)
+{
+    uint8_t raw[LONG_FRAME_BYTES];
+    int frametype;
+
+    memcpy(raw, to, LONG_FRAME_BYTES);
+    frametype = correct_adsb(to, rs_errors);
+    count_adsb_frame(raw, to, frametype, *rs_errors);
+    return frametype;
+}
+
+int correct_adsb_frame_eras(uint8_t *to, const uint16_t *confidence, int *rs_errors, int *erasures)
+{
+    uint8_t raw[LONG_FRAME_BYTES];
+    int frametype;
+
+    memcpy(raw, to, LONG_FRAME_BYTES);
+    frametype = correct_adsb_eras(to, confidence, rs_errors, erasures);
+    count_adsb_frame(raw, to, frametype, *rs_errors);
+    return frametype;
+}
+
+// Correct an uplink frame; if 'confidence' is not NULL, retry blocks
+// that fail with erasures
+static int correct_uplink(uint8_t *from, const uint16_t *confidence, uint8_t *to, int *rs_errors, int *erasures)
+{
+    uint8_t blocks[UPLINK_FRAME_BLOCKS][UPLINK_BLOCK_BYTES];
+    uint8_t syndromes[UPLINK_FRAME_BLOCKS][RS_SYNDROME_ROOTS];
+    int block, nonzero;
     int total_corrected = 0;
 
-    for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
-        int i, n_corrected;
-        uint8_t *blockdata = &to[block * UPLINK_BLOCK_DATA_BYTES];
+    *erasures = 0;
+    ++stats.uplink_frames;
 
-        for (i = 0; i < UPLINK_BLOCK_BYTES; ++i)
-            blockdata[i] = from[i * UPLINK_FRAME_BLOCKS + block];
+    // Syndromes of all the blocks at once, straight from the interleaved data
+    nonzero = simd->syndromes_uplink(from, syndromes);
+    simd->deinterleave_uplink(from, blocks);
+
+    for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+        int n_corrected;
 
         // error-correct in place
-        n_corrected = decode_rs_char(rs_uplink, blockdata, NULL, 0);
-        if (n_corrected < 0 || n_corrected > 10) {
+        if (!(nonzero & (1 << block)))
+            n_corrected = 0;
+        else
+            n_corrected = decode_rs_uplink(blocks[block], syndromes[block], NULL, 0);
+
+        if ((n_corrected < 0 || n_corrected > 10) && confidence) {
+            int i;
+
+            // start again from the uncorrected block
+            for (i = 0; i < UPLINK_BLOCK_BYTES; ++i)
+                blocks[block][i] = from[i * UPLINK_FRAME_BLOCKS + block];
+            n_corrected = decode_with_erasures(blocks[block], UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES,
+                                               confidence + block, UPLINK_FRAME_BLOCKS, decode_rs_uplink);
+            if (n_corrected >= 0)
+                *erasures += ERASURES(UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES);
+        } else if (n_corrected > 10) {
+            n_corrected = -1;
+        }
+
+        count_codeword(FEC_STATS_UPLINK, from + block, UPLINK_FRAME_BLOCKS, blocks[block], UPLINK_BLOCK_BYTES, n_corrected);
+        if (n_corrected < 0) {
             // Failed
+            ++stats.uplink_failed_block[block];
             *rs_errors = 9999;
             return -1;
         }
 
         total_corrected += n_corrected;
-        // next block (if there is one) will overwrite the ECC bytes.
     }
 
+    // each block (after the first) overwrites the ECC bytes of the previous one
+    for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block)
+        memcpy(&to[block * UPLINK_BLOCK_DATA_BYTES], blocks[block], UPLINK_BLOCK_BYTES);
+
     *rs_errors = total_corrected;
     return 1;
 }
+
+int correct_uplink_frame(uint8_t *from, uint8_t *to, int *rs_errors)
+{
+    int erasures;
+    return correct_uplink(from, NULL, to, rs_errors, &erasures);
+}
+
+int correct_uplink_frame_eras(uint8_t *from, const uint16_t *confidence, uint8_t *to, int *rs_errors, int *erasures)
+{
+    return correct_uplink(from, confidence, to, rs_errors, erasures);
+}
+
+// correct_adsb_frame() on up to simd->lanes frames. Each of its steps is
+// done for all the frames that reach it before moving on to the next.
+static void correct_adsb_lanes(uint8_t *const *frames, int n, int *frametypes, int *rs_errors)
+{
+    uint8_t s_short[RS_MAX_LANES][RS_SYNDROME_ROOTS];
+    uint8_t s_long[RS_MAX_LANES][RS_SYNDROME_ROOTS];
+    uint8_t copies[RS_MAX_LANES][SHORT_FRAME_BYTES];
+    uint8_t *data[RS_MAX_LANES];
+    const uint8_t *syndromes[RS_MAX_LANES];
+    int lane[RS_MAX_LANES], results[RS_MAX_LANES], n_long[RS_MAX_LANES];
+    uint32_t short_nonzero, long_nonzero, basic_hint, pending;
+    int k, m;
+
+    simd->syndromes_lanes((const uint8_t *const *) frames, n, LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES,
+                          SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES,
+                          s_long, &long_nonzero, s_short, &short_nonzero);
+
+    // Frames with a Basic MDB type: decode copies as Basic UATs
+    pending = 0;
+    basic_hint = 0;
+    m = 0;
+    for (k = 0; k < n; ++k) {
+        pending |= 1U << k;
+        if ((frames[k][0]>>3) == 0)
+            basic_hint |= 1U << k;
+
+        if ((basic_hint & (1U << k)) && (short_nonzero & (1U << k))) {
+            memcpy(copies[k], frames[k], SHORT_FRAME_BYTES);
+            lane[m] = k;
+            data[m] = copies[k];
+            syndromes[m] = s_short[k];
+            ++m;
+        } else if (basic_hint & (1U << k)) {
+            // no errors, nothing to decode
+            frametypes[k] = 1;
+            rs_errors[k] = 0;
+            pending &= ~(1U << k);
+        }
+    }
+
+    decode_rs_lanes(simd, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES, SHORT_FRAME_BYTES, data, syndromes, m, results);
+    for (k = 0; k < m; ++k) {
+        if (results[k] >= 0 && results[k] <= 6 && (copies[lane[k]][0]>>3) == 0) {
+            memcpy(frames[lane[k]], copies[lane[k]], SHORT_FRAME_BYTES);
+            frametypes[lane[k]] = 1;
+            rs_errors[lane[k]] = results[k];
+            pending &= ~(1U << lane[k]);
+        }
+    }
+
+    // Everything else: decode as Long UATs
+    m = 0;
+    for (k = 0; k < n; ++k) {
+        n_long[k] = 0;
+        if (!(pending & (1U << k)))
+            continue;
+        if (long_nonzero & (1U << k)) {
+            lane[m] = k;
+            data[m] = frames[k];
+            syndromes[m] = s_long[k];
+            ++m;
+        } else if ((frames[k][0]>>3) != 0) {
+            frametypes[k] = 2;
+            rs_errors[k] = 0;
+            pending &= ~(1U << k);
+        }
+    }
+
+    decode_rs_lanes(simd, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES, LONG_FRAME_BYTES, data, syndromes, m, results);
+    for (k = 0; k < m; ++k) {
+        n_long[lane[k]] = results[k];
+        if (results[k] >= 0 && results[k] <= 7 && (frames[lane[k]][0]>>3) != 0) {
+            frametypes[lane[k]] = 2;
+            rs_errors[lane[k]] = results[k];
+            pending &= ~(1U << lane[k]);
+        }
+    }
+
+    // Retry as Basic UATs, unless already tried on the same data
+    m = 0;
+    for (k = 0; k < n; ++k) {
+        if (!(pending & (1U << k)))
+            continue;
+        if ((basic_hint & (1U << k)) && n_long[k] <= 0)
+            continue;
+        // if the Long decode corrected something, the Basic syndromes are stale
+        if (n_long[k] > 0)
+            simd->syndromes(frames[k], SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES, s_short[k]);
+        lane[m] = k;
+        data[m] = frames[k];
+        syndromes[m] = s_short[k];
+        ++m;
+    }
+
+    decode_rs_lanes(simd, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES, SHORT_FRAME_BYTES, data, syndromes, m, results);
+    for (k = 0; k < m; ++k) {
+        if (results[k] >= 0 && results[k] <= 6 && (frames[lane[k]][0]>>3) == 0) {
+            frametypes[lane[k]] = 1;
+            rs_errors[lane[k]] = results[k];
+            pending &= ~(1U << lane[k]);
+        }
+    }
+
+    // Failed.
+    for (k = 0; k < n; ++k) {
+        if (pending & (1U << k)) {
+            frametypes[k] = -1;
+            rs_errors[k] = 9999;
+        }
+    }
+}
+
+// Lane-parallel work costs the same however many lanes are in use, so
+// small remainders are cheaper to do one at a time
+#define MIN_LANES (simd->lanes / 4)
+
+void correct_adsb_frames_batch(uint8_t *const *frames, int n, int *frametypes, int *rs_errors)
+{
+    int i;
+
+    for (i = 0; i < n; i += simd->lanes) {
+        int chunk = (n - i < simd->lanes ? n - i : simd->lanes);
+
+        if (chunk < MIN_LANES) {
+            int k;
+            for (k = i; k < n; ++k)
+                frametypes[k] = correct_adsb_frame(frames[k], &rs_errors[k]);
+        } else {
+            uint8_t raw[RS_MAX_LANES][LONG_FRAME_BYTES];
+            int k;
+
+            for (k = 0; k < chunk; ++k)
+                memcpy(raw[k], frames[i + k], LONG_FRAME_BYTES);
+            correct_adsb_lanes(frames + i, chunk, frametypes + i, rs_errors + i);
+            for (k = 0; k < chunk; ++k)
+                count_adsb_frame(raw[k], frames[i + k], frametypes[i + k], rs_errors[i + k]);
+        }
+    }
+}
+
+void correct_uplink_blocks_batch(uint8_t *const *blocks, int n, int *rs_errors)
+{
+    uint8_t s[RS_MAX_LANES][RS_SYNDROME_ROOTS];
+    uint8_t raw[RS_MAX_LANES][UPLINK_BLOCK_BYTES];
+    const uint8_t *syndromes[RS_MAX_LANES];
+    uint32_t nonzero;
+    int i, k;
+
+    for (k = 0; k < simd->lanes; ++k)
+        syndromes[k] = s[k];
+
+    for (i = 0; i < n; i += simd->lanes) {
+        int chunk = (n - i < simd->lanes ? n - i : simd->lanes);
+
+        if (chunk < MIN_LANES) {
+            for (k = i; k < n; ++k) {
+                if (!simd->syndromes(blocks[k], UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES, s[0])) {
+                    rs_errors[k] = 0;
+                } else {
+                    memcpy(raw[0], blocks[k], UPLINK_BLOCK_BYTES);
+                    rs_errors[k] = decode_rs_uplink(blocks[k], s[0], NULL, 0);
+                }
+                if (rs_errors[k] > 10)
+                    rs_errors[k] = -1;
+                count_codeword(FEC_STATS_UPLINK, raw[0], 1, blocks[k], UPLINK_BLOCK_BYTES, rs_errors[k]);
+                if (rs_errors[k] < 0)
+                    rs_errors[k] = 9999;
+            }
+            continue;
+        }
+
+        simd->syndromes_lanes((const uint8_t *const *) blocks + i, chunk, UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES,
+                              0, 0, s, &nonzero, NULL, NULL);
+        if (!nonzero) {
+            memset(rs_errors + i, 0, chunk * sizeof(*rs_errors));
+            stats.code[FEC_STATS_UPLINK].codewords += chunk;
+            stats.code[FEC_STATS_UPLINK].corrected[0] += chunk;
+            continue;
+        }
+
+        for (k = 0; k < chunk; ++k)
+            memcpy(raw[k], blocks[i + k], UPLINK_BLOCK_BYTES);
+        decode_rs_lanes(simd, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES, UPLINK_BLOCK_BYTES,
+                        blocks + i, syndromes, chunk, rs_errors + i);
+        for (k = 0; k < chunk; ++k) {
+            if (rs_errors[i + k] > 10)
+                rs_errors[i + k] = -1;
+            count_codeword(FEC_STATS_UPLINK, raw[k], 1, blocks[i + k], UPLINK_BLOCK_BYTES, rs_errors[i + k]);
+            if (rs_errors[i + k] < 0)
+                rs_errors[i + k] = 9999;
+        }
+    }
+}
+
+int encode_adsb_frame(uint8_t *frame)
+{
+    if ((frame[0]>>3) == 0) {
+        encode_rs_adsb_short(frame);
+        return 1;
+    } else {
+        encode_rs_adsb_long(frame);
+        return 2;
+    }
+}
+
+void encode_uplink_frame(uint8_t *from, uint8_t *to)
+{
+    int block;
+
+    for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+        int i;
+        uint8_t blockdata[UPLINK_BLOCK_BYTES];
+
+        memcpy(blockdata, &from[block * UPLINK_BLOCK_DATA_BYTES], UPLINK_BLOCK_DATA_BYTES);
+        encode_rs_uplink(blockdata);
+
+        for (i = 0; i < UPLINK_BLOCK_BYTES; ++i)
+            to[i * UPLINK_FRAME_BLOCKS + block] = blockdata[i];
+    }
+}
+
+const struct fec_stats *fec_thread_stats(void)
+{
+    return &stats;
+}
+
+void fec_stats_merge(struct fec_stats *total, const struct fec_stats *from)
+{
+    int c, i;
+
+    for (c = 0; c < FEC_STATS_CODES; ++c) {
+        total->code[c].codewords += from->code[c].codewords;
+        total->code[c].failed += from->code[c].failed;
+        for (i = 0; i < FEC_STATS_MAX_CORRECTED + 1; ++i)
+            total->code[c].corrected[i] += from->code[c].corrected[i];
+        for (i = 0; i < UPLINK_BLOCK_BYTES; ++i)
+            total->code[c].positions[i] += from->code[c].positions[i];
+    }
+
+    total->uplink_frames += from->uplink_frames;
+    for (i = 0; i < UPLINK_FRAME_BLOCKS; ++i)
+        total->uplink_failed_block[i] += from->uplink_failed_block[i];
+}
+
+static void write_json_array(FILE *f, const uint64_t *values, int n)
+{
+    int i;
+
+    fputc('[', f);
+    for (i = 0; i < n; ++i)
+        fprintf(f, "%s%llu", i ? "," : "", (unsigned long long)values[i]);
+    fputc(']', f);
+}
+
+void fec_stats_write_json(FILE *f, const struct fec_stats *s)
+{
+    static const struct {
+        const char *name;
+        int len;
+        int nroots;
+    } codes[FEC_STATS_CODES] = {
+        { "adsb_short", SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES },
+        { "adsb_long", LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES },
+        { "uplink", UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES }
+    };
+    int c;
+
+    fprintf(f, "{");
+    for (c = 0; c < FEC_STATS_CODES; ++c) {
+        const struct fec_code_stats *cs = &s->code[c];
+
+        fprintf(f, "\"%s\":{\"codewords\":%llu,\"failed\":%llu,\"corrected\":",
+                codes[c].name, (unsigned long long)cs->codewords, (unsigned long long)cs->failed);
+        write_json_array(f, cs->corrected, codes[c].nroots + 1);
+        fprintf(f, ",\"positions\":");
+        write_json_array(f, cs->positions, codes[c].len);
+        fprintf(f, "},");
+    }
+    fprintf(f, "\"uplink_frames\":%llu,\"uplink_failed_block\":", (unsigned long long)s->uplink_frames);
+    write_json_array(f, s->uplink_failed_block, UPLINK_FRAME_BLOCKS);
+    fprintf(f, "}");
+}
@@ -18,18 +18,57 @@
 #ifndef DUMP978_FEC_H
 #define DUMP978_FEC_H
 
-/* Initialize. Must be called once before correct_* */
+#include <stdint.h>
+#include <stdio.h>
+
+/* Initialize. Must be called before correct_*; later calls, from any
+ * thread, do nothing. Everything set up here is read-only afterwards, and
+ * the statistics below are kept per thread, so the functions below may be
+ * called from several threads at once. */
 void init_fec(void);
 
 /* Correct a downlink frame.
  *
  * 'to' should contain LONG_FRAME_BYTES of data.
  * Errors are corrected in-place within 'to'.
+ * The MDB type in the first byte is used as a hint: if it is 0, the frame
+ * is decoded as a basic frame first, otherwise as a long frame first.
  * Returns -1 on uncorrectable errors, 1 for a valid basic frame, 2 for a valid long frame.
  * Sets *rs_errors to the number of corrected errors, or 9999 if uncorrectable.
  */
 int correct_adsb_frame(uint8_t *to, int *rs_errors);
 
+/* Correct a downlink frame, falling back to erasure decoding.
+ *
+ * As correct_adsb_frame(), with 'confidence' giving the reliability of
+ * each of the LONG_FRAME_BYTES bytes (higher is more reliable; the scale
+ * doesn't matter). If the plain decode fails, it is retried with the
+ * least reliable bytes declared as erasures, which can correct up to
+ * half as many symbols again.
+ * Sets *erasures to the number of erasures declared in the decode that
+ * succeeded, or 0 if the plain decode succeeded or all decodes failed.
+ */
+int correct_adsb_frame_eras(uint8_t *to, const uint16_t *confidence, int *rs_errors, int *erasures);
+
+/* Correct 'n' downlink frames together.
+ *
+ * frames[k] is a frame as for correct_adsb_frame(), corrected in-place.
+ * frametypes[k] and rs_errors[k] are set to the return value and
+ * *rs_errors of correct_adsb_frame() for that frame; the results are
+ * identical, but the syndromes and Chien search are computed for
+ * several frames at once. Worthwhile when candidates arrive in bulk.
+ */
+void correct_adsb_frames_batch(uint8_t *const *frames, int n, int *frametypes, int *rs_errors);
+
+/* Correct 'n' deinterleaved uplink blocks together.
+ *
+ * blocks[k] is UPLINK_BLOCK_BYTES of (already deinterleaved) block data
+ * and parity, corrected in-place.
+ * Sets rs_errors[k] to the number of corrected errors in that block, or
+ * 9999 if uncorrectable.
+ */
+void correct_uplink_blocks_batch(uint8_t *const *blocks, int n, int *rs_errors);
+
 /* Deinterleave and correct an uplink frame.
  *
  * 'from' should point to UPLINK_FRAME_BYTES of interleaved input data
@@ -41,4 +80,77 @@ int correct_adsb_frame(uint8_t *to, int *rs_errors);
  */
 int correct_uplink_frame(uint8_t *from, uint8_t *to, int *rs_errors);
 
+/* Deinterleave and correct an uplink frame, falling back to erasure decoding.
+ *
+ * As correct_uplink_frame(), with 'confidence' giving the reliability of
+ * each of the UPLINK_FRAME_BYTES (interleaved) bytes of 'from', as for
+ * correct_adsb_frame_eras(). Blocks that fail the plain decode are
+ * retried with erasures; *erasures is set to the total number of
+ * erasures declared in blocks that were corrected that way.
+ */
+int correct_uplink_frame_eras(uint8_t *from, const uint16_t *confidence, uint8_t *to, int *rs_errors, int *erasures);
+
+/* Encode a downlink frame.
+ *
+ * 'frame' should contain LONG_FRAME_BYTES of space, with the frame data
+ * (SHORT_FRAME_DATA_BYTES or LONG_FRAME_DATA_BYTES depending on the MDB type)
+ * at the start. The parity bytes are written in-place after the data.
+ * Returns 1 for a basic frame, 2 for a long frame.
+ */
+int encode_adsb_frame(uint8_t *frame);
+
+/* Encode and interleave an uplink frame.
+ *
+ * 'from' should point to UPLINK_FRAME_DATA_BYTES of input data
+ * 'to' should point to UPLINK_FRAME_BYTES of space for the interleaved output,
+ *   in the same format that correct_uplink_frame expects as input.
+ */
+void encode_uplink_frame(uint8_t *from, uint8_t *to);
+
+/* Reed-Solomon correction statistics.
+ *
+ * Every correct_* call above updates counters belonging to the calling
+ * thread, so the hot path needs no locking. Downlink frames count as one
+ * codeword of the code they decoded as, or (if they failed) of the code
+ * their MDB type suggests. Uplink frames count each block decoded, up to
+ * the first one that fails.
+ */
+enum { FEC_STATS_ADSB_SHORT, FEC_STATS_ADSB_LONG, FEC_STATS_UPLINK, FEC_STATS_CODES };
+
+/* The most symbols any UAT code can correct (with erasures) */
+#define FEC_STATS_MAX_CORRECTED (UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES)
+
+struct fec_code_stats {
+    uint64_t codewords;                                  /* decoded */
+    uint64_t failed;                                     /* of which, uncorrectable */
+    uint64_t corrected[FEC_STATS_MAX_CORRECTED + 1];     /* successes by number of corrected symbols */
+    uint64_t positions[UPLINK_BLOCK_BYTES];              /* corrected symbols by position in the codeword */
+};
+
+struct fec_stats {
+    struct fec_code_stats code[FEC_STATS_CODES];
+    uint64_t uplink_frames;                              /* uplink frames decoded */
+    uint64_t uplink_failed_block[UPLINK_FRAME_BLOCKS];   /* failed frames, by the block that failed */
+};
+
+/* The calling thread's counters. They are only updated by that thread;
+ * to read another thread's counters safely, have it merge them into a
+ * shared total under whatever lock protects that. */
+const struct fec_stats *fec_thread_stats(void);
+
+/* Add the counters in 'from' to 'total'. */
+void fec_stats_merge(struct fec_stats *total, const struct fec_stats *from);
+
+/* Write 's' to 'f' as a JSON object, on one line (without a newline):
+ *
+ *   {"adsb_short":{"codewords":N,"failed":N,"corrected":[...],"positions":[...]},
+ *    "adsb_long":{...},"uplink":{...},"uplink_frames":N,"uplink_failed_block":[...]}
+ *
+ * "corrected" has nroots+1 entries and "positions" one per codeword byte.
+ * Uplink positions are byte indexes within a (deinterleaved) block; byte
+ * i of each block is sent at about the same time, i/92 of the way
+ * through the frame.
+ */
+void fec_stats_write_json(FILE *f, const struct fec_stats *s);
+
 #endif
@@ -20,3 +20,16 @@ int decode_rs_char(void *p, data_t *data, int *eras_pos, int no_eras){
   
   return retval;
 }
+
+/* As decode_rs_char(), but with the syndromes of data[] (in polynomial
+ * form) already computed by the caller */
+int decode_rs_char_syn(void *p, data_t *data, const data_t *syndromes, int *eras_pos, int no_eras){
+  int retval;
+  struct rs *rs = (struct rs *)p;
+
+#define SYNDROMES syndromes
+#include "decode_rs.h"
+#undef SYNDROMES
+
+  return retval;
+}
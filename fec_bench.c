@@ -0,0 +1,539 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Reed-Solomon codec microbenchmark: times every decoder variant (the
+// generic libfec decoder, the specialized UAT decoders, and the
+// lane-parallel decoder with each SIMD implementation) on codewords with
+// 0..t+2 random symbol errors, with and without erasures, after checking
+// that each variant gives the same result as libfec's decode_rs_char()
+// on every codeword. Also times the encoders, correct_adsb_frame() on
+// typical kinds of downlink candidate, and the batch APIs at a range of
+// batch sizes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "uat.h"
+#include "fec.h"
+#include "fec_simd.h"
+#include "fec_decoders.h"
+#include "tables.h"
+#include "rs.h"
+
+#define POOL_SIZE 1024
+
+struct code {
+    const char *name;
+    const struct rs *rs;
+    int len;
+    int nroots;
+    int (*decode)(uint8_t *data, const uint8_t *syndromes, int *eras_pos, int no_eras);
+    void (*encode)(uint8_t *data);
+};
+
+static const struct code codes[] = {
+    { "adsb-short", &rs_adsb_short_table, SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES, decode_rs_adsb_short, encode_rs_adsb_short },
+    { "adsb-long", &rs_adsb_long_table, LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES, decode_rs_adsb_long, encode_rs_adsb_long },
+    { "uplink", &rs_uplink_table, UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES, decode_rs_uplink, encode_rs_uplink },
+    { NULL, NULL, 0, 0, NULL, NULL }
+};
+
+struct codeword {
+    uint8_t data[UPLINK_BLOCK_BYTES];
+    uint8_t syndromes[RS_SYNDROME_ROOTS];
+    int eras_pos[RS_SYNDROME_ROOTS];   // in libfec's (unshortened) coordinates
+    int no_eras;
+};
+
+static struct codeword pool[POOL_SIZE];
+
+static uint64_t bench_rng = 1;
+
+// xorshift64*, so runs are repeatable
+static uint32_t random_u32(void)
+{
+    bench_rng ^= bench_rng >> 12;
+    bench_rng ^= bench_rng << 25;
+    bench_rng ^= bench_rng >> 27;
+    return (uint32_t) ((bench_rng * 2685821657736338717ULL) >> 32);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// A number of errors in 1..t, as seen in frames that need correcting with
+// a decent antenna: each extra error is half as likely (1 error 50%,
+// 2 errors 25%, ...)
+static int typical_errors(int t)
+{
+    int n = 1;
+
+    while (n < t && (random_u32() & 1))
+        ++n;
+    return n;
+}
+
+// fill the pool with valid codewords, each with 'errors' symbols
+// replaced by different random values and 'erasures' symbols marked as
+// erased (and replaced by random values, which may happen to be right),
+// all at distinct positions; if 'errors' is -1, the number varies as
+// given by typical_errors()
+static void make_pool(const struct code *code, int errors, int erasures)
+{
+    const struct fec_simd_impl *impl = fec_simd_select();
+    int i, j;
+
+    for (i = 0; i < POOL_SIZE; ++i) {
+        struct codeword *cw = &pool[i];
+        uint8_t hit[UPLINK_BLOCK_BYTES];
+        int n = (errors < 0 ? typical_errors(code->nroots / 2) : errors);
+
+        for (j = 0; j < code->len - code->nroots; ++j)
+            cw->data[j] = random_u32();
+        code->encode(cw->data);
+
+        memset(hit, 0, sizeof(hit));
+        for (j = 0; j < n + erasures; ) {
+            int pos = random_u32() % code->len;
+            if (hit[pos])
+                continue;
+            hit[pos] = 1;
+            if (j < erasures) {
+                cw->eras_pos[j] = pos + 255 - code->len;
+                cw->data[pos] = random_u32();
+            } else {
+                cw->data[pos] ^= 1 + random_u32() % 255;
+            }
+            ++j;
+        }
+        cw->no_eras = erasures;
+
+        impl->syndromes(cw->data, code->len, code->nroots, cw->syndromes);
+    }
+}
+
+// The decoder variants. Each decodes the whole pool into 'scratch',
+// setting results[] to the return values, and has the same copying
+// overhead: the codeword and any erasure positions
+enum variant_kind { GENERIC, SPECIALIZED, LANES };
+
+struct variant {
+    char name[32];
+    enum variant_kind kind;
+    const struct fec_simd_impl *impl;  // for LANES
+};
+
+#define MAX_VARIANTS 8
+
+static struct variant variants[MAX_VARIANTS];
+static int n_variants;
+
+static void find_variants(void)
+{
+    const struct fec_simd_impl *impl;
+
+    strcpy(variants[0].name, "generic");
+    variants[0].kind = GENERIC;
+    strcpy(variants[1].name, "specialized");
+    variants[1].kind = SPECIALIZED;
+    n_variants = 2;
+
+    for (impl = fec_simd_impls; impl->name && n_variants < MAX_VARIANTS; ++impl) {
+        if (!impl->supported())
+            continue;
+        snprintf(variants[n_variants].name, sizeof(variants[n_variants].name), "lanes/%s", impl->name);
+        variants[n_variants].kind = LANES;
+        variants[n_variants].impl = impl;
+        ++n_variants;
+    }
+}
+
+// the lane-parallel decoder has no erasure support
+static int variant_applies(const struct variant *v, int erasures)
+{
+    return (v->kind != LANES || erasures == 0);
+}
+
+static void decode_pool(const struct code *code, const struct variant *v,
+                        uint8_t (*scratch)[UPLINK_BLOCK_BYTES], int *results)
+{
+    int eras_pos[RS_SYNDROME_ROOTS];
+    int j, k;
+
+    switch (v->kind) {
+    case GENERIC:
+        for (j = 0; j < POOL_SIZE; ++j) {
+            memcpy(scratch[j], pool[j].data, code->len);
+            memcpy(eras_pos, pool[j].eras_pos, sizeof(eras_pos));
+            results[j] = decode_rs_char_syn((void *) code->rs, scratch[j], pool[j].syndromes,
+                                            pool[j].no_eras ? eras_pos : NULL, pool[j].no_eras);
+        }
+        break;
+
+    case SPECIALIZED:
+        for (j = 0; j < POOL_SIZE; ++j) {
+            memcpy(scratch[j], pool[j].data, code->len);
+            memcpy(eras_pos, pool[j].eras_pos, sizeof(eras_pos));
+            results[j] = code->decode(scratch[j], pool[j].syndromes,
+                                      pool[j].no_eras ? eras_pos : NULL, pool[j].no_eras);
+        }
+        break;
+
+    case LANES:
+        for (j = 0; j < POOL_SIZE; j += v->impl->lanes) {
+            uint8_t *data[RS_MAX_LANES];
+            const uint8_t *syndromes[RS_MAX_LANES];
+            int n = (POOL_SIZE - j < v->impl->lanes ? POOL_SIZE - j : v->impl->lanes);
+
+            for (k = 0; k < n; ++k) {
+                memcpy(scratch[j + k], pool[j + k].data, code->len);
+                data[k] = scratch[j + k];
+                syndromes[k] = pool[j + k].syndromes;
+            }
+            decode_rs_lanes(v->impl, code->nroots, code->len, data, syndromes, n, results + j);
+        }
+        break;
+    }
+}
+
+// Differential check: every variant must give the same result and the
+// same corrected data as decode_rs_char(), which computes its own
+// syndromes, on every codeword of the pool
+static int check_pool(const struct code *code, int erasures)
+{
+    static uint8_t scratch[POOL_SIZE][UPLINK_BLOCK_BYTES];
+    static uint8_t expected[POOL_SIZE][UPLINK_BLOCK_BYTES];
+    static int results[POOL_SIZE], expected_results[POOL_SIZE];
+    int j, k;
+
+    for (j = 0; j < POOL_SIZE; ++j) {
+        int eras_pos[RS_SYNDROME_ROOTS];
+
+        memcpy(expected[j], pool[j].data, code->len);
+        memcpy(eras_pos, pool[j].eras_pos, sizeof(eras_pos));
+        expected_results[j] = decode_rs_char((void *) code->rs, expected[j],
+                                             pool[j].no_eras ? eras_pos : NULL, pool[j].no_eras);
+    }
+
+    for (k = 0; k < n_variants; ++k) {
+        if (!variant_applies(&variants[k], erasures))
+            continue;
+
+        decode_pool(code, &variants[k], scratch, results);
+        for (j = 0; j < POOL_SIZE; ++j) {
+            if (results[j] != expected_results[j] || memcmp(scratch[j], expected[j], code->len) != 0) {
+                fprintf(stderr, "%s: %s disagrees with decode_rs_char() on codeword %d (%d vs %d corrected)\n",
+                        code->name, variants[k].name, j, results[j], expected_results[j]);
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+// returns ns per codeword
+static double time_variant(const struct code *code, const struct variant *v, int iterations, int *failures)
+{
+    static uint8_t scratch[POOL_SIZE][UPLINK_BLOCK_BYTES];
+    static int results[POOL_SIZE];
+    double start, elapsed;
+    int i, j;
+
+    start = now();
+    for (i = 0; i < iterations; ++i)
+        decode_pool(code, v, scratch, results);
+    elapsed = now() - start;
+
+    *failures = 0;
+    for (j = 0; j < POOL_SIZE; ++j) {
+        if (results[j] < 0)
+            ++*failures;
+    }
+
+    return elapsed * 1e9 / iterations / POOL_SIZE;
+}
+
+// Time all the decoder variants on one kind of codeword, after
+// checking them. Returns 0 if the check failed.
+static int bench_decoders_row(const struct code *code, int errors, int erasures, int iterations)
+{
+    int k, failures = 0;
+
+    make_pool(code, errors, erasures);
+    if (!check_pool(code, erasures))
+        return 0;
+
+    if (errors < 0)
+        printf("%-12s %6s %6d", code->name, "mix", erasures);
+    else
+        printf("%-12s %6d %6d", code->name, errors, erasures);
+
+    for (k = 0; k < n_variants; ++k) {
+        if (variant_applies(&variants[k], erasures))
+            printf(" %13.0f", time_variant(code, &variants[k], iterations, &failures));
+        else
+            printf(" %13s", "-");
+    }
+
+    printf(" %9.1f%%\n", 100.0 * failures / POOL_SIZE);
+    return 1;
+}
+
+// ns per codeword for each decoder variant, by code, number of errors
+// (0..t+2, then the typical_errors() mix) and erasures (none, or half
+// of the parity with 0..t'+2 further errors, where t' is what the rest
+// of the parity can correct)
+static int bench_decoders(int iterations)
+{
+    const struct code *code;
+    int k;
+
+    printf("%-12s %6s %6s", "code", "errors", "eras");
+    for (k = 0; k < n_variants; ++k)
+        printf(" %13s", variants[k].name);
+    printf(" %10s\n", "failures");
+
+    for (code = codes; code->name; ++code) {
+        int erasures = code->nroots / 2;
+        int t = code->nroots / 2;
+        int t_eras = (code->nroots - erasures) / 2;
+        int errors;
+
+        for (errors = 0; errors <= t + 2; ++errors) {
+            if (!bench_decoders_row(code, errors, 0, iterations))
+                return 0;
+        }
+        if (!bench_decoders_row(code, -1, 0, iterations))
+            return 0;
+        for (errors = 0; errors <= t_eras + 2; ++errors) {
+            if (!bench_decoders_row(code, errors, erasures, iterations))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+// ns per codeword for encode_rs_char() and the specialized encoders
+static void bench_encoders(int iterations)
+{
+    const struct code *code;
+
+    printf("\n%-12s %13s %13s %8s\n", "encoder", "generic", "specialized", "speedup");
+    for (code = codes; code->name; ++code) {
+        double start, generic, specialized;
+        int i, j;
+
+        make_pool(code, 0, 0);
+
+        start = now();
+        for (i = 0; i < iterations; ++i) {
+            for (j = 0; j < POOL_SIZE; ++j)
+                encode_rs_char((void *) code->rs, pool[j].data, pool[j].data + code->len - code->nroots);
+        }
+        generic = (now() - start) * 1e9 / iterations / POOL_SIZE;
+
+        start = now();
+        for (i = 0; i < iterations; ++i) {
+            for (j = 0; j < POOL_SIZE; ++j)
+                code->encode(pool[j].data);
+        }
+        specialized = (now() - start) * 1e9 / iterations / POOL_SIZE;
+
+        printf("%-12s %10.0f ns %10.0f ns %7.2fx\n", code->name, generic, specialized, generic / specialized);
+    }
+}
+
+// downlink candidates: MDB type (-1 for garbage) and number of errors
+static const struct {
+    const char *name;
+    int mdb_type;
+    int errors;
+} candidates[] = {
+    { "basic, no errors", 0, 0 },
+    { "basic, 3 errors", 0, 3 },
+    { "long, no errors", 1, 0 },
+    { "long, 3 errors", 1, 3 },
+    { "garbage", -1, 0 },
+    { NULL, 0, 0 }
+};
+
+// fill frames[] with downlink candidates of one kind
+static void make_candidates(uint8_t (*frames)[LONG_FRAME_BYTES], int c)
+{
+    int i, j;
+
+    for (i = 0; i < POOL_SIZE; ++i) {
+        for (j = 0; j < LONG_FRAME_BYTES; ++j)
+            frames[i][j] = random_u32();
+        if (candidates[c].mdb_type >= 0) {
+            frames[i][0] = (candidates[c].mdb_type << 3) | (frames[i][0] & 7);
+            encode_adsb_frame(frames[i]);
+        }
+        for (j = 0; j < candidates[c].errors; ++j)
+            frames[i][1 + random_u32() % (LONG_FRAME_BYTES - 1)] ^= 1 + random_u32() % 255;
+    }
+}
+
+static void bench_correct_adsb(int iterations)
+{
+    static uint8_t frames[POOL_SIZE][LONG_FRAME_BYTES];
+    int c;
+
+    printf("\n%-20s %12s\n", "candidate", "correct_adsb_frame");
+    for (c = 0; candidates[c].name; ++c) {
+        uint8_t scratch[LONG_FRAME_BYTES];
+        double start, elapsed;
+        int i, j, rs_errors;
+
+        make_candidates(frames, c);
+
+        start = now();
+        for (i = 0; i < iterations; ++i) {
+            for (j = 0; j < POOL_SIZE; ++j) {
+                memcpy(scratch, frames[j], LONG_FRAME_BYTES);
+                correct_adsb_frame(scratch, &rs_errors);
+            }
+        }
+        elapsed = now() - start;
+
+        printf("%-20s %15.0f ns\n", candidates[c].name, elapsed * 1e9 / iterations / POOL_SIZE);
+    }
+}
+
+static const int batch_sizes[] = { 1, 4, 16, 32, 64, 256, 0 };
+
+// codewords/second through correct_adsb_frames_batch() and
+// correct_uplink_blocks_batch(), by batch size. Batch size 1 is
+// comparable with the single-frame APIs.
+static void bench_batch(int iterations)
+{
+    static uint8_t frames[POOL_SIZE][LONG_FRAME_BYTES];
+    static uint8_t scratch[POOL_SIZE][UPLINK_BLOCK_BYTES];
+    static uint8_t *data[POOL_SIZE];
+    static int frametypes[POOL_SIZE], rs_errors[POOL_SIZE];
+    static const int uplink_errors[] = { 0, 3, 10, -1 };
+    int b, c, e, i, j;
+
+    for (i = 0; i < POOL_SIZE; ++i)
+        data[i] = scratch[i];
+
+    printf("\n%-20s", "batch (Mcw/s)");
+    for (b = 0; batch_sizes[b]; ++b)
+        printf(" %7d", batch_sizes[b]);
+    printf("\n");
+
+    for (c = 0; candidates[c].name; ++c) {
+        make_candidates(frames, c);
+
+        printf("%-20s", candidates[c].name);
+        for (b = 0; batch_sizes[b]; ++b) {
+            double start, elapsed;
+
+            start = now();
+            for (i = 0; i < iterations; ++i) {
+                for (j = 0; j < POOL_SIZE; ++j)
+                    memcpy(scratch[j], frames[j], LONG_FRAME_BYTES);
+                for (j = 0; j < POOL_SIZE; j += batch_sizes[b])
+                    correct_adsb_frames_batch(data + j, batch_sizes[b], frametypes + j, rs_errors + j);
+            }
+            elapsed = now() - start;
+
+            printf(" %7.2f", iterations * POOL_SIZE / elapsed / 1e6);
+        }
+        printf("\n");
+    }
+
+    for (e = 0; uplink_errors[e] >= 0; ++e) {
+        make_pool(&codes[2], uplink_errors[e], 0);
+
+        printf("uplink, %2d errors    ", uplink_errors[e]);
+        for (b = 0; batch_sizes[b]; ++b) {
+            double start, elapsed;
+
+            start = now();
+            for (i = 0; i < iterations; ++i) {
+                for (j = 0; j < POOL_SIZE; ++j)
+                    memcpy(scratch[j], pool[j].data, UPLINK_BLOCK_BYTES);
+                for (j = 0; j < POOL_SIZE; j += batch_sizes[b])
+                    correct_uplink_blocks_batch(data + j, batch_sizes[b], rs_errors + j);
+            }
+            elapsed = now() - start;
+
+            printf(" %7.2f", iterations * POOL_SIZE / elapsed / 1e6);
+        }
+        printf("\n");
+    }
+}
+
+static void usage(int argc, char **argv)
+{
+    fprintf(stderr,
+            "Syntax: %s [-n ITERATIONS]\n"
+            "\n"
+            "Checks and benchmarks the Reed-Solomon decoder variants on codewords with\n"
+            "random errors and erasures, and benchmarks the encoders and downlink frame\n"
+            "and uplink block correction on typical candidates, one at a time and in\n"
+            "batches.\n"
+            "\n"
+            "  -n ITERATIONS  Passes over each pool of %d codewords (default 20)\n"
+            "  -h             Show this usage message\n",
+            argv[0], POOL_SIZE);
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hn:")) > 0) {
+        switch (opt) {
+        case 'h':
+            usage(argc, argv);
+            return 0;
+        case 'n':
+            iterations = atoi(optarg);
+            if (iterations <= 0) {
+                fprintf(stderr, "iteration count must be positive\n");
+                return 1;
+            }
+            break;
+        default:
+            usage(argc, argv);
+            return 1;
+        }
+    }
+
+    init_fec();
+    find_variants();
+
+    if (!bench_decoders(iterations))
+        return 1;
+    bench_encoders(iterations);
+    bench_correct_adsb(iterations);
+    bench_batch(iterations);
+    return 0;
+}
@@ -0,0 +1,413 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// The libfec decoder body (fec/decode_rs.h) instantiated once per UAT
+// code, with literal parameters instead of the fields of struct rs, so
+// that loop bounds, array sizes and modnn() reductions are all constant.
+// The three codes share the generated field tables from tables.h.
+//
+// decode_rs_lanes() is the same decoder split into its stages, so that
+// the Chien search can run on several codewords at once.
+//
+// Most corrected codewords have only one or two errors; decode_rs_few()
+// solves those directly from the syndromes, ahead of the full decoder.
+//
+// The encoders at the end replace libfec's symbol-at-a-time parity
+// update with one table lookup per data byte.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "fec_decoders.h"
+#include "fec_simd.h"
+#include "tables.h"
+
+typedef uint8_t data_t;
+
+// reduce x modulo 255; x is never more than a few multiples of 255 here
+static inline int modnn_255(int x)
+{
+    while (x >= 255) {
+        x -= 255;
+        x = (x >> 8) + (x & 255);
+    }
+    return x;
+}
+
+#define NN 255
+#define FCR RS_SYNDROME_FCR
+#define PRIM 1
+#define IPRIM 1
+#define ALPHA_TO rs_alpha_to
+#define INDEX_OF rs_index_of
+#define MODNN(x) modnn_255(x)
+#define SYNDROMES syndromes
+
+// multiply / divide field elements in polynomial form; b != 0 for gf_div
+static inline uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    return (a && b) ? ALPHA_TO[MODNN(INDEX_OF[a] + INDEX_OF[b])] : 0;
+}
+
+static inline uint8_t gf_div(uint8_t a, uint8_t b)
+{
+    return a ? ALPHA_TO[MODNN(INDEX_OF[a] + NN - INDEX_OF[b])] : 0;
+}
+
+// correct the error whose locator is alpha^p, given Y = e * X^FCR
+static inline void apply_error(uint8_t *data, int len, int p, uint8_t y)
+{
+    data[len - 1 - p] ^= ALPHA_TO[MODNN(INDEX_OF[y] + NN - MODNN(FCR * p))];
+}
+
+// An error of value e at data[len-1-p] contributes Y * X^i to syndrome i,
+// where X = alpha^p and Y = e * X^FCR.
+int decode_rs_few(int nroots, int len, uint8_t *data, const uint8_t *syndromes)
+{
+    const uint8_t *s = syndromes;
+    uint8_t d, sigma1, sigma2, y, x1, x2, y1, y2;
+    int i, p1, p2;
+
+    // One error: each syndrome is the previous one times X
+    if (s[0] && s[1]) {
+        int l = INDEX_OF[s[0]];
+        int p = MODNN(INDEX_OF[s[1]] + NN - l);
+
+        for (i = 1; i < nroots; ++i) {
+            l += p;
+            if (l >= NN)
+                l -= NN;
+            if (s[i] != ALPHA_TO[l])
+                break;
+        }
+
+        if (i == nroots) {
+            if (p >= len)
+                return 0;   // in the padding; leave that to the full decoder
+            apply_error(data, len, p, s[0]);
+            return 1;
+        }
+    }
+
+    // Two errors: the syndromes satisfy
+    //   s[i+2] = sigma1 * s[i+1] + sigma2 * s[i]
+    // where X1, X2 are the roots of x^2 + sigma1*x + sigma2.
+    // Solve the first two of these for sigma1, sigma2, then check the rest.
+    d = gf_mul(s[1], s[1]) ^ gf_mul(s[0], s[2]);
+    if (!d)
+        return 0;
+    sigma1 = gf_div(gf_mul(s[0], s[3]) ^ gf_mul(s[1], s[2]), d);
+    sigma2 = gf_div(gf_mul(s[1], s[3]) ^ gf_mul(s[2], s[2]), d);
+    if (!sigma1 || !sigma2)
+        return 0;
+
+    for (i = 2; i + 2 < nroots; ++i) {
+        if (s[i+2] != (gf_mul(sigma1, s[i+1]) ^ gf_mul(sigma2, s[i])))
+            return 0;
+    }
+
+    // substituting x = sigma1 * y gives y^2 + y = sigma2 / sigma1^2
+    y = rs_quadratic_root[gf_div(sigma2, gf_mul(sigma1, sigma1))];
+    if (!y)
+        return 0;
+    x1 = gf_mul(sigma1, y);
+    x2 = gf_mul(sigma1, y ^ 1);
+    p1 = INDEX_OF[x1];
+    p2 = INDEX_OF[x2];
+    if (p1 >= len || p2 >= len)
+        return 0;
+
+    // s[0] = Y1 + Y2, s[1] = Y1 X1 + Y2 X2
+    y1 = gf_div(s[1] ^ gf_mul(s[0], x2), sigma1);
+    y2 = s[0] ^ y1;
+    if (!y1 || !y2)
+        return 0;
+
+    apply_error(data, len, p1, y1);
+    apply_error(data, len, p2, y2);
+    return 2;
+}
+
+int decode_rs_adsb_short(uint8_t *data, const uint8_t *syndromes, int *eras_pos, int no_eras)
+{
+    int retval;
+
+    if (!eras_pos && (retval = decode_rs_few(12, 30, data, syndromes)) > 0)
+        return retval;
+
+#define NROOTS 12
+#define PAD 225
+#include "decode_rs.h"
+#undef NROOTS
+#undef PAD
+
+    return retval;
+}
+
+int decode_rs_adsb_long(uint8_t *data, const uint8_t *syndromes, int *eras_pos, int no_eras)
+{
+    int retval;
+
+    if (!eras_pos && (retval = decode_rs_few(14, 48, data, syndromes)) > 0)
+        return retval;
+
+#define NROOTS 14
+#define PAD 207
+#include "decode_rs.h"
+#undef NROOTS
+#undef PAD
+
+    return retval;
+}
+
+int decode_rs_uplink(uint8_t *data, const uint8_t *syndromes, int *eras_pos, int no_eras)
+{
+    int retval;
+
+    if (!eras_pos && (retval = decode_rs_few(20, 92, data, syndromes)) > 0)
+        return retval;
+
+#define NROOTS 20
+#define PAD 163
+#include "decode_rs.h"
+#undef NROOTS
+#undef PAD
+
+    return retval;
+}
+
+#undef SYNDROMES
+
+// Berlekamp-Massey, as in fec/decode_rs.h with no erasures.
+// 's' holds the syndromes in index form. Writes the error locator
+// polynomial to 'lambda' in polynomial form and returns its degree.
+static int berlekamp_massey(int nroots, const uint8_t *s, uint8_t *lambda)
+{
+    uint8_t b[RS_SYNDROME_ROOTS + 1], t[RS_SYNDROME_ROOTS + 1];
+    int deg_lambda, el, i, r;
+
+    memset(&lambda[1], 0, nroots);
+    lambda[0] = 1;
+    for (i = 0; i <= nroots; ++i)
+        b[i] = INDEX_OF[lambda[i]];
+
+    el = 0;
+    for (r = 1; r <= nroots; ++r) {
+        uint8_t discr_r = 0;
+
+        for (i = 0; i < r; ++i) {
+            if (lambda[i] != 0 && s[r-i-1] != NN)
+                discr_r ^= ALPHA_TO[MODNN(INDEX_OF[lambda[i]] + s[r-i-1])];
+        }
+        discr_r = INDEX_OF[discr_r];
+
+        if (discr_r == NN) {
+            memmove(&b[1], b, nroots);
+            b[0] = NN;
+            continue;
+        }
+
+        t[0] = lambda[0];
+        for (i = 0; i < nroots; ++i) {
+            if (b[i] != NN)
+                t[i+1] = lambda[i+1] ^ ALPHA_TO[MODNN(discr_r + b[i])];
+            else
+                t[i+1] = lambda[i+1];
+        }
+
+        if (2 * el <= r - 1) {
+            el = r - el;
+            for (i = 0; i <= nroots; ++i)
+                b[i] = (lambda[i] == 0) ? NN : MODNN(INDEX_OF[lambda[i]] - discr_r + NN);
+        } else {
+            memmove(&b[1], b, nroots);
+            b[0] = NN;
+        }
+        memcpy(lambda, t, nroots + 1);
+    }
+
+    deg_lambda = 0;
+    for (i = 0; i <= nroots; ++i) {
+        if (lambda[i] != 0)
+            deg_lambda = i;
+    }
+    return deg_lambda;
+}
+
+// Forney's algorithm, as in fec/decode_rs.h: correct the 'count' errors
+// whose locators are alpha^-root[j]. 's' is in index form, 'lambda'
+// in polynomial form.
+static void forney(int nroots, int pad, uint8_t *data, const uint8_t *s,
+                   const uint8_t *lambda_poly, int deg_lambda, const uint8_t *root, int count)
+{
+    uint8_t lambda[RS_SYNDROME_ROOTS + 1], omega[RS_SYNDROME_ROOTS + 1];
+    int deg_omega, i, j, last;
+
+    for (i = 0; i <= nroots; ++i)
+        lambda[i] = INDEX_OF[lambda_poly[i]];
+
+    deg_omega = deg_lambda - 1;
+    for (i = 0; i <= deg_omega; ++i) {
+        uint8_t tmp = 0;
+        for (j = i; j >= 0; --j) {
+            if (s[i - j] != NN && lambda[j] != NN)
+                tmp ^= ALPHA_TO[MODNN(s[i - j] + lambda[j])];
+        }
+        omega[i] = INDEX_OF[tmp];
+    }
+
+    last = (deg_lambda < nroots - 1 ? deg_lambda : nroots - 1) & ~1;
+    for (j = count - 1; j >= 0; --j) {
+        uint8_t num1 = 0, num2, den = 0;
+        int loc = root[j] - 1;
+
+        for (i = deg_omega; i >= 0; --i) {
+            if (omega[i] != NN)
+                num1 ^= ALPHA_TO[MODNN(omega[i] + i * root[j])];
+        }
+        num2 = ALPHA_TO[MODNN(root[j] * (FCR - 1) + NN)];
+
+        // lambda[i+1] for i even is the formal derivative of lambda[i]
+        for (i = last; i >= 0; i -= 2) {
+            if (lambda[i+1] != NN)
+                den ^= ALPHA_TO[MODNN(lambda[i+1] + i * root[j])];
+        }
+
+        if (num1 != 0 && loc >= pad)
+            data[loc - pad] ^= ALPHA_TO[MODNN(INDEX_OF[num1] + INDEX_OF[num2] + NN - INDEX_OF[den])];
+    }
+}
+
+void decode_rs_lanes(const struct fec_simd_impl *impl, int nroots, int len,
+                     uint8_t *const *data, const uint8_t *const *syndromes, int n, int *results)
+{
+    uint8_t s[RS_MAX_LANES][RS_SYNDROME_ROOTS];
+    uint8_t lambda[RS_MAX_LANES][RS_SYNDROME_ROOTS + 1];
+    int deg_lambda[RS_MAX_LANES], lane[RS_MAX_LANES];
+    uint32_t roots[256];
+    int pad = NN - len;
+    int i, k, m, maxdeg;
+
+    // Berlekamp-Massey on each codeword with nonzero syndromes; these
+    // are packed into lanes 0..m-1 for the Chien search
+    m = 0;
+    maxdeg = 0;
+    for (k = 0; k < n; ++k) {
+        int syn_error = 0;
+
+        for (i = 0; i < nroots; ++i) {
+            syn_error |= syndromes[k][i];
+            s[m][i] = INDEX_OF[syndromes[k][i]];
+        }
+
+        if (!syn_error) {
+            results[k] = 0;
+            continue;
+        }
+
+        if ((results[k] = decode_rs_few(nroots, len, data[k], syndromes[k])) > 0)
+            continue;
+
+        lane[m] = k;
+        deg_lambda[m] = berlekamp_massey(nroots, s[m], lambda[m]);
+        if (deg_lambda[m] > maxdeg)
+            maxdeg = deg_lambda[m];
+        ++m;
+    }
+
+    if (m == 0)
+        return;
+
+    impl->chien_lanes((const uint8_t (*)[RS_SYNDROME_ROOTS + 1]) lambda, m, maxdeg, roots);
+
+    for (k = 0; k < m; ++k) {
+        uint8_t root[RS_SYNDROME_ROOTS];
+        int count = 0;
+
+        // a polynomial has no more roots than its degree, so this finds
+        // the same roots as the scalar search that stops at deg_lambda
+        for (i = 1; i <= 255 && count < deg_lambda[k]; ++i) {
+            if (roots[i] & (1U << k))
+                root[count++] = i;
+        }
+
+        if (count != deg_lambda[k]) {
+            results[lane[k]] = -1;
+            continue;
+        }
+
+        forney(nroots, pad, data[lane[k]], s[k], lambda[k], deg_lambda[k], root, count);
+        results[lane[k]] = count;
+    }
+}
+
+// Table-driven systematic encoder. The parity register is shifted one
+// symbol per data byte and the feedback symbol's row of 'table' is
+// xored in, a whole register (three 64-bit words) at a time.
+static void encode_rs_table(const uint8_t (*table)[RS_ENCODE_WIDTH], int nroots, int len, uint8_t *data)
+{
+    uint8_t parity[RS_ENCODE_WIDTH];
+    int i;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // parity[0] is the low byte of p0, parity[8] the low byte of p1, ...
+    uint64_t p0 = 0, p1 = 0, p2 = 0;
+
+    for (i = 0; i < len - nroots; ++i) {
+        const uint8_t *row = table[data[i] ^ (uint8_t) p0];
+        uint64_t t0, t1, t2;
+
+        memcpy(&t0, row, 8);
+        memcpy(&t1, row + 8, 8);
+        memcpy(&t2, row + 16, 8);
+        p0 = ((p0 >> 8) | (p1 << 56)) ^ t0;
+        p1 = ((p1 >> 8) | (p2 << 56)) ^ t1;
+        p2 = (p2 >> 8) ^ t2;
+    }
+
+    memcpy(parity, &p0, 8);
+    memcpy(parity + 8, &p1, 8);
+    memcpy(parity + 16, &p2, 8);
+#else
+    int j;
+
+    memset(parity, 0, sizeof(parity));
+    for (i = 0; i < len - nroots; ++i) {
+        const uint8_t *row = table[data[i] ^ parity[0]];
+        for (j = 0; j < nroots - 1; ++j)
+            parity[j] = parity[j + 1] ^ row[j];
+        parity[nroots - 1] = row[nroots - 1];
+    }
+#endif
+
+    memcpy(data + len - nroots, parity, nroots);
+}
+
+void encode_rs_adsb_short(uint8_t *data)
+{
+    encode_rs_table(rs_encode_adsb_short, 12, 30, data);
+}
+
+void encode_rs_adsb_long(uint8_t *data)
+{
+    encode_rs_table(rs_encode_adsb_long, 14, 48, data);
+}
+
+void encode_rs_uplink(uint8_t *data)
+{
+    encode_rs_table(rs_encode_uplink, 20, 92, data);
+}
@@ -0,0 +1,73 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DUMP978_FEC_DECODERS_H
+#define DUMP978_FEC_DECODERS_H
+
+#include <stdint.h>
+
+/* Reed-Solomon decoders specialized for the three UAT codes.
+ *
+ * These behave exactly like decode_rs_char_syn() with the corresponding
+ * control block, but are compiled with the code parameters as constants.
+ *
+ * 'data' is the complete codeword (SHORT_FRAME_BYTES, LONG_FRAME_BYTES or
+ * UPLINK_BLOCK_BYTES), corrected in place.
+ * 'syndromes' are its syndromes, as computed by rs_syndromes() (fec_simd.h).
+ * 'eras_pos'/'no_eras' optionally give known erasure positions.
+ * Returns the number of corrected symbols, or -1 if uncorrectable.
+ * Without erasures, one and two errors are handled by decode_rs_few().
+ */
+int decode_rs_adsb_short(uint8_t *data, const uint8_t *syndromes, int *eras_pos, int no_eras);
+int decode_rs_adsb_long(uint8_t *data, const uint8_t *syndromes, int *eras_pos, int no_eras);
+int decode_rs_uplink(uint8_t *data, const uint8_t *syndromes, int *eras_pos, int no_eras);
+
+/* Correct one or two symbol errors in closed form.
+ *
+ * 'nroots' (at least 4) and 'len' select the code, as for decode_rs_lanes().
+ * If the nonzero 'syndromes' are exactly those of one or two errors
+ * within the codeword, corrects them in 'data' and returns 1 or 2; the
+ * full decoder would give the same result. Otherwise returns 0 and
+ * leaves 'data' unmodified.
+ */
+int decode_rs_few(int nroots, int len, uint8_t *data, const uint8_t *syndromes);
+
+/* Reed-Solomon encoders specialized for the three UAT codes.
+ *
+ * 'data' is a codeword as above; the parity bytes following its data
+ * bytes are overwritten with the same values encode_rs_char() gives.
+ */
+void encode_rs_adsb_short(uint8_t *data);
+void encode_rs_adsb_long(uint8_t *data);
+void encode_rs_uplink(uint8_t *data);
+
+struct fec_simd_impl;
+
+/* Decode 'n' codewords of the same UAT code together.
+ *
+ * The code is given by 'nroots' and the codeword length 'len'.
+ * data[k] is codeword k, corrected in place, and syndromes[k] its
+ * syndromes. 'n' must be at most impl->lanes.
+ * Codewords with zero syndromes are left alone; the rest go through the
+ * same stages as the decoders above, with the Chien search done for all
+ * of them at once by impl->chien_lanes.
+ * results[k] is set to what decode_rs_*() would return for codeword k.
+ */
+void decode_rs_lanes(const struct fec_simd_impl *impl, int nroots, int len,
+                     uint8_t *const *data, const uint8_t *const *syndromes, int n, int *results);
+
+#endif
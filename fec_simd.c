@@ -0,0 +1,764 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Syndrome computation for the UAT Reed-Solomon codes.
+//
+// The scalar version is the loop from fec/decode_rs.h, one log/antilog
+// table lookup per byte per root.
+//
+// The SIMD versions treat the codeword as W interleaved streams (W = 16
+// for SSSE3, 32 for AVX2) and run Horner's rule on all of them at once:
+// for each root r, P = P * r^W + next W bytes. Multiplying every lane by
+// the same constant is a pair of 16-entry table lookups (PSHUFB), one per
+// nibble, since multiplication by a constant is linear over GF(2). The
+// streams are then combined by repeatedly folding the vector in half:
+// P[k] = P[k] * r^(W/2) + P[k + W/2], down to a single byte, which is
+// the syndrome. The multiplication tables for each root and each power
+// of r are generated at build time (rs_syndrome_mul in tables.h).
+//
+// The Basic and Long ADS-B codes have the same roots, so evaluating the
+// Long code over a frame passes through the Basic code's syndromes after
+// the first SHORT_FRAME_BYTES. rs_syndromes_adsb_*() compute both in one
+// pass by picking up the intermediate state at that point.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "uat.h"
+#include "fec_simd.h"
+#include "tables.h"
+
+#define ADSB_SHORT_ROOTS (SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES)
+#define ADSB_LONG_ROOTS (LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES)
+
+static int always_supported(void)
+{
+    return 1;
+}
+
+// continue evaluating s[0..nroots) over data[0..len), by Horner's rule
+static void syndromes_update_scalar(uint8_t *s, const uint8_t *data, int len, int nroots)
+{
+    int i, j;
+
+    for (j = 0; j < len; ++j) {
+        for (i = 0; i < nroots; ++i) {
+            if (s[i] == 0) {
+                s[i] = data[j];
+            } else {
+                unsigned e = rs_index_of[s[i]] + RS_SYNDROME_FCR + i;
+                s[i] = data[j] ^ rs_alpha_to[e >= 255 ? e - 255 : e];
+            }
+        }
+    }
+}
+
+static int any_nonzero(const uint8_t *s, int n)
+{
+    int i;
+    int nonzero = 0;
+
+    for (i = 0; i < n; ++i)
+        nonzero |= s[i];
+    return nonzero;
+}
+
+static int rs_syndromes_scalar(const uint8_t *data, int len, int nroots, uint8_t *s)
+{
+    memset(s, 0, nroots);
+    syndromes_update_scalar(s, data, len, nroots);
+    return any_nonzero(s, nroots);
+}
+
+static int rs_syndromes_adsb_scalar(const uint8_t *frame, uint8_t *s_short, uint8_t *s_long)
+{
+    int nonzero = 0;
+
+    memset(s_long, 0, ADSB_LONG_ROOTS);
+    syndromes_update_scalar(s_long, frame, SHORT_FRAME_BYTES, ADSB_LONG_ROOTS);
+    memcpy(s_short, s_long, ADSB_SHORT_ROOTS);
+    syndromes_update_scalar(s_long, frame + SHORT_FRAME_BYTES, LONG_FRAME_BYTES - SHORT_FRAME_BYTES, ADSB_LONG_ROOTS);
+
+    if (any_nonzero(s_short, ADSB_SHORT_ROOTS))
+        nonzero |= RS_SHORT_SYNDROMES_NONZERO;
+    if (any_nonzero(s_long, ADSB_LONG_ROOTS))
+        nonzero |= RS_LONG_SYNDROMES_NONZERO;
+    return nonzero;
+}
+
+// mask of the first n lanes
+static inline uint32_t lane_mask(int n)
+{
+    return (n >= 32 ? 0xFFFFFFFFU : (1U << n) - 1);
+}
+
+static void rs_syndromes_lanes_scalar(const uint8_t *const *data, int n, int len, int nroots,
+                                      int split_len, int split_roots,
+                                      uint8_t (*s)[RS_SYNDROME_ROOTS], uint32_t *nonzero,
+                                      uint8_t (*split)[RS_SYNDROME_ROOTS], uint32_t *split_nonzero)
+{
+    int k;
+
+    if (!split_roots)
+        split_len = len;
+
+    *nonzero = 0;
+    if (split_roots)
+        *split_nonzero = 0;
+
+    for (k = 0; k < n; ++k) {
+        memset(s[k], 0, nroots);
+        syndromes_update_scalar(s[k], data[k], split_len, nroots);
+        if (split_roots) {
+            memcpy(split[k], s[k], split_roots);
+            if (any_nonzero(split[k], split_roots))
+                *split_nonzero |= 1U << k;
+        }
+        syndromes_update_scalar(s[k], data[k] + split_len, len - split_len, nroots);
+        if (any_nonzero(s[k], nroots))
+            *nonzero |= 1U << k;
+    }
+}
+
+// This is the Chien search loop from fec/decode_rs.h, for each lane in turn
+static void rs_chien_lanes_scalar(const uint8_t (*lambda)[RS_SYNDROME_ROOTS + 1], int n, int maxdeg, uint32_t *roots)
+{
+    uint8_t reg[RS_SYNDROME_ROOTS + 1];
+    int i, j, k;
+
+    memset(roots, 0, 256 * sizeof(*roots));
+    for (k = 0; k < n; ++k) {
+        for (j = 1; j <= maxdeg; ++j)
+            reg[j] = rs_index_of[lambda[k][j]];
+
+        for (i = 1; i <= 255; ++i) {
+            uint8_t q = 1;
+
+            for (j = 1; j <= maxdeg; ++j) {
+                if (reg[j] != 255) {
+                    unsigned e = reg[j] + j;
+                    reg[j] = (e >= 255 ? e - 255 : e);
+                    q ^= rs_alpha_to[reg[j]];
+                }
+            }
+
+            if (q == 0)
+                roots[i] |= 1U << k;
+        }
+    }
+}
+
+static void uplink_deinterleave_scalar(const uint8_t *frame, uint8_t (*blocks)[UPLINK_BLOCK_BYTES])
+{
+    int block, i;
+
+    for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block)
+        for (i = 0; i < UPLINK_BLOCK_BYTES; ++i)
+            blocks[block][i] = frame[i * UPLINK_FRAME_BLOCKS + block];
+}
+
+static int rs_syndromes_uplink_scalar(const uint8_t *frame, uint8_t (*s)[RS_SYNDROME_ROOTS])
+{
+    uint8_t blocks[UPLINK_FRAME_BLOCKS][UPLINK_BLOCK_BYTES];
+    int block, nonzero = 0;
+
+    uplink_deinterleave_scalar(frame, blocks);
+    for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+        if (rs_syndromes_scalar(blocks[block], UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES, s[block]))
+            nonzero |= 1 << block;
+    }
+    return nonzero;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#define HAVE_X86_SIMD
+
+// which row of rs_syndrome_mul[root] holds each multiplier
+#define MUL_R32 0
+#define MUL_R16 1
+#define MUL_R8  2
+#define MUL_R4  3
+#define MUL_R2  4
+#define MUL_R1  5
+
+// multiply each byte of x by the constant described by 'table'
+__attribute__((target("ssse3")))
+static inline __m128i gf_mul_128(__m128i x, const uint8_t *table)
+{
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    __m128i lo = _mm_and_si128(x, mask);
+    __m128i hi = _mm_and_si128(_mm_srli_epi64(x, 4), mask);
+
+    return _mm_xor_si128(_mm_shuffle_epi8(_mm_load_si128((const __m128i *) table), lo),
+                         _mm_shuffle_epi8(_mm_load_si128((const __m128i *) (table + 16)), hi));
+}
+
+// fold 16 streams down to the final syndrome
+__attribute__((target("ssse3")))
+static inline uint8_t fold_16(__m128i p, const uint8_t (*mul)[32])
+{
+    p = _mm_xor_si128(gf_mul_128(p, mul[MUL_R8]), _mm_srli_si128(p, 8));
+    p = _mm_xor_si128(gf_mul_128(p, mul[MUL_R4]), _mm_srli_si128(p, 4));
+    p = _mm_xor_si128(gf_mul_128(p, mul[MUL_R2]), _mm_srli_si128(p, 2));
+    p = _mm_xor_si128(gf_mul_128(p, mul[MUL_R1]), _mm_srli_si128(p, 1));
+    return (uint8_t) _mm_cvtsi128_si32(p);
+}
+
+// Multiply a syndrome that was evaluated with 'zeros' trailing zero
+// bytes appended to the data by r^-zeros, giving the syndrome of the
+// data alone
+static inline uint8_t remove_trailing_zeros(uint8_t v, int root, int zeros)
+{
+    unsigned e;
+
+    if (v == 0)
+        return 0;
+
+    e = rs_index_of[v] + 255 - ((RS_SYNDROME_FCR + root) * zeros) % 255;
+    return rs_alpha_to[e >= 255 ? e - 255 : e];
+}
+
+// Layout of a downlink frame for the joint syndrome computation:
+// ADSB_LEAD zero bytes, then the frame, then ADSB_TRAIL zero bytes. The
+// leading zeros make the Basic part end exactly on a 32-byte boundary.
+#define ADSB_LEAD (32 - SHORT_FRAME_BYTES)
+#define ADSB_TRAIL (64 - ADSB_LEAD - LONG_FRAME_BYTES)
+
+static void adsb_layout(uint8_t *buf, const uint8_t *frame)
+{
+    memset(buf, 0, ADSB_LEAD);
+    memcpy(buf + ADSB_LEAD, frame, LONG_FRAME_BYTES);
+    memset(buf + ADSB_LEAD + LONG_FRAME_BYTES, 0, ADSB_TRAIL);
+}
+
+__attribute__((target("ssse3")))
+static int rs_syndromes_ssse3(const uint8_t *data, int len, int nroots, uint8_t *s)
+{
+    // the data, right-aligned so that it ends on a chunk boundary;
+    // leading zeros don't change the value of the polynomial
+    uint8_t buf[256] __attribute__((aligned(16)));
+    int chunks = (len + 15) / 16;
+    int pad = chunks * 16 - len;
+    int i, j;
+    int syn_error = 0;
+
+    memset(buf, 0, pad);
+    memcpy(buf + pad, data, len);
+
+    for (i = 0; i < nroots; ++i) {
+        const uint8_t (*mul)[32] = rs_syndrome_mul[i];
+        __m128i p = _mm_load_si128((const __m128i *) buf);
+
+        for (j = 1; j < chunks; ++j)
+            p = _mm_xor_si128(gf_mul_128(p, mul[MUL_R16]),
+                              _mm_load_si128((const __m128i *) (buf + j * 16)));
+
+        s[i] = fold_16(p, mul);
+        syn_error |= s[i];
+    }
+
+    return syn_error;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i gf_mul_256(__m256i x, const uint8_t *table)
+{
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(x, mask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi64(x, 4), mask);
+    __m256i tlo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *) table));
+    __m256i thi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *) (table + 16)));
+
+    return _mm256_xor_si256(_mm256_shuffle_epi8(tlo, lo), _mm256_shuffle_epi8(thi, hi));
+}
+
+// fold 32 streams down to 16, then as for SSSE3
+__attribute__((target("avx2")))
+static inline uint8_t fold_32(__m256i p, const uint8_t (*mul)[32])
+{
+    __m128i half = _mm_xor_si128(gf_mul_128(_mm256_castsi256_si128(p), mul[MUL_R16]),
+                                 _mm256_extracti128_si256(p, 1));
+    return fold_16(half, mul);
+}
+
+__attribute__((target("avx2")))
+static int rs_syndromes_avx2(const uint8_t *data, int len, int nroots, uint8_t *s)
+{
+    uint8_t buf[256] __attribute__((aligned(32)));
+    int chunks = (len + 31) / 32;
+    int pad = chunks * 32 - len;
+    int i, j;
+    int syn_error = 0;
+
+    memset(buf, 0, pad);
+    memcpy(buf + pad, data, len);
+
+    for (i = 0; i < nroots; ++i) {
+        const uint8_t (*mul)[32] = rs_syndrome_mul[i];
+        __m256i p = _mm256_load_si256((const __m256i *) buf);
+
+        for (j = 1; j < chunks; ++j)
+            p = _mm256_xor_si256(gf_mul_256(p, mul[MUL_R32]),
+                                 _mm256_load_si256((const __m256i *) (buf + j * 32)));
+
+        s[i] = fold_32(p, mul);
+        syn_error |= s[i];
+    }
+
+    return syn_error;
+}
+
+__attribute__((target("ssse3")))
+static int rs_syndromes_adsb_ssse3(const uint8_t *frame, uint8_t *s_short, uint8_t *s_long)
+{
+    uint8_t buf[64] __attribute__((aligned(16)));
+    int i;
+    int short_error = 0, long_error = 0;
+
+    adsb_layout(buf, frame);
+
+    for (i = 0; i < ADSB_LONG_ROOTS; ++i) {
+        const uint8_t (*mul)[32] = rs_syndrome_mul[i];
+        __m128i p = _mm_load_si128((const __m128i *) buf);
+
+        p = _mm_xor_si128(gf_mul_128(p, mul[MUL_R16]), _mm_load_si128((const __m128i *) (buf + 16)));
+        if (i < ADSB_SHORT_ROOTS) {
+            s_short[i] = fold_16(p, mul);
+            short_error |= s_short[i];
+        }
+
+        p = _mm_xor_si128(gf_mul_128(p, mul[MUL_R16]), _mm_load_si128((const __m128i *) (buf + 32)));
+        p = _mm_xor_si128(gf_mul_128(p, mul[MUL_R16]), _mm_load_si128((const __m128i *) (buf + 48)));
+        s_long[i] = remove_trailing_zeros(fold_16(p, mul), i, ADSB_TRAIL);
+        long_error |= s_long[i];
+    }
+
+    return (short_error ? RS_SHORT_SYNDROMES_NONZERO : 0) | (long_error ? RS_LONG_SYNDROMES_NONZERO : 0);
+}
+
+__attribute__((target("avx2")))
+static int rs_syndromes_adsb_avx2(const uint8_t *frame, uint8_t *s_short, uint8_t *s_long)
+{
+    uint8_t buf[64] __attribute__((aligned(32)));
+    int i;
+    int short_error = 0, long_error = 0;
+
+    adsb_layout(buf, frame);
+
+    for (i = 0; i < ADSB_LONG_ROOTS; ++i) {
+        const uint8_t (*mul)[32] = rs_syndrome_mul[i];
+        __m256i p = _mm256_load_si256((const __m256i *) buf);
+
+        if (i < ADSB_SHORT_ROOTS) {
+            s_short[i] = fold_32(p, mul);
+            short_error |= s_short[i];
+        }
+
+        p = _mm256_xor_si256(gf_mul_256(p, mul[MUL_R32]), _mm256_load_si256((const __m256i *) (buf + 32)));
+        s_long[i] = remove_trailing_zeros(fold_32(p, mul), i, ADSB_TRAIL);
+        long_error |= s_long[i];
+    }
+
+    return (short_error ? RS_SHORT_SYNDROMES_NONZERO : 0) | (long_error ? RS_LONG_SYNDROMES_NONZERO : 0);
+}
+
+// Lane-parallel functions: the codewords are transposed so that each
+// byte position becomes a vector holding that byte of every codeword.
+// Every lane is then multiplied by the same constant at each step, which
+// is what the split-nibble tables do.
+
+__attribute__((target("ssse3")))
+static void transpose_16x16(__m128i *r)
+{
+    __m128i t[16];
+    int round, i;
+
+    // four rounds of interleaving row i with row i+8
+    for (round = 0; round < 4; ++round) {
+        for (i = 0; i < 8; ++i) {
+            t[2*i] = _mm_unpacklo_epi8(r[i], r[i+8]);
+            t[2*i+1] = _mm_unpackhi_epi8(r[i], r[i+8]);
+        }
+        memcpy(r, t, sizeof(t));
+    }
+}
+
+// Transpose 'len' bytes (len >= 16) of up to 'lanes' codewords into
+// cols, 'lanes' bytes per byte position. Missing lanes are zero.
+__attribute__((target("ssse3")))
+static void transpose_lanes(const uint8_t *const *data, int n, int len, int lanes, uint8_t *cols)
+{
+    __m128i r[16];
+    int half, offset, k;
+
+    for (half = 0; half * 16 < lanes; ++half) {
+        for (offset = 0; offset < len; offset += 16) {
+            // the last block overlaps the previous one if len isn't a
+            // multiple of 16
+            int o = (offset + 16 <= len ? offset : len - 16);
+
+            for (k = 0; k < 16; ++k) {
+                int lane = half * 16 + k;
+                r[k] = (lane < n ? _mm_loadu_si128((const __m128i *) (data[lane] + o)) : _mm_setzero_si128());
+            }
+
+            transpose_16x16(r);
+            for (k = 0; k < 16; ++k)
+                _mm_storeu_si128((__m128i *) (cols + (o + k) * lanes + half * 16), r[k]);
+        }
+    }
+}
+
+// scatter syndrome i of each lane from 'acc' into s[lane][i]
+__attribute__((target("ssse3")))
+static void store_lanes_16(__m128i acc, int i, int n, uint8_t (*s)[RS_SYNDROME_ROOTS], uint32_t *nonzero)
+{
+    uint8_t tmp[16] __attribute__((aligned(16)));
+    int k;
+
+    _mm_store_si128((__m128i *) tmp, acc);
+    for (k = 0; k < n; ++k)
+        s[k][i] = tmp[k];
+    *nonzero |= ~_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) & lane_mask(n);
+}
+
+__attribute__((target("ssse3")))
+static void rs_syndromes_lanes_ssse3(const uint8_t *const *data, int n, int len, int nroots,
+                                     int split_len, int split_roots,
+                                     uint8_t (*s)[RS_SYNDROME_ROOTS], uint32_t *nonzero,
+                                     uint8_t (*split)[RS_SYNDROME_ROOTS], uint32_t *split_nonzero)
+{
+    uint8_t cols[255][16] __attribute__((aligned(16)));
+    int i, j;
+
+    if (!split_roots)
+        split_len = len;
+
+    transpose_lanes(data, n, len, 16, &cols[0][0]);
+
+    *nonzero = 0;
+    if (split_roots)
+        *split_nonzero = 0;
+
+    for (i = 0; i < nroots; ++i) {
+        const uint8_t *r = rs_syndrome_mul[i][MUL_R1];
+        __m128i acc = _mm_setzero_si128();
+
+        for (j = 0; j < split_len; ++j)
+            acc = _mm_xor_si128(gf_mul_128(acc, r), _mm_load_si128((const __m128i *) cols[j]));
+        if (i < split_roots)
+            store_lanes_16(acc, i, n, split, split_nonzero);
+        for (; j < len; ++j)
+            acc = _mm_xor_si128(gf_mul_128(acc, r), _mm_load_si128((const __m128i *) cols[j]));
+        store_lanes_16(acc, i, n, s, nonzero);
+    }
+}
+
+__attribute__((target("ssse3")))
+static void rs_chien_lanes_ssse3(const uint8_t (*lambda)[RS_SYNDROME_ROOTS + 1], int n, int maxdeg, uint32_t *roots)
+{
+    __m128i reg[RS_SYNDROME_ROOTS + 1];
+    uint8_t tmp[16] __attribute__((aligned(16)));
+    const __m128i one = _mm_set1_epi8(1);
+    uint32_t mask = lane_mask(n);
+    int i, j, k;
+
+    for (j = 1; j <= maxdeg; ++j) {
+        for (k = 0; k < 16; ++k)
+            tmp[k] = (k < n ? lambda[k][j] : 0);
+        reg[j] = _mm_load_si128((const __m128i *) tmp);
+    }
+
+    // at step i, reg[j] = lambda[j] * alpha^(i*j)
+    roots[0] = 0;
+    for (i = 1; i <= 255; ++i) {
+        __m128i q = one;
+
+        for (j = 1; j <= maxdeg; ++j) {
+            reg[j] = gf_mul_128(reg[j], rs_chien_mul[j-1]);
+            q = _mm_xor_si128(q, reg[j]);
+        }
+
+        roots[i] = _mm_movemask_epi8(_mm_cmpeq_epi8(q, _mm_setzero_si128())) & mask;
+    }
+}
+
+__attribute__((target("avx2")))
+static void store_lanes_32(__m256i acc, int i, int n, uint8_t (*s)[RS_SYNDROME_ROOTS], uint32_t *nonzero)
+{
+    uint8_t tmp[32] __attribute__((aligned(32)));
+    int k;
+
+    _mm256_store_si256((__m256i *) tmp, acc);
+    for (k = 0; k < n; ++k)
+        s[k][i] = tmp[k];
+    *nonzero |= ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(acc, _mm256_setzero_si256())) & lane_mask(n);
+}
+
+__attribute__((target("avx2")))
+static void rs_syndromes_lanes_avx2(const uint8_t *const *data, int n, int len, int nroots,
+                                    int split_len, int split_roots,
+                                    uint8_t (*s)[RS_SYNDROME_ROOTS], uint32_t *nonzero,
+                                    uint8_t (*split)[RS_SYNDROME_ROOTS], uint32_t *split_nonzero)
+{
+    uint8_t cols[255][32] __attribute__((aligned(32)));
+    int i, j;
+
+    if (!split_roots)
+        split_len = len;
+
+    transpose_lanes(data, n, len, 32, &cols[0][0]);
+
+    *nonzero = 0;
+    if (split_roots)
+        *split_nonzero = 0;
+
+    for (i = 0; i < nroots; ++i) {
+        const uint8_t *r = rs_syndrome_mul[i][MUL_R1];
+        __m256i acc = _mm256_setzero_si256();
+
+        for (j = 0; j < split_len; ++j)
+            acc = _mm256_xor_si256(gf_mul_256(acc, r), _mm256_load_si256((const __m256i *) cols[j]));
+        if (i < split_roots)
+            store_lanes_32(acc, i, n, split, split_nonzero);
+        for (; j < len; ++j)
+            acc = _mm256_xor_si256(gf_mul_256(acc, r), _mm256_load_si256((const __m256i *) cols[j]));
+        store_lanes_32(acc, i, n, s, nonzero);
+    }
+}
+
+__attribute__((target("avx2")))
+static void rs_chien_lanes_avx2(const uint8_t (*lambda)[RS_SYNDROME_ROOTS + 1], int n, int maxdeg, uint32_t *roots)
+{
+    __m256i reg[RS_SYNDROME_ROOTS + 1];
+    uint8_t tmp[32] __attribute__((aligned(32)));
+    const __m256i one = _mm256_set1_epi8(1);
+    uint32_t mask = lane_mask(n);
+    int i, j, k;
+
+    for (j = 1; j <= maxdeg; ++j) {
+        for (k = 0; k < 32; ++k)
+            tmp[k] = (k < n ? lambda[k][j] : 0);
+        reg[j] = _mm256_load_si256((const __m256i *) tmp);
+    }
+
+    roots[0] = 0;
+    for (i = 1; i <= 255; ++i) {
+        __m256i q = one;
+
+        for (j = 1; j <= maxdeg; ++j) {
+            reg[j] = gf_mul_256(reg[j], rs_chien_mul[j-1]);
+            q = _mm256_xor_si256(q, reg[j]);
+        }
+
+        roots[i] = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(q, _mm256_setzero_si256())) & mask;
+    }
+}
+
+// Uplink frames: row j of the interleaved frame (bytes 6j..6j+5) is
+// byte j of each of the six blocks, so the frame is already in the
+// layout the lane-parallel code wants, six lanes wide.
+
+// Deinterleave 16 rows (six vectors) at a time, with one shuffle per
+// block per vector. The last 16 rows overlap the previous ones.
+__attribute__((target("ssse3")))
+static void uplink_deinterleave_ssse3(const uint8_t *frame, uint8_t (*blocks)[UPLINK_BLOCK_BYTES])
+{
+    int row, block, v;
+
+    for (row = 0; row < UPLINK_BLOCK_BYTES; row += 16) {
+        int r = (row + 16 <= UPLINK_BLOCK_BYTES ? row : UPLINK_BLOCK_BYTES - 16);
+        __m128i x[UPLINK_FRAME_BLOCKS];
+
+        for (v = 0; v < UPLINK_FRAME_BLOCKS; ++v)
+            x[v] = _mm_loadu_si128((const __m128i *) (frame + r * UPLINK_FRAME_BLOCKS + v * 16));
+
+        for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+            __m128i out = _mm_setzero_si128();
+            for (v = 0; v < UPLINK_FRAME_BLOCKS; ++v)
+                out = _mm_or_si128(out, _mm_shuffle_epi8(x[v], _mm_load_si128((const __m128i *) uplink_deinterleave_shuffle[block][v])));
+            _mm_storeu_si128((__m128i *) (blocks[block] + r), out);
+        }
+    }
+}
+
+// Load the frame as pairs of rows: lanes 0-5 hold byte 2m of each block
+// and lanes 6-11 byte 2m+1. Then for each root r, Horner's rule with r^2
+// evaluates the even and odd bytes of each block separately, and
+// s = r * even + odd.
+#define UPLINK_PAIRS (UPLINK_BLOCK_BYTES / 2)
+
+__attribute__((target("ssse3")))
+static void load_uplink_pairs(const uint8_t *frame, __m128i *pairs)
+{
+    uint8_t last[16];
+    int m;
+
+    // all but the last pair can be loaded in place
+    for (m = 0; m < UPLINK_PAIRS - 1; ++m)
+        pairs[m] = _mm_loadu_si128((const __m128i *) (frame + m * 2 * UPLINK_FRAME_BLOCKS));
+
+    memset(last, 0, sizeof(last));
+    memcpy(last, frame + m * 2 * UPLINK_FRAME_BLOCKS, 2 * UPLINK_FRAME_BLOCKS);
+    pairs[m] = _mm_loadu_si128((const __m128i *) last);
+}
+
+// Horner's rule with r^2 over the pairs; two roots at a time, as the
+// steps of each are dependent
+__attribute__((target("ssse3")))
+static int rs_syndromes_uplink_ssse3(const uint8_t *frame, uint8_t (*s)[RS_SYNDROME_ROOTS])
+{
+    __m128i pairs[UPLINK_PAIRS];
+    uint8_t tmp[2][16] __attribute__((aligned(16)));
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    int i, m, block, nonzero = 0;
+
+    load_uplink_pairs(frame, pairs);
+
+    for (i = 0; i < UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES; i += 2) {
+        const __m128i t0_lo = _mm_load_si128((const __m128i *) rs_syndrome_mul[i][MUL_R2]);
+        const __m128i t0_hi = _mm_load_si128((const __m128i *) (rs_syndrome_mul[i][MUL_R2] + 16));
+        const __m128i t1_lo = _mm_load_si128((const __m128i *) rs_syndrome_mul[i+1][MUL_R2]);
+        const __m128i t1_hi = _mm_load_si128((const __m128i *) (rs_syndrome_mul[i+1][MUL_R2] + 16));
+        __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+
+        for (m = 0; m < UPLINK_PAIRS; ++m) {
+            acc0 = _mm_xor_si128(_mm_xor_si128(_mm_shuffle_epi8(t0_lo, _mm_and_si128(acc0, mask)),
+                                               _mm_shuffle_epi8(t0_hi, _mm_and_si128(_mm_srli_epi64(acc0, 4), mask))),
+                                 pairs[m]);
+            acc1 = _mm_xor_si128(_mm_xor_si128(_mm_shuffle_epi8(t1_lo, _mm_and_si128(acc1, mask)),
+                                               _mm_shuffle_epi8(t1_hi, _mm_and_si128(_mm_srli_epi64(acc1, 4), mask))),
+                                 pairs[m]);
+        }
+
+        acc0 = _mm_xor_si128(gf_mul_128(acc0, rs_syndrome_mul[i][MUL_R1]), _mm_srli_si128(acc0, UPLINK_FRAME_BLOCKS));
+        acc1 = _mm_xor_si128(gf_mul_128(acc1, rs_syndrome_mul[i+1][MUL_R1]), _mm_srli_si128(acc1, UPLINK_FRAME_BLOCKS));
+
+        _mm_store_si128((__m128i *) tmp[0], acc0);
+        _mm_store_si128((__m128i *) tmp[1], acc1);
+        for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+            s[block][i] = tmp[0][block];
+            s[block][i+1] = tmp[1][block];
+        }
+        nonzero |= ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(acc0, acc1), _mm_setzero_si128()));
+    }
+
+    return nonzero & ((1 << UPLINK_FRAME_BLOCKS) - 1);
+}
+
+// As above, with roots i, i+1 in the two halves of one vector and
+// i+2, i+3 in another
+__attribute__((target("avx2")))
+static inline __m256i load_table_pair(int i, int step, int offset)
+{
+    return _mm256_loadu2_m128i((const __m128i *) (rs_syndrome_mul[i+1][step] + offset),
+                               (const __m128i *) (rs_syndrome_mul[i][step] + offset));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i gf_mul_256_pair(__m256i x, __m256i t_lo, __m256i t_hi)
+{
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+
+    return _mm256_xor_si256(_mm256_shuffle_epi8(t_lo, _mm256_and_si256(x, mask)),
+                            _mm256_shuffle_epi8(t_hi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+}
+
+__attribute__((target("avx2")))
+static int rs_syndromes_uplink_avx2(const uint8_t *frame, uint8_t (*s)[RS_SYNDROME_ROOTS])
+{
+    __m128i pairs[UPLINK_PAIRS];
+    uint8_t tmp[2][32] __attribute__((aligned(32)));
+    uint32_t nonzero = 0;
+    int i, m, block;
+
+    load_uplink_pairs(frame, pairs);
+
+    for (i = 0; i < UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES; i += 4) {
+        const __m256i t0_lo = load_table_pair(i, MUL_R2, 0), t0_hi = load_table_pair(i, MUL_R2, 16);
+        const __m256i t1_lo = load_table_pair(i + 2, MUL_R2, 0), t1_hi = load_table_pair(i + 2, MUL_R2, 16);
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+
+        for (m = 0; m < UPLINK_PAIRS; ++m) {
+            __m256i col = _mm256_broadcastsi128_si256(pairs[m]);
+            acc0 = _mm256_xor_si256(gf_mul_256_pair(acc0, t0_lo, t0_hi), col);
+            acc1 = _mm256_xor_si256(gf_mul_256_pair(acc1, t1_lo, t1_hi), col);
+        }
+
+        acc0 = _mm256_xor_si256(gf_mul_256_pair(acc0, load_table_pair(i, MUL_R1, 0), load_table_pair(i, MUL_R1, 16)),
+                                _mm256_srli_si256(acc0, UPLINK_FRAME_BLOCKS));
+        acc1 = _mm256_xor_si256(gf_mul_256_pair(acc1, load_table_pair(i + 2, MUL_R1, 0), load_table_pair(i + 2, MUL_R1, 16)),
+                                _mm256_srli_si256(acc1, UPLINK_FRAME_BLOCKS));
+
+        _mm256_store_si256((__m256i *) tmp[0], acc0);
+        _mm256_store_si256((__m256i *) tmp[1], acc1);
+        for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+            s[block][i] = tmp[0][block];
+            s[block][i+1] = tmp[0][16 + block];
+            s[block][i+2] = tmp[1][block];
+            s[block][i+3] = tmp[1][16 + block];
+        }
+        nonzero |= ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_or_si256(acc0, acc1), _mm256_setzero_si256()));
+    }
+
+    return (nonzero | (nonzero >> 16)) & ((1 << UPLINK_FRAME_BLOCKS) - 1);
+}
+
+static int ssse3_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+static int avx2_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif /* x86 */
+
+const struct fec_simd_impl fec_simd_impls[] = {
+#ifdef HAVE_X86_SIMD
+    { "avx2", 32, rs_syndromes_avx2, rs_syndromes_adsb_avx2,
+      rs_syndromes_lanes_avx2, rs_chien_lanes_avx2,
+      rs_syndromes_uplink_avx2, uplink_deinterleave_ssse3, avx2_supported },
+    { "ssse3", 16, rs_syndromes_ssse3, rs_syndromes_adsb_ssse3,
+      rs_syndromes_lanes_ssse3, rs_chien_lanes_ssse3,
+      rs_syndromes_uplink_ssse3, uplink_deinterleave_ssse3, ssse3_supported },
+#endif
+    { "scalar", RS_MAX_LANES, rs_syndromes_scalar, rs_syndromes_adsb_scalar,
+      rs_syndromes_lanes_scalar, rs_chien_lanes_scalar,
+      rs_syndromes_uplink_scalar, uplink_deinterleave_scalar, always_supported },
+    { NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL }
+};
+
+const struct fec_simd_impl *fec_simd_select(void)
+{
+    const struct fec_simd_impl *impl;
+
+    for (impl = fec_simd_impls; impl->name; ++impl) {
+        if (impl->supported())
+            return impl;
+    }
+
+    // not reached, scalar is always supported
+    return NULL;
+}
@@ -0,0 +1,107 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DUMP978_FEC_SIMD_H
+#define DUMP978_FEC_SIMD_H
+
+#include <stdint.h>
+
+#include "uat.h"
+#include "tables.h"
+
+/* Compute Reed-Solomon syndromes for the UAT codes.
+ *
+ * All UAT codes share the field (poly 0x187) and the first consecutive
+ * root (fcr 120, prim 1), so they differ only in block length and the
+ * number of roots. For a (shortened) codeword 'data' of 'len' bytes,
+ * writes s[i] = data(alpha^(120+i)) for i in [0, nroots), in polynomial
+ * form, which is what decode_rs_char_syn() expects.
+ *
+ * 'len' must be at most 255 and 'nroots' at most RS_SYNDROME_ROOTS.
+ * Returns nonzero if any syndrome is nonzero, i.e. the data is not a
+ * valid codeword.
+ */
+typedef int (*rs_syndromes_fn)(const uint8_t *data, int len, int nroots, uint8_t *s);
+
+/* Compute the syndromes of a downlink frame of LONG_FRAME_BYTES for both
+ * the Basic code (over the first SHORT_FRAME_BYTES, 12 roots) and the
+ * Long code (14 roots), in a single pass over the frame.
+ * Returns a combination of the flags below, set if any of the
+ * corresponding syndromes are nonzero.
+ */
+typedef int (*rs_syndromes_adsb_fn)(const uint8_t *frame, uint8_t *s_short, uint8_t *s_long);
+
+#define RS_SHORT_SYNDROMES_NONZERO 1
+#define RS_LONG_SYNDROMES_NONZERO 2
+
+/* Maximum number of codewords handled by one call to the *_lanes
+ * functions below */
+#define RS_MAX_LANES 32
+
+/* Compute the syndromes of 'n' codewords of the same code at once, one
+ * codeword per SIMD lane. data[k] points to the 'len' bytes of codeword k
+ * (16 <= len <= 255), s[k] receives its 'nroots' syndromes, and bit k of
+ * *nonzero is set if any of them are nonzero.
+ *
+ * If split_roots is nonzero, split[k] and *split_nonzero likewise receive
+ * the first 'split_roots' syndromes of the first 'split_len' bytes of each
+ * codeword (i.e. the Basic code's syndromes within a Long frame).
+ */
+typedef void (*rs_syndromes_lanes_fn)(const uint8_t *const *data, int n, int len, int nroots,
+                                      int split_len, int split_roots,
+                                      uint8_t (*s)[RS_SYNDROME_ROOTS], uint32_t *nonzero,
+                                      uint8_t (*split)[RS_SYNDROME_ROOTS], uint32_t *split_nonzero);
+
+/* Chien search on 'n' error locator polynomials at once.
+ * lambda[k][0..maxdeg] is the polynomial for lane k, in polynomial form,
+ * with lambda[k][0] == 1 and zeros above its degree.
+ * For i = 1..255, bit k of roots[i] is set if lambda_k(alpha^i) == 0.
+ */
+typedef void (*rs_chien_lanes_fn)(const uint8_t (*lambda)[RS_SYNDROME_ROOTS + 1], int n, int maxdeg, uint32_t *roots);
+
+/* Compute the syndromes of all UPLINK_FRAME_BLOCKS blocks of an uplink
+ * frame of UPLINK_FRAME_BYTES, directly from the interleaved data.
+ * s[b] receives the syndromes of block b. Returns a mask with bit b set
+ * if any of the syndromes of block b are nonzero.
+ */
+typedef int (*rs_syndromes_uplink_fn)(const uint8_t *frame, uint8_t (*s)[RS_SYNDROME_ROOTS]);
+
+/* Deinterleave an uplink frame of UPLINK_FRAME_BYTES into its blocks. */
+typedef void (*uplink_deinterleave_fn)(const uint8_t *frame, uint8_t (*blocks)[UPLINK_BLOCK_BYTES]);
+
+/* One implementation of the above */
+struct fec_simd_impl {
+    const char *name;
+    int lanes;                              /* at most RS_MAX_LANES */
+    rs_syndromes_fn syndromes;
+    rs_syndromes_adsb_fn syndromes_adsb;
+    rs_syndromes_lanes_fn syndromes_lanes;
+    rs_chien_lanes_fn chien_lanes;
+    rs_syndromes_uplink_fn syndromes_uplink;
+    uplink_deinterleave_fn deinterleave_uplink;
+    int (*supported)(void);                 /* nonzero if usable on this CPU */
+};
+
+/* All implementations, fastest first, terminated by an entry with a NULL
+ * name. The last real entry is the portable scalar version, which is
+ * always supported. */
+extern const struct fec_simd_impl fec_simd_impls[];
+
+/* Return the fastest implementation supported by this CPU. */
+const struct fec_simd_impl *fec_simd_select(void);
+
+#endif
@@ -24,6 +24,10 @@
 
 #include "uat.h"
 #include "fec.h"
+#include "fec_simd.h"
+#include "fec_decoders.h"
+#include "tables.h"
+#include "rs.h"
 
 // Test data from DO-282B:
 //  Table 2-104 "ADS-B Message Reception - Set 1"
@@ -178,6 +182,948 @@ static void hex_to_bytes(const char *s, uint8_t *to)
         *to++ = (uint8_t) hexbyte(s);
 }
 
+static uint32_t test_rng = 1;
+
+// xorshift32, so the random tests are repeatable
+static uint8_t random_byte(void)
+{
+    test_rng ^= test_rng << 13;
+    test_rng ^= test_rng >> 17;
+    test_rng ^= test_rng << 5;
+    return (uint8_t) test_rng;
+}
+
+// Check one syndrome implementation against the scalar reference,
+// and check that decoding with its syndromes gives the same result as
+// the plain decoder
+static int check_syndromes(const struct fec_simd_impl *impl, const struct fec_simd_impl *ref,
+                           const struct rs *rs, const uint8_t *data, int len, int nroots)
+{
+    uint8_t s[RS_SYNDROME_ROOTS], s_ref[RS_SYNDROME_ROOTS];
+    uint8_t copy[UPLINK_BLOCK_BYTES], copy_ref[UPLINK_BLOCK_BYTES];
+    int err, err_ref;
+
+    err = impl->syndromes(data, len, nroots, s);
+    err_ref = ref->syndromes(data, len, nroots, s_ref);
+    if ((err != 0) != (err_ref != 0) || memcmp(s, s_ref, nroots) != 0)
+        return 0;
+
+    if (!rs)
+        return 1;
+
+    memcpy(copy, data, len);
+    memcpy(copy_ref, data, len);
+    err = (err ? decode_rs_char_syn((void *) rs, copy, s, NULL, 0) : 0);
+    err_ref = decode_rs_char((void *) rs, copy_ref, NULL, 0);
+    return (err == err_ref && memcmp(copy, copy_ref, len) == 0);
+}
+
+static int test_syndromes(void)
+{
+    const struct fec_simd_impl *impl, *ref;
+    int all_ok = 1;
+
+    // the scalar version is the last entry
+    for (ref = fec_simd_impls; ref[1].name; ++ref)
+        ;
+
+    for (impl = fec_simd_impls; impl->name; ++impl) {
+        uint8_t input[UPLINK_BLOCK_BYTES];
+        int i, len, ok = 1;
+
+        fprintf(stderr, "syndromes (%s): ", impl->name);
+        if (!impl->supported()) {
+            fprintf(stderr, "SKIP (not supported by this CPU)\n");
+            continue;
+        }
+
+        // DO-282B downlink vectors, as both long and basic frames
+        for (i = 0; downlink_tests[i].testname; ++i) {
+            hex_to_bytes(downlink_tests[i].input, input);
+            if (!check_syndromes(impl, ref, &rs_adsb_long_table, input, LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES) ||
+                !check_syndromes(impl, ref, &rs_adsb_short_table, input, SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES)) {
+                fprintf(stderr, "FAIL: mismatch on %s\n", downlink_tests[i].testname);
+                ok = 0;
+                break;
+            }
+        }
+
+        // joint Basic/Long syndromes
+        for (i = 0; ok && downlink_tests[i].testname; ++i) {
+            uint8_t s_short[RS_SYNDROME_ROOTS], s_long[RS_SYNDROME_ROOTS];
+            uint8_t ref_short[RS_SYNDROME_ROOTS], ref_long[RS_SYNDROME_ROOTS];
+            int nonzero, ref_nonzero;
+
+            hex_to_bytes(downlink_tests[i].input, input);
+            nonzero = impl->syndromes_adsb(input, s_short, s_long);
+            ref_nonzero = (ref->syndromes(input, SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES, ref_short) ? RS_SHORT_SYNDROMES_NONZERO : 0);
+            ref_nonzero |= (ref->syndromes(input, LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES, ref_long) ? RS_LONG_SYNDROMES_NONZERO : 0);
+            if (nonzero != ref_nonzero ||
+                memcmp(s_short, ref_short, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES) != 0 ||
+                memcmp(s_long, ref_long, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES) != 0) {
+                fprintf(stderr, "FAIL: joint syndrome mismatch on %s\n", downlink_tests[i].testname);
+                ok = 0;
+            }
+        }
+
+        // valid uplink blocks with 0..12 random errors
+        for (i = 0; ok && i < 1000; ++i) {
+            int j;
+
+            for (j = 0; j < UPLINK_BLOCK_DATA_BYTES; ++j)
+                input[j] = random_byte();
+            encode_rs_char((void *) &rs_uplink_table, input, input + UPLINK_BLOCK_DATA_BYTES);
+            for (j = i % 13; j > 0; --j)
+                input[random_byte() % UPLINK_BLOCK_BYTES] ^= random_byte();
+
+            if (!check_syndromes(impl, ref, &rs_uplink_table, input, UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES)) {
+                fprintf(stderr, "FAIL: mismatch on uplink block %d\n", i);
+                ok = 0;
+            }
+        }
+
+        // every length, all roots, random data
+        for (len = 1; ok && len <= 255; ++len) {
+            uint8_t data[255];
+
+            for (i = 0; i < len; ++i)
+                data[i] = random_byte();
+            if (!check_syndromes(impl, ref, NULL, data, len, RS_SYNDROME_ROOTS)) {
+                fprintf(stderr, "FAIL: mismatch at length %d\n", len);
+                ok = 0;
+            }
+        }
+
+        if (ok)
+            fprintf(stderr, "PASS\n");
+        else
+            all_ok = 0;
+    }
+
+    return all_ok;
+}
+
+// Check the specialized decoders against the generic decoder on
+// codewords with 0..t+3 random errors
+static int test_decoders(void)
+{
+    static const struct {
+        const char *name;
+        const struct rs *rs;
+        int len;
+        int nroots;
+        int (*decode)(uint8_t *data, const uint8_t *syndromes, int *eras_pos, int no_eras);
+    } codes[] = {
+        { "adsb-short", &rs_adsb_short_table, SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES, decode_rs_adsb_short },
+        { "adsb-long", &rs_adsb_long_table, LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES, decode_rs_adsb_long },
+        { "uplink", &rs_uplink_table, UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES, decode_rs_uplink },
+        { NULL, NULL, 0, 0, NULL }
+    };
+    const struct fec_simd_impl *impl = fec_simd_select();
+    int c, all_ok = 1;
+
+    for (c = 0; codes[c].name; ++c) {
+        int i, ok = 1;
+
+        fprintf(stderr, "specialized decoder (%s): ", codes[c].name);
+        for (i = 0; ok && i < 2000; ++i) {
+            uint8_t data[UPLINK_BLOCK_BYTES], copy[UPLINK_BLOCK_BYTES];
+            uint8_t s[RS_SYNDROME_ROOTS];
+            int j, n, n_ref;
+
+            for (j = 0; j < codes[c].len - codes[c].nroots; ++j)
+                data[j] = random_byte();
+            encode_rs_char((void *) codes[c].rs, data, data + codes[c].len - codes[c].nroots);
+            for (j = i % (codes[c].nroots / 2 + 4); j > 0; --j)
+                data[random_byte() % codes[c].len] ^= random_byte();
+
+            memcpy(copy, data, codes[c].len);
+            impl->syndromes(data, codes[c].len, codes[c].nroots, s);
+            n = codes[c].decode(data, s, NULL, 0);
+            n_ref = decode_rs_char((void *) codes[c].rs, copy, NULL, 0);
+            if (n != n_ref || memcmp(data, copy, codes[c].len) != 0) {
+                fprintf(stderr, "FAIL: mismatch on codeword %d (%d vs %d corrected)\n", i, n, n_ref);
+                ok = 0;
+            }
+        }
+
+        if (ok)
+            fprintf(stderr, "PASS\n");
+        else
+            all_ok = 0;
+    }
+
+    return all_ok;
+}
+
+// Check the specialized encoders against encode_rs_char()
+static int test_encoders(void)
+{
+    static const struct {
+        const char *name;
+        const struct rs *rs;
+        int len;
+        int nroots;
+        void (*encode)(uint8_t *data);
+    } codes[] = {
+        { "adsb-short", &rs_adsb_short_table, SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES, encode_rs_adsb_short },
+        { "adsb-long", &rs_adsb_long_table, LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES, encode_rs_adsb_long },
+        { "uplink", &rs_uplink_table, UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES, encode_rs_uplink },
+        { NULL, NULL, 0, 0, NULL }
+    };
+    int c, all_ok = 1;
+
+    for (c = 0; codes[c].name; ++c) {
+        int i, ok = 1;
+
+        fprintf(stderr, "specialized encoder (%s): ", codes[c].name);
+        for (i = 0; ok && i < 2000; ++i) {
+            uint8_t data[UPLINK_BLOCK_BYTES], ref[UPLINK_BLOCK_BYTES];
+            int j;
+
+            // all-zero and all-ones data, then random data; the parity
+            // bytes start out as garbage
+            for (j = 0; j < codes[c].len; ++j)
+                data[j] = (i == 0 ? 0 : i == 1 ? 0xFF : random_byte());
+            for (j = codes[c].len - codes[c].nroots; j < codes[c].len; ++j)
+                data[j] = random_byte();
+            memcpy(ref, data, codes[c].len);
+
+            codes[c].encode(data);
+            encode_rs_char((void *) codes[c].rs, ref, ref + codes[c].len - codes[c].nroots);
+            if (memcmp(data, ref, codes[c].len) != 0) {
+                fprintf(stderr, "FAIL: mismatch on codeword %d\n", i);
+                ok = 0;
+            }
+        }
+
+        if (ok)
+            fprintf(stderr, "PASS\n");
+        else
+            all_ok = 0;
+    }
+
+    return all_ok;
+}
+
+// Check the correction statistics on a few frames with known errors
+static int test_stats(void)
+{
+    struct fec_stats before, after;
+    uint8_t frame[LONG_FRAME_BYTES], data[UPLINK_FRAME_DATA_BYTES];
+    uint8_t interleaved[UPLINK_FRAME_BYTES], out[UPLINK_FRAME_BYTES];
+    const struct fec_code_stats *l, *u;
+    char json[16384], expect[128];
+    FILE *f;
+    int i, rs_errors, ok = 1;
+
+    fprintf(stderr, "correction statistics: ");
+
+    before = *fec_thread_stats();
+
+    // a Long frame with two errors
+    for (i = 0; i < LONG_FRAME_BYTES; ++i)
+        frame[i] = random_byte();
+    frame[0] |= 0x08;
+    encode_adsb_frame(frame);
+    frame[5] ^= 0x11;
+    frame[40] ^= 0x22;
+    correct_adsb_frame(frame, &rs_errors);
+
+    // an uplink frame with one error in block 0 and too many in block 3
+    for (i = 0; i < UPLINK_FRAME_DATA_BYTES; ++i)
+        data[i] = random_byte();
+    encode_uplink_frame(data, interleaved);
+    interleaved[7 * UPLINK_FRAME_BLOCKS + 0] ^= 0x33;
+    for (i = 0; i < 15; ++i)
+        interleaved[(i * 6) * UPLINK_FRAME_BLOCKS + 3] ^= 0x44;
+    correct_uplink_frame(interleaved, out, &rs_errors);
+
+    after = *fec_thread_stats();
+    l = &after.code[FEC_STATS_ADSB_LONG];
+    u = &after.code[FEC_STATS_UPLINK];
+#define DELTA(field) (after.field - before.field)
+    if (DELTA(code[FEC_STATS_ADSB_LONG].codewords) != 1 || DELTA(code[FEC_STATS_ADSB_LONG].failed) != 0 ||
+        DELTA(code[FEC_STATS_ADSB_LONG].corrected[2]) != 1 ||
+        DELTA(code[FEC_STATS_ADSB_LONG].positions[5]) != 1 || DELTA(code[FEC_STATS_ADSB_LONG].positions[40]) != 1 ||
+        DELTA(code[FEC_STATS_ADSB_SHORT].codewords) != 0) {
+        fprintf(stderr, "FAIL: wrong downlink counts\n");
+        ok = 0;
+    } else if (DELTA(uplink_frames) != 1 || DELTA(uplink_failed_block[3]) != 1 ||
+               DELTA(code[FEC_STATS_UPLINK].codewords) != 4 || DELTA(code[FEC_STATS_UPLINK].failed) != 1 ||
+               DELTA(code[FEC_STATS_UPLINK].corrected[0]) != 2 || DELTA(code[FEC_STATS_UPLINK].corrected[1]) != 1 ||
+               DELTA(code[FEC_STATS_UPLINK].positions[7]) != 1) {
+        fprintf(stderr, "FAIL: wrong uplink counts\n");
+        ok = 0;
+    }
+#undef DELTA
+
+    // merging into an empty total gives the same counters back
+    if (ok) {
+        struct fec_stats total;
+
+        memset(&total, 0, sizeof(total));
+        fec_stats_merge(&total, &after);
+        if (memcmp(&total, &after, sizeof(total)) != 0) {
+            fprintf(stderr, "FAIL: merge mismatch\n");
+            ok = 0;
+        }
+    }
+
+    if (ok && (f = tmpfile()) != NULL) {
+        size_t n;
+
+        fec_stats_write_json(f, &after);
+        rewind(f);
+        n = fread(json, 1, sizeof(json) - 1, f);
+        json[n] = 0;
+        fclose(f);
+
+        snprintf(expect, sizeof(expect), "\"adsb_long\":{\"codewords\":%llu,", (unsigned long long) l->codewords);
+        if (json[0] != '{' || json[n - 1] != '}' || !strstr(json, expect) || strchr(json, '\n')) {
+            fprintf(stderr, "FAIL: bad JSON: %s\n", json);
+            ok = 0;
+        }
+        snprintf(expect, sizeof(expect), "\"uplink\":{\"codewords\":%llu,\"failed\":%llu,",
+                 (unsigned long long) u->codewords, (unsigned long long) u->failed);
+        if (ok && !strstr(json, expect)) {
+            fprintf(stderr, "FAIL: bad JSON: %s\n", json);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+        fprintf(stderr, "PASS\n");
+    return ok;
+}
+
+// Check decode_rs_few(): every single error, random double errors, and
+// no answer for 3..t errors
+static int test_few(void)
+{
+    static const struct {
+        const char *name;
+        const struct rs *rs;
+        int len;
+        int nroots;
+    } codes[] = {
+        { "adsb-short", &rs_adsb_short_table, SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES },
+        { "adsb-long", &rs_adsb_long_table, LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES },
+        { "uplink", &rs_uplink_table, UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES },
+        { NULL, NULL, 0, 0 }
+    };
+    const struct fec_simd_impl *impl = fec_simd_select();
+    int c, all_ok = 1;
+
+    for (c = 0; codes[c].name; ++c) {
+        uint8_t valid[UPLINK_BLOCK_BYTES], data[UPLINK_BLOCK_BYTES], s[RS_SYNDROME_ROOTS];
+        int i, j, pos, n, ok = 1;
+
+        fprintf(stderr, "closed-form decoder (%s): ", codes[c].name);
+
+        for (j = 0; j < codes[c].len - codes[c].nroots; ++j)
+            valid[j] = random_byte();
+        encode_rs_char((void *) codes[c].rs, valid, valid + codes[c].len - codes[c].nroots);
+
+        for (pos = 0; ok && pos < codes[c].len; ++pos) {
+            for (i = 1; ok && i < 256; ++i) {
+                memcpy(data, valid, codes[c].len);
+                data[pos] ^= i;
+                impl->syndromes(data, codes[c].len, codes[c].nroots, s);
+                n = decode_rs_few(codes[c].nroots, codes[c].len, data, s);
+                if (n != 1 || memcmp(data, valid, codes[c].len) != 0) {
+                    fprintf(stderr, "FAIL: error %02x at %d gave %d\n", i, pos, n);
+                    ok = 0;
+                }
+            }
+        }
+
+        for (i = 0; ok && i < 20000; ++i) {
+            int errors = 2 + i % (codes[c].nroots / 2 - 1);
+            uint8_t hit[UPLINK_BLOCK_BYTES];
+
+            memcpy(data, valid, codes[c].len);
+            memset(hit, 0, sizeof(hit));
+            for (j = 0; j < errors; ) {
+                pos = random_byte() % codes[c].len;
+                if (hit[pos])
+                    continue;
+                hit[pos] = 1;
+                data[pos] ^= 1 + random_byte() % 255;
+                ++j;
+            }
+
+            impl->syndromes(data, codes[c].len, codes[c].nroots, s);
+            n = decode_rs_few(codes[c].nroots, codes[c].len, data, s);
+            if (errors == 2 ? (n != 2 || memcmp(data, valid, codes[c].len) != 0) : (n != 0 || !memcmp(data, valid, codes[c].len))) {
+                fprintf(stderr, "FAIL: %d errors gave %d\n", errors, n);
+                ok = 0;
+            }
+        }
+
+        if (ok)
+            fprintf(stderr, "PASS\n");
+        else
+            all_ok = 0;
+    }
+
+    return all_ok;
+}
+
+// Corrupt 'errors' distinct bytes among the first 'len' of 'data' (with
+// stride 'stride'), marking them as unreliable in 'confidence'
+static void add_unreliable_errors(uint8_t *data, uint16_t *confidence, int len, int stride, int errors)
+{
+    int j;
+
+    for (j = 0; j < errors; ) {
+        int pos = (random_byte() % len) * stride;
+        if (confidence[pos] < 1000)
+            continue;
+        confidence[pos] = random_byte();
+        data[pos] ^= 1 + random_byte() % 255;
+        ++j;
+    }
+}
+
+// Check the erasure-decoding variants: more errors than the plain decode
+// can handle must be corrected when they are in the least reliable bytes,
+// frames the plain decode handles must get the same result, and noise
+// must not be "corrected".
+static int test_erasures(void)
+{
+    uint8_t valid[UPLINK_FRAME_BYTES], data[UPLINK_FRAME_BYTES];
+    uint8_t plain[UPLINK_FRAME_BYTES], out[UPLINK_FRAME_BYTES], expected[UPLINK_FRAME_DATA_BYTES];
+    uint16_t confidence[UPLINK_FRAME_BYTES];
+    int i, j, ok = 1, garbage_plain = 0, garbage_accepted = 0;
+
+    fprintf(stderr, "erasure decoding (downlink): ");
+    for (i = 0; ok && i < 3000; ++i) {
+        int basic = (i % 2 == 0);
+        int len = basic ? SHORT_FRAME_BYTES : LONG_FRAME_BYTES;
+        int nroots = len - (basic ? SHORT_FRAME_DATA_BYTES : LONG_FRAME_DATA_BYTES);
+        int errors = 1 + i % (nroots / 2 + nroots / 4);
+        int frametype, plain_frametype, rs_errors, plain_rs_errors, erasures;
+
+        for (j = 0; j < LONG_FRAME_BYTES; ++j) {
+            valid[j] = random_byte();
+            confidence[j] = 1000 + random_byte();
+        }
+        if (basic)
+            valid[0] &= 0x07;
+        else
+            valid[0] |= 0x08;
+        encode_adsb_frame(valid);
+
+        memcpy(data, valid, LONG_FRAME_BYTES);
+        add_unreliable_errors(data, confidence, len, 1, errors);
+
+        memcpy(plain, data, LONG_FRAME_BYTES);
+        plain_frametype = correct_adsb_frame(plain, &plain_rs_errors);
+        frametype = correct_adsb_frame_eras(data, confidence, &rs_errors, &erasures);
+
+        // (beyond its limit, the plain decode occasionally miscorrects;
+        // then the result should be the same, right or wrong)
+        if (plain_frametype > 0) {
+            if (plain_frametype != frametype || plain_rs_errors != rs_errors || erasures != 0 ||
+                memcmp(plain, data, LONG_FRAME_BYTES) != 0) {
+                fprintf(stderr, "FAIL: %d errors: plainly correctable frame gave a different result\n", errors);
+                ok = 0;
+            }
+        } else if (frametype != (basic ? 1 : 2) || memcmp(data, valid, len - nroots) != 0) {
+            fprintf(stderr, "FAIL: %d errors in a %s frame gave frametype %d\n", errors, basic ? "Basic" : "Long", frametype);
+            ok = 0;
+        } else if (erasures != nroots / 2) {
+            fprintf(stderr, "FAIL: %d errors: expected %d erasures, got %d\n", errors, nroots / 2, erasures);
+            ok = 0;
+        }
+    }
+
+    // The plain decode already "corrects" a few random frames, as errors
+    // located in the padding are ignored; the retries shouldn't add more
+    // than that again.
+    for (i = 0; ok && i < 10000; ++i) {
+        int rs_errors, erasures;
+
+        for (j = 0; j < LONG_FRAME_BYTES; ++j) {
+            data[j] = random_byte();
+            confidence[j] = random_byte();
+        }
+        memcpy(plain, data, LONG_FRAME_BYTES);
+        if (correct_adsb_frame(plain, &rs_errors) > 0)
+            ++garbage_plain;
+        else if (correct_adsb_frame_eras(data, confidence, &rs_errors, &erasures) > 0)
+            ++garbage_accepted;
+    }
+
+    if (ok && garbage_accepted > garbage_plain) {
+        fprintf(stderr, "FAIL: %d of 10000 random frames were corrected with erasures (%d without)\n",
+                garbage_accepted, garbage_plain);
+        ok = 0;
+    }
+
+    if (!ok)
+        return 0;
+    fprintf(stderr, "PASS\n");
+
+    fprintf(stderr, "erasure decoding (uplink): ");
+    for (i = 0; ok && i < 1000; ++i) {
+        int block = i % UPLINK_FRAME_BLOCKS;
+        int errors = 1 + i % 15;
+        int result, plain_result, rs_errors, plain_rs_errors, erasures;
+
+        for (j = 0; j < UPLINK_FRAME_DATA_BYTES; ++j)
+            expected[j] = random_byte();
+        for (j = 0; j < UPLINK_FRAME_BYTES; ++j)
+            confidence[j] = 1000 + random_byte();
+        encode_uplink_frame(expected, valid);
+
+        memcpy(data, valid, UPLINK_FRAME_BYTES);
+        add_unreliable_errors(data + block, confidence + block, UPLINK_BLOCK_BYTES, UPLINK_FRAME_BLOCKS, errors);
+        // and a few correctable errors in another block
+        data[((block + 1) % UPLINK_FRAME_BLOCKS) + UPLINK_FRAME_BLOCKS * (random_byte() % UPLINK_BLOCK_BYTES)] ^= 0x55;
+
+        plain_result = correct_uplink_frame(data, plain, &plain_rs_errors);
+        result = correct_uplink_frame_eras(data, confidence, out, &rs_errors, &erasures);
+
+        if (plain_result > 0) {
+            if (result != 1 || plain_rs_errors != rs_errors || erasures != 0 ||
+                memcmp(plain, out, UPLINK_FRAME_DATA_BYTES) != 0) {
+                fprintf(stderr, "FAIL: %d errors: plainly correctable frame gave a different result\n", errors);
+                ok = 0;
+            }
+        } else if (result != 1 || memcmp(out, expected, UPLINK_FRAME_DATA_BYTES) != 0) {
+            fprintf(stderr, "FAIL: %d errors in block %d gave %d\n", errors, block, result);
+            ok = 0;
+        } else if (erasures != (UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES) / 2) {
+            fprintf(stderr, "FAIL: %d errors: expected %d erasures, got %d\n", errors,
+                    (UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES) / 2, erasures);
+            ok = 0;
+        }
+    }
+
+    garbage_accepted = 0;
+    for (i = 0; ok && i < 1000; ++i) {
+        int rs_errors, erasures;
+
+        for (j = 0; j < UPLINK_FRAME_BYTES; ++j) {
+            data[j] = random_byte();
+            confidence[j] = random_byte();
+        }
+        if (correct_uplink_frame_eras(data, confidence, out, &rs_errors, &erasures) > 0)
+            ++garbage_accepted;
+    }
+
+    if (ok && garbage_accepted > 0) {
+        fprintf(stderr, "FAIL: %d of 1000 random frames were corrected\n", garbage_accepted);
+        ok = 0;
+    }
+
+    if (ok)
+        fprintf(stderr, "PASS\n");
+    return ok;
+}
+
+// fill 'frame' with a random Basic or Long frame with some errors, or
+// with random garbage
+static void random_adsb_candidate(uint8_t *frame, int i)
+{
+    int j, errors;
+
+    for (j = 0; j < LONG_FRAME_BYTES; ++j)
+        frame[j] = random_byte();
+
+    switch (i % 3) {
+    case 0:
+        // Basic; the RS parity overwrites some of the random data
+        frame[0] &= 0x07;
+        encode_adsb_frame(frame);
+        errors = random_byte() % 9;
+        break;
+    case 1:
+        // Long
+        frame[0] |= 0x08;
+        encode_adsb_frame(frame);
+        errors = random_byte() % 10;
+        break;
+    default:
+        // garbage
+        errors = 0;
+        break;
+    }
+
+    for (j = 0; j < errors; ++j)
+        frame[random_byte() % LONG_FRAME_BYTES] ^= random_byte();
+}
+
+// Check the lane-parallel syndromes and decoder of each implementation
+// against the single-codeword versions
+static int test_lanes(void)
+{
+    const struct fec_simd_impl *impl;
+    const struct fec_simd_impl *ref = &fec_simd_impls[0];
+    int all_ok = 1;
+
+    while (ref[1].name)
+        ++ref;
+
+    for (impl = fec_simd_impls; impl->name; ++impl) {
+        uint8_t frames[RS_MAX_LANES][UPLINK_BLOCK_BYTES], copies[RS_MAX_LANES][UPLINK_BLOCK_BYTES];
+        uint8_t s[RS_MAX_LANES][RS_SYNDROME_ROOTS], split[RS_MAX_LANES][RS_SYNDROME_ROOTS];
+        uint8_t *data[RS_MAX_LANES];
+        const uint8_t *syndromes[RS_MAX_LANES];
+        int results[RS_MAX_LANES];
+        int i, k, ok = 1;
+
+        fprintf(stderr, "lanes (%s): ", impl->name);
+        if (!impl->supported()) {
+            fprintf(stderr, "SKIP (not supported by this CPU)\n");
+            continue;
+        }
+
+        for (k = 0; k < RS_MAX_LANES; ++k) {
+            data[k] = frames[k];
+            syndromes[k] = s[k];
+        }
+
+        // downlink frames: Long syndromes, with the Basic ones split off
+        for (i = 0; ok && i < 200; ++i) {
+            int n = 1 + i % impl->lanes;
+            uint32_t nonzero, split_nonzero;
+
+            for (k = 0; k < n; ++k)
+                random_adsb_candidate(frames[k], i + k);
+
+            impl->syndromes_lanes((const uint8_t *const *) data, n, LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES,
+                                  SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES,
+                                  s, &nonzero, split, &split_nonzero);
+            for (k = 0; ok && k < n; ++k) {
+                uint8_t ref_long[RS_SYNDROME_ROOTS], ref_short[RS_SYNDROME_ROOTS];
+                int long_nonzero = ref->syndromes(frames[k], LONG_FRAME_BYTES, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES, ref_long);
+                int short_nonzero = ref->syndromes(frames[k], SHORT_FRAME_BYTES, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES, ref_short);
+
+                if (!long_nonzero != !(nonzero & (1U << k)) || !short_nonzero != !(split_nonzero & (1U << k)) ||
+                    memcmp(s[k], ref_long, LONG_FRAME_BYTES - LONG_FRAME_DATA_BYTES) != 0 ||
+                    memcmp(split[k], ref_short, SHORT_FRAME_BYTES - SHORT_FRAME_DATA_BYTES) != 0) {
+                    fprintf(stderr, "FAIL: downlink syndrome mismatch in batch %d lane %d\n", i, k);
+                    ok = 0;
+                }
+            }
+            if (n < 32 && ((nonzero | split_nonzero) & (~0U << n))) {
+                fprintf(stderr, "FAIL: nonzero flags set for unused lanes in batch %d\n", i);
+                ok = 0;
+            }
+        }
+
+        // interleaved uplink frames: deinterleaving and per-block syndromes
+        for (i = 0; ok && i < 200; ++i) {
+            uint8_t frame[UPLINK_FRAME_BYTES], blocks[UPLINK_FRAME_BLOCKS][UPLINK_BLOCK_BYTES];
+            uint8_t frame_s[UPLINK_FRAME_BLOCKS][RS_SYNDROME_ROOTS];
+            int j, block, nonzero, ref_nonzero = 0;
+
+            for (j = 0; j < UPLINK_FRAME_DATA_BYTES; ++j)
+                frame[j] = random_byte();
+            encode_uplink_frame(frame, frame);
+            for (j = i % 20; j > 0; --j)
+                frame[random_byte() % UPLINK_FRAME_BYTES] ^= random_byte();
+
+            nonzero = impl->syndromes_uplink(frame, frame_s);
+            impl->deinterleave_uplink(frame, blocks);
+            for (block = 0; ok && block < UPLINK_FRAME_BLOCKS; ++block) {
+                uint8_t ref_s[RS_SYNDROME_ROOTS];
+
+                for (j = 0; j < UPLINK_BLOCK_BYTES; ++j) {
+                    if (blocks[block][j] != frame[j * UPLINK_FRAME_BLOCKS + block])
+                        break;
+                }
+                if (j < UPLINK_BLOCK_BYTES) {
+                    fprintf(stderr, "FAIL: deinterleave mismatch in frame %d block %d byte %d\n", i, block, j);
+                    ok = 0;
+                }
+
+                if (ref->syndromes(blocks[block], UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES, ref_s))
+                    ref_nonzero |= 1 << block;
+                if (memcmp(frame_s[block], ref_s, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES) != 0) {
+                    fprintf(stderr, "FAIL: uplink syndrome mismatch in frame %d block %d\n", i, block);
+                    ok = 0;
+                }
+            }
+            if (ok && nonzero != ref_nonzero) {
+                fprintf(stderr, "FAIL: uplink nonzero flags %02x, expected %02x in frame %d\n", nonzero, ref_nonzero, i);
+                ok = 0;
+            }
+        }
+
+        // uplink blocks with 0..13 errors, decoded together
+        for (i = 0; ok && i < 200; ++i) {
+            int n = 1 + i % impl->lanes;
+            uint32_t nonzero;
+
+            for (k = 0; k < n; ++k) {
+                int j;
+
+                for (j = 0; j < UPLINK_BLOCK_DATA_BYTES; ++j)
+                    frames[k][j] = random_byte();
+                encode_rs_char((void *) &rs_uplink_table, frames[k], frames[k] + UPLINK_BLOCK_DATA_BYTES);
+                for (j = (i + k) % 14; j > 0; --j)
+                    frames[k][random_byte() % UPLINK_BLOCK_BYTES] ^= random_byte();
+                memcpy(copies[k], frames[k], UPLINK_BLOCK_BYTES);
+            }
+
+            impl->syndromes_lanes((const uint8_t *const *) data, n, UPLINK_BLOCK_BYTES, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES,
+                                  0, 0, s, &nonzero, NULL, NULL);
+            decode_rs_lanes(impl, UPLINK_BLOCK_BYTES - UPLINK_BLOCK_DATA_BYTES, UPLINK_BLOCK_BYTES, data, syndromes, n, results);
+            for (k = 0; ok && k < n; ++k) {
+                int n_ref = decode_rs_char((void *) &rs_uplink_table, copies[k], NULL, 0);
+                if (results[k] != n_ref || memcmp(frames[k], copies[k], UPLINK_BLOCK_BYTES) != 0) {
+                    fprintf(stderr, "FAIL: decoder mismatch in batch %d lane %d (%d vs %d corrected)\n", i, k, results[k], n_ref);
+                    ok = 0;
+                }
+            }
+        }
+
+        if (ok)
+            fprintf(stderr, "PASS\n");
+        else
+            all_ok = 0;
+    }
+
+    return all_ok;
+}
+
+// Check the batch APIs against correcting one codeword at a time,
+// with batches of assorted sizes
+static int test_batch(void)
+{
+    static uint8_t frames[1000][UPLINK_BLOCK_BYTES], copies[1000][UPLINK_BLOCK_BYTES];
+    static uint8_t *data[1000];
+    static int frametypes[1000], rs_errors[1000];
+    static const int batch_sizes[] = { 1, 2, 7, 16, 31, 32, 33, 100, 1000, 0 };
+    int b, i, ok = 1;
+
+    fprintf(stderr, "downlink batch: ");
+    for (b = 0; ok && batch_sizes[b]; ++b) {
+        int n = batch_sizes[b];
+
+        for (i = 0; i < n; ++i) {
+            random_adsb_candidate(frames[i], i + b);
+            memcpy(copies[i], frames[i], LONG_FRAME_BYTES);
+            data[i] = frames[i];
+        }
+
+        correct_adsb_frames_batch(data, n, frametypes, rs_errors);
+        for (i = 0; ok && i < n; ++i) {
+            int ref_rs_errors;
+            int ref_frametype = correct_adsb_frame(copies[i], &ref_rs_errors);
+
+            if (frametypes[i] != ref_frametype || rs_errors[i] != ref_rs_errors ||
+                memcmp(frames[i], copies[i], LONG_FRAME_BYTES) != 0) {
+                fprintf(stderr, "FAIL: mismatch on frame %d of %d (frametype %d vs %d, errors %d vs %d)\n",
+                        i, n, frametypes[i], ref_frametype, rs_errors[i], ref_rs_errors);
+                ok = 0;
+            }
+        }
+    }
+    if (ok)
+        fprintf(stderr, "PASS\n");
+
+    fprintf(stderr, "uplink batch: ");
+    for (b = 0; ok && batch_sizes[b]; ++b) {
+        int n = batch_sizes[b];
+
+        for (i = 0; i < n; ++i) {
+            int j;
+
+            for (j = 0; j < UPLINK_BLOCK_DATA_BYTES; ++j)
+                frames[i][j] = random_byte();
+            encode_rs_char((void *) &rs_uplink_table, frames[i], frames[i] + UPLINK_BLOCK_DATA_BYTES);
+            for (j = (i + b) % 14; j > 0; --j)
+                frames[i][random_byte() % UPLINK_BLOCK_BYTES] ^= random_byte();
+            memcpy(copies[i], frames[i], UPLINK_BLOCK_BYTES);
+            data[i] = frames[i];
+        }
+
+        correct_uplink_blocks_batch(data, n, rs_errors);
+        for (i = 0; ok && i < n; ++i) {
+            int ref_rs_errors = decode_rs_char((void *) &rs_uplink_table, copies[i], NULL, 0);
+
+            if (ref_rs_errors < 0 || ref_rs_errors > 10)
+                ref_rs_errors = 9999;
+            if (rs_errors[i] != ref_rs_errors || memcmp(frames[i], copies[i], UPLINK_BLOCK_BYTES) != 0) {
+                fprintf(stderr, "FAIL: mismatch on block %d of %d (errors %d vs %d)\n",
+                        i, n, rs_errors[i], ref_rs_errors);
+                ok = 0;
+            }
+        }
+    }
+    if (ok)
+        fprintf(stderr, "PASS\n");
+
+    return ok;
+}
+
+// correct_uplink_frame() as it was before the blocks were decoded
+// together: deinterleave and decode one block at a time, stopping at the
+// first uncorrectable block
+static int reference_correct_uplink_frame(const uint8_t *from, uint8_t *to, int *rs_errors)
+{
+    int block, total_corrected = 0;
+
+    for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+        uint8_t *blockdata = &to[block * UPLINK_BLOCK_DATA_BYTES];
+        int i, n_corrected;
+
+        for (i = 0; i < UPLINK_BLOCK_BYTES; ++i)
+            blockdata[i] = from[i * UPLINK_FRAME_BLOCKS + block];
+
+        n_corrected = decode_rs_char((void *) &rs_uplink_table, blockdata, NULL, 0);
+        if (n_corrected < 0 || n_corrected > 10) {
+            *rs_errors = 9999;
+            return -1;
+        }
+        total_corrected += n_corrected;
+    }
+
+    *rs_errors = total_corrected;
+    return 1;
+}
+
+// Check correct_uplink_frame() on the uplink frames of a sample file
+// (e.g. scripts/samples.txt): each frame is re-encoded, then corrected
+// as-is and with random errors. Clean and correctable frames must give
+// back the original data, and all frames must get the same result as
+// the reference.
+static int test_uplink_corpus(const char *path)
+{
+    FILE *f;
+    char line[2048];
+    int frames = 0, corrected = 0, failed = 0;
+    int ok = 1;
+
+    fprintf(stderr, "uplink corpus: ");
+    if (!(f = fopen(path, "r"))) {
+        fprintf(stderr, "FAIL: can't open %s\n", path);
+        return 0;
+    }
+
+    while (ok && fgets(line, sizeof(line), f)) {
+        uint8_t golden[UPLINK_FRAME_DATA_BYTES], interleaved[UPLINK_FRAME_BYTES];
+        char *end;
+        int variant;
+
+        if (line[0] != '+' || !(end = strchr(line, ';')) || end - line != 1 + 2 * UPLINK_FRAME_DATA_BYTES)
+            continue;
+
+        *end = 0;
+        hex_to_bytes(line + 1, golden);
+        encode_uplink_frame(golden, interleaved);
+        ++frames;
+
+        // no errors, then 1..14 errors in each block, which is beyond
+        // what can be corrected towards the end
+        for (variant = 0; ok && variant < 15; ++variant) {
+            uint8_t from[UPLINK_FRAME_BYTES], to[UPLINK_FRAME_BYTES], ref_to[UPLINK_FRAME_BYTES];
+            int block, j, result, ref_result, rs_errors, ref_rs_errors;
+
+            memcpy(from, interleaved, UPLINK_FRAME_BYTES);
+            for (block = 0; block < UPLINK_FRAME_BLOCKS; ++block) {
+                for (j = 0; j < variant; ++j)
+                    from[(random_byte() % UPLINK_BLOCK_BYTES) * UPLINK_FRAME_BLOCKS + block] ^= random_byte();
+            }
+
+            result = correct_uplink_frame(from, to, &rs_errors);
+            ref_result = reference_correct_uplink_frame(from, ref_to, &ref_rs_errors);
+            if (result != ref_result || rs_errors != ref_rs_errors) {
+                fprintf(stderr, "FAIL: frame %d with %d errors per block: result %d vs %d, errors %d vs %d\n",
+                        frames, variant, result, ref_result, rs_errors, ref_rs_errors);
+                ok = 0;
+            } else if (result == 1 && memcmp(to, golden, UPLINK_FRAME_DATA_BYTES) != 0) {
+                fprintf(stderr, "FAIL: frame %d with %d errors per block: wrong corrected output\n", frames, variant);
+                ok = 0;
+            } else if (result == 1) {
+                ++corrected;
+            } else {
+                ++failed;
+            }
+        }
+    }
+
+    fclose(f);
+    if (ok && frames == 0) {
+        fprintf(stderr, "FAIL: no uplink frames in %s\n", path);
+        ok = 0;
+    }
+    if (ok)
+        fprintf(stderr, "PASS (%d frames, %d corrected, %d uncorrectable)\n", frames, corrected, failed);
+    return ok;
+}
+
+// correct_adsb_frame() as it was before the joint Basic/Long path:
+// a full Long decode, then a full Basic decode
+static int reference_correct_adsb_frame(uint8_t *to, int *rs_errors)
+{
+    int n_corrected = decode_rs_char((void *) &rs_adsb_long_table, to, NULL, 0);
+    if (n_corrected >= 0 && n_corrected <= 7 && (to[0]>>3) != 0) {
+        *rs_errors = n_corrected;
+        return 2;
+    }
+
+    n_corrected = decode_rs_char((void *) &rs_adsb_short_table, to, NULL, 0);
+    if (n_corrected >= 0 && n_corrected <= 6 && (to[0]>>3) == 0) {
+        *rs_errors = n_corrected;
+        return 1;
+    }
+
+    *rs_errors = 9999;
+    return -1;
+}
+
+// Check correct_adsb_frame() against the reference on random Basic and
+// Long frames with 0..t+2 errors, and on random garbage.
+//
+// The only allowed difference is when the MDB type says Basic: then the
+// new code tries the Basic decode first, while the reference might have
+// accepted a (mis)correction by the Long decoder, which often "succeeds"
+// on Basic frames by locating errors in the padding of the shortened code.
+static int test_adsb_classification(void)
+{
+    int i, ok = 1;
+    int hinted = 0;
+
+    fprintf(stderr, "downlink classification: ");
+    for (i = 0; ok && i < 30000; ++i) {
+        uint8_t frame[LONG_FRAME_BYTES], copy[LONG_FRAME_BYTES], raw[LONG_FRAME_BYTES];
+        int frametype, ref_frametype, rs_errors, ref_rs_errors;
+
+        random_adsb_candidate(frame, i);
+
+        memcpy(raw, frame, LONG_FRAME_BYTES);
+        memcpy(copy, frame, LONG_FRAME_BYTES);
+        frametype = correct_adsb_frame(frame, &rs_errors);
+        ref_frametype = reference_correct_adsb_frame(copy, &ref_rs_errors);
+        if (frametype == ref_frametype && rs_errors == ref_rs_errors &&
+            (frametype < 0 || memcmp(frame, copy, frametype == 2 ? LONG_FRAME_DATA_BYTES : SHORT_FRAME_DATA_BYTES) == 0))
+            continue;
+
+        // must be the Basic decode of the unmodified frame
+        if ((raw[0]>>3) == 0 && frametype == 1) {
+            int n = decode_rs_char((void *) &rs_adsb_short_table, raw, NULL, 0);
+            if (n == rs_errors && memcmp(frame, raw, SHORT_FRAME_DATA_BYTES) == 0) {
+                ++hinted;
+                continue;
+            }
+        }
+
+        fprintf(stderr, "FAIL: mismatch on frame %d (frametype %d vs %d, errors %d vs %d)\n",
+                i, frametype, ref_frametype, rs_errors, ref_rs_errors);
+        ok = 0;
+    }
+
+    if (ok)
+        fprintf(stderr, "PASS (%d Basic frames not miscorrected as Long)\n", hinted);
+    return ok;
+}
+
 int main(int argc, char **argv)
 {
     int i;
@@ -212,6 +1158,27 @@ int main(int argc, char **argv)
         else
             all_ok = 0;
     }
+
+    if (!test_syndromes())
+        all_ok = 0;
+    if (!test_decoders())
+        all_ok = 0;
+    if (!test_adsb_classification())
+        all_ok = 0;
+    if (!test_lanes())
+        all_ok = 0;
+    if (!test_batch())
+        all_ok = 0;
+    if (!test_few())
+        all_ok = 0;
+    if (!test_erasures())
+        all_ok = 0;
+    if (!test_encoders())
+        all_ok = 0;
+    if (!test_stats())
+        all_ok = 0;
+    if (argc > 1 && !test_uplink_corpus(argv[1]))
+        all_ok = 0;
     
     return all_ok ? 0 : 1;
 }
@@ -0,0 +1,279 @@
+//
+// Copyright 2015, Oliver Jowett <oliver@mutability.co.uk>
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Build-time generator for the lookup tables declared in tables.h.
+// Writes C source to stdout.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "uat.h"
+#include "tables.h"
+#include "fec/char.h"
+#include "fec/rs-common.h"
+#include "fec/rs.h"
+
+#define UPLINK_POLY 0x187
+#define ADSB_POLY 0x187
+
+// write an array definition; 'decl' is everything before the " = {"
+static void write_array(const char *decl, const unsigned *values, int n)
+{
+    int i;
+
+    printf("%s = {", decl);
+    for (i = 0; i < n; ++i) {
+        if (i % 16 == 0)
+            printf("\n   ");
+        printf(" %u,", values[i]);
+    }
+    printf("\n};\n\n");
+}
+
+static void write_iqphase()
+{
+    static unsigned table[65536];
+    unsigned i, q;
+
+    // independent of this machine's byte order, see tables.h
+    for (i = 0; i < 256; ++i) {
+        for (q = 0; q < 256; ++q)
+            table[i | (q << 8)] = iq_to_phase(i, q);
+    }
+
+    write_array("const uint16_t iqphase[65536]", table, 65536);
+}
+
+static void write_rs(const char *name, struct rs *rs, struct rs *field)
+{
+    unsigned genpoly[256];
+    char genpoly_decl[128];
+    int i;
+
+    // all the UAT codes use the same field, so share its tables
+    if (memcmp(rs->alpha_to, field->alpha_to, rs->nn+1) || memcmp(rs->index_of, field->index_of, rs->nn+1)) {
+        fprintf(stderr, "gen_tables: %s uses a different Galois field\n", name);
+        exit(1);
+    }
+
+    for (i = 0; i <= rs->nroots; ++i)
+        genpoly[i] = rs->genpoly[i];
+    snprintf(genpoly_decl, sizeof(genpoly_decl), "static const data_t %s_genpoly[%d]", name, rs->nroots + 1);
+    write_array(genpoly_decl, genpoly, rs->nroots + 1);
+
+    printf("const struct rs %s_table = {\n"
+           "    .mm = %d,\n"
+           "    .nn = %d,\n"
+           "    .alpha_to = (data_t *) rs_alpha_to,\n"
+           "    .index_of = (data_t *) rs_index_of,\n"
+           "    .genpoly = (data_t *) %s_genpoly,\n"
+           "    .nroots = %d,\n"
+           "    .fcr = %d,\n"
+           "    .prim = %d,\n"
+           "    .iprim = %d,\n"
+           "    .pad = %d\n"
+           "};\n\n",
+           name, rs->mm, rs->nn, name,
+           rs->nroots, rs->fcr, rs->prim, rs->iprim, rs->pad);
+}
+
+// multiply two field elements in polynomial form
+static unsigned gf_mul(struct rs *rs, unsigned a, unsigned b)
+{
+    if (a == 0 || b == 0)
+        return 0;
+    return rs->alpha_to[modnn(rs, rs->index_of[a] + rs->index_of[b])];
+}
+
+// Split-nibble multiplication tables for the SIMD syndrome code
+// (see fec_simd.c): for each root r = alpha^(fcr+i), and each
+// multiplier c = r^32, r^16, ... r^1, sixteen products c*x followed
+// by sixteen products c*(x<<4), for x = 0..15
+static void write_syndrome_tables(struct rs *rs)
+{
+    int i, k, x;
+
+    printf("const uint8_t rs_syndrome_mul[RS_SYNDROME_ROOTS][RS_SYNDROME_STEPS][32] __attribute__((aligned(32))) = {\n");
+    for (i = 0; i < RS_SYNDROME_ROOTS; ++i) {
+        printf("    {\n");
+        for (k = 0; k < RS_SYNDROME_STEPS; ++k) {
+            int power = (RS_SYNDROME_FCR + i) << (RS_SYNDROME_STEPS - 1 - k);
+            unsigned c = rs->alpha_to[power % rs->nn];
+
+            printf("        {");
+            for (x = 0; x < 16; ++x)
+                printf(" %u,", gf_mul(rs, c, x));
+            for (x = 0; x < 16; ++x)
+                printf(" %u,", gf_mul(rs, c, x << 4));
+            printf(" },\n");
+        }
+        printf("    },\n");
+    }
+    printf("};\n\n");
+}
+
+// Split-nibble multiplication tables for the lane-parallel Chien search
+// (see fec_simd.c): for j = 1..RS_SYNDROME_ROOTS, products alpha^j * x
+// in the same layout as above
+static void write_chien_tables(struct rs *rs)
+{
+    int j, x;
+
+    printf("const uint8_t rs_chien_mul[RS_SYNDROME_ROOTS][32] __attribute__((aligned(32))) = {\n");
+    for (j = 1; j <= RS_SYNDROME_ROOTS; ++j) {
+        unsigned c = rs->alpha_to[j];
+
+        printf("    {");
+        for (x = 0; x < 16; ++x)
+            printf(" %u,", gf_mul(rs, c, x));
+        for (x = 0; x < 16; ++x)
+            printf(" %u,", gf_mul(rs, c, x << 4));
+        printf(" },\n");
+    }
+    printf("};\n\n");
+}
+
+// For each c, a root y of y^2 + y = c, or 0 if there is none. The other
+// root is y^1. Used to solve the two-error locator polynomial in closed
+// form (see fec_decoders.c)
+static void write_quadratic_roots(struct rs *rs)
+{
+    unsigned table[256];
+    unsigned y;
+
+    memset(table, 0, sizeof(table));
+    for (y = 2; y <= rs->nn; ++y) {
+        unsigned c = gf_mul(rs, y, y) ^ y;
+        if (!table[c])
+            table[c] = y;
+    }
+
+    write_array("const uint8_t rs_quadratic_root[256] __attribute__((aligned(64)))", table, rs->nn + 1);
+}
+
+// PSHUFB masks for deinterleaving uplink frames (see fec_simd.c).
+// 16 rows of an interleaved frame are six 16-byte vectors; mask [b][v]
+// picks out the bytes of block b that are in vector v, in order, and
+// zeroes the rest (0x80)
+static void write_deinterleave_tables()
+{
+    int b, v, k;
+
+    printf("const uint8_t uplink_deinterleave_shuffle[UPLINK_FRAME_BLOCKS][UPLINK_FRAME_BLOCKS][16] __attribute__((aligned(16))) = {\n");
+    for (b = 0; b < UPLINK_FRAME_BLOCKS; ++b) {
+        printf("    {\n");
+        for (v = 0; v < UPLINK_FRAME_BLOCKS; ++v) {
+            printf("        {");
+            for (k = 0; k < 16; ++k) {
+                int offset = k * UPLINK_FRAME_BLOCKS + b - v * 16;
+                printf(" %u,", (offset >= 0 && offset < 16) ? offset : 0x80);
+            }
+            printf(" },\n");
+        }
+        printf("    },\n");
+    }
+    printf("};\n\n");
+}
+
+// Parity update tables for the table-driven encoders (see
+// fec_decoders.c): for each feedback symbol f, the products
+// f * g[nroots-1-j] for j = 0..nroots-1, where g is the generator
+// polynomial, padded with zeros to RS_ENCODE_WIDTH bytes
+static void write_encoder_table(const char *name, struct rs *rs)
+{
+    unsigned f;
+    int j;
+
+    printf("const uint8_t %s[256][RS_ENCODE_WIDTH] __attribute__((aligned(64))) = {\n", name);
+    for (f = 0; f <= rs->nn; ++f) {
+        printf("    {");
+        for (j = 0; j < RS_ENCODE_WIDTH; ++j) {
+            unsigned g = (j < rs->nroots ? rs->alpha_to[rs->genpoly[rs->nroots - 1 - j]] : 0);
+            printf(" %u,", gf_mul(rs, f, g));
+        }
+        printf(" },\n");
+    }
+    printf("};\n\n");
+}
+
+static void write_fec()
+{
+    // these must match the parameters used by init_fec() in fec.c
+    struct rs *rs_adsb_short = init_rs_char(8, /* gfpoly */ ADSB_POLY, /* fcr */ 120, /* prim */ 1, /* nroots */ 12, /* pad */ 225);
+    struct rs *rs_adsb_long  = init_rs_char(8, /* gfpoly */ ADSB_POLY, /* fcr */ 120, /* prim */ 1, /* nroots */ 14, /* pad */ 207);
+    struct rs *rs_uplink     = init_rs_char(8, /* gfpoly */ UPLINK_POLY, /* fcr */ 120, /* prim */ 1, /* nroots */ 20, /* pad */ 163);
+    unsigned table[256];
+    int i;
+
+    if (!rs_adsb_short || !rs_adsb_long || !rs_uplink) {
+        fprintf(stderr, "gen_tables: init_rs_char failed\n");
+        exit(1);
+    }
+
+    for (i = 0; i <= rs_uplink->nn; ++i)
+        table[i] = rs_uplink->alpha_to[i];
+    write_array("const uint8_t rs_alpha_to[256] __attribute__((aligned(64)))", table, rs_uplink->nn + 1);
+    for (i = 0; i <= rs_uplink->nn; ++i)
+        table[i] = rs_uplink->index_of[i];
+    write_array("const uint8_t rs_index_of[256] __attribute__((aligned(64)))", table, rs_uplink->nn + 1);
+
+    write_rs("rs_adsb_short", rs_adsb_short, rs_uplink);
+    write_rs("rs_adsb_long", rs_adsb_long, rs_uplink);
+    write_rs("rs_uplink", rs_uplink, rs_uplink);
+
+    write_syndrome_tables(rs_uplink);
+    write_chien_tables(rs_uplink);
+    write_quadratic_roots(rs_uplink);
+    write_deinterleave_tables();
+
+    write_encoder_table("rs_encode_adsb_short", rs_adsb_short);
+    write_encoder_table("rs_encode_adsb_long", rs_adsb_long);
+    write_encoder_table("rs_encode_uplink", rs_uplink);
+}
+
+// Base 40 callsign characters for the message decoder (see uat_decode.c)
+static void write_decode_tables()
+{
+    static const char alphabet[40] = BASE40_ALPHABET;
+    int v;
+
+    printf("const char base40_pairs[1600][2] = {");
+    for (v = 0; v < 1600; ++v) {
+        if (v % 16 == 0)
+            printf("\n   ");
+        printf(" \"%c%c\",", alphabet[v / 40], alphabet[v % 40]);
+    }
+    printf("\n};\n\n");
+}
+
+int main(int argc, char **argv)
+{
+    printf("// Generated by gen_tables - do not edit\n\n"
+           "#include <stdint.h>\n\n"
+           "#include \"uat.h\"\n"
+           "#include \"tables.h\"\n"
+           "#include \"fec/char.h\"\n"
+           "#include \"fec/rs-common.h\"\n\n");
+
+    write_iqphase();
+    write_fec();
+    write_decode_tables();
+    return 0;
+}
@@ -0,0 +1,158 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "uat.h"
+#include "modulator.h"
+
+// UAT uses a modulation index of 0.6: +/-312.5kHz deviation
+// at 1.041667Mbit/s, so each bit advances or retards the
+// phase by 0.6*pi radians.
+#define PHASE_PER_BIT (0.6 * M_PI)
+
+// xorshift64*
+static uint64_t next_random(struct uat_modulator *mod)
+{
+    mod->rng ^= mod->rng >> 12;
+    mod->rng ^= mod->rng << 25;
+    mod->rng ^= mod->rng >> 27;
+    return mod->rng * 2685821657736338717ULL;
+}
+
+double modulator_random(struct uat_modulator *mod)
+{
+    return ((next_random(mod) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+// standard normal, via Box-Muller
+static double gaussian_random(struct uat_modulator *mod)
+{
+    double r, theta;
+
+    if (mod->have_spare) {
+        mod->have_spare = 0;
+        return mod->spare;
+    }
+
+    r = sqrt(-2.0 * log(modulator_random(mod)));
+    theta = 2.0 * M_PI * modulator_random(mod);
+    mod->spare = r * sin(theta);
+    mod->have_spare = 1;
+    return r * cos(theta);
+}
+
+void modulator_init(struct uat_modulator *mod,
+                    double snr_db, double freq_offset_hz, double timing_offset,
+                    uint64_t seed)
+{
+    memset(mod, 0, sizeof(*mod));
+
+    mod->amplitude = 96.0;
+    // signal power is A^2; noise power is 2*sigma^2 (I and Q)
+    mod->noise_sigma = mod->amplitude / sqrt(2.0 * pow(10.0, snr_db / 10.0));
+    mod->freq_offset = 2.0 * M_PI * freq_offset_hz / MODULATOR_SAMPLE_RATE;
+    mod->timing_offset = timing_offset;
+    mod->rng = seed ? seed : 1;
+}
+
+static uint8_t clamp_sample(double v)
+{
+    v = round(v);
+    return (v < 0 ? 0 : v > 255 ? 255 : (uint8_t)v);
+}
+
+// write one I/Q sample with the given signal phase (or no signal if amplitude is zero)
+static void emit_sample(struct uat_modulator *mod, double phase, double amplitude, uint8_t *out)
+{
+    double theta = phase + mod->carrier_phase;
+    double i = 127.5 + amplitude * cos(theta);
+    double q = 127.5 + amplitude * sin(theta);
+
+    if (mod->noise_sigma > 0) {
+        i += mod->noise_sigma * gaussian_random(mod);
+        q += mod->noise_sigma * gaussian_random(mod);
+    }
+
+    out[0] = clamp_sample(i);
+    out[1] = clamp_sample(q);
+
+    mod->carrier_phase = fmod(mod->carrier_phase + mod->freq_offset, 2 * M_PI);
+}
+
+void modulate_noise(struct uat_modulator *mod, uint8_t *out, int n)
+{
+    while (--n >= 0) {
+        emit_sample(mod, 0, 0, out);
+        out += 2;
+    }
+}
+
+// Modulate 'nbits' bits, each -1 or +1, into 2*nbits I/Q samples
+static int modulate_bits(struct uat_modulator *mod, const int8_t *bits, int nbits, uint8_t *out)
+{
+    int n;
+    int bit = 0;
+    double bit_phase = 0; // phase at the start of 'bit'
+
+    for (n = 0; n < nbits * 2; ++n) {
+        // sampling instant, measured in bits from the start of the frame
+        double t = (n + mod->timing_offset) / 2.0;
+        while (bit + 1 <= t && bit + 1 < nbits) {
+            bit_phase += bits[bit] * PHASE_PER_BIT;
+            ++bit;
+        }
+
+        emit_sample(mod, bit_phase + bits[bit] * PHASE_PER_BIT * (t - bit), mod->amplitude, out);
+        out += 2;
+    }
+
+    return nbits * 2;
+}
+
+// Expand a sync word and frame bytes into a +/-1 bit sequence
+static int frame_to_bits(uint64_t sync_word, const uint8_t *frame, int bytes, int8_t *bits)
+{
+    int i, j, n = 0;
+
+    for (i = SYNC_BITS - 1; i >= 0; --i)
+        bits[n++] = (sync_word & (1UL << i)) ? 1 : -1;
+
+    for (i = 0; i < bytes; ++i)
+        for (j = 7; j >= 0; --j)
+            bits[n++] = (frame[i] & (1 << j)) ? 1 : -1;
+
+    return n;
+}
+
+int modulate_adsb_frame(struct uat_modulator *mod, const uint8_t *frame, int frametype, uint8_t *out)
+{
+    int8_t bits[SYNC_BITS + LONG_FRAME_BITS];
+    int nbits = frame_to_bits(ADSB_SYNC_WORD, frame,
+                              frametype == 1 ? SHORT_FRAME_BYTES : LONG_FRAME_BYTES,
+                              bits);
+    return modulate_bits(mod, bits, nbits, out);
+}
+
+int modulate_uplink_frame(struct uat_modulator *mod, const uint8_t *frame, uint8_t *out)
+{
+    int8_t bits[SYNC_BITS + UPLINK_FRAME_BITS];
+    int nbits = frame_to_bits(UPLINK_SYNC_WORD, frame, UPLINK_FRAME_BYTES, bits);
+    return modulate_bits(mod, bits, nbits, out);
+}
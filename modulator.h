@@ -0,0 +1,80 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DUMP978_MODULATOR_H
+#define DUMP978_MODULATOR_H
+
+#include <stdint.h>
+
+#include "uat.h"
+
+// Synthetic UAT signal generator.
+//
+// Produces 8-bit unsigned I/Q samples (the same format that dump978
+// expects on stdin) at 2.083334MHz, i.e. two samples per UAT bit.
+// Frames are CPFSK-modulated with modulation index 0.6 and optionally
+// degraded by additive white gaussian noise, a carrier frequency offset,
+// and a fractional-sample timing offset.
+
+#define MODULATOR_SAMPLE_RATE (2083334.0)
+#define MODULATOR_BIT_RATE (MODULATOR_SAMPLE_RATE / 2)
+
+// Number of I/Q samples (not bytes) produced for a downlink/uplink frame,
+// including the sync word
+#define MODULATOR_SAMPLES(frame_bits) (((frame_bits) + SYNC_BITS) * 2)
+
+struct uat_modulator {
+    double amplitude;     // signal amplitude, in cu8 units (max 127.5)
+    double noise_sigma;   // noise standard deviation per I/Q component
+    double freq_offset;   // carrier phase step per sample, radians
+    double timing_offset; // sampling instant offset, fraction of a sample
+
+    double carrier_phase; // running carrier phase, radians
+    uint64_t rng;         // PRNG state
+    int have_spare;       // gaussian PRNG spare value
+    double spare;
+};
+
+// Initialize a modulator.
+//   snr_db: ratio of signal power to noise power, in dB
+//   freq_offset_hz: carrier frequency offset
+//   timing_offset: sampling instant offset as a fraction of a sample, [0..1)
+//   seed: PRNG seed (the same seed produces the same output)
+void modulator_init(struct uat_modulator *mod,
+                    double snr_db, double freq_offset_hz, double timing_offset,
+                    uint64_t seed);
+
+// Return a uniformly distributed random value in (0, 1] from the
+// modulator's PRNG.
+double modulator_random(struct uat_modulator *mod);
+
+// Write 'n' I/Q samples (2*n bytes) of noise-only signal to 'out'.
+void modulate_noise(struct uat_modulator *mod, uint8_t *out, int n);
+
+// Modulate a complete downlink frame (sync word followed by
+// SHORT_FRAME_BYTES or LONG_FRAME_BYTES of RS-encoded data).
+// 'out' must have space for 2*MODULATOR_SAMPLES(LONG_FRAME_BITS) bytes.
+// Returns the number of I/Q samples written.
+int modulate_adsb_frame(struct uat_modulator *mod, const uint8_t *frame, int frametype, uint8_t *out);
+
+// Modulate a complete uplink frame (sync word followed by
+// UPLINK_FRAME_BYTES of interleaved RS-encoded data).
+// 'out' must have space for 2*MODULATOR_SAMPLES(UPLINK_FRAME_BITS) bytes.
+// Returns the number of I/Q samples written.
+int modulate_uplink_frame(struct uat_modulator *mod, const uint8_t *frame, uint8_t *out);
+
+#endif
@@ -16,6 +16,8 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <unistd.h>
@@ -23,17 +25,30 @@
 
 #include "uat.h"
 #include "reader.h"
+#include "reader_simd.h"
+
+// Input is read into 'buf', and complete lines are parsed in batches of
+// up to READER_MAX_BATCH frames. The frame data of a batch goes into
+// 'frame_data'; hex takes two characters per byte, so the frames from
+// one buffer's worth of lines always fit. The lines a batch came from
+// stay in 'buf' (the metadata points into them) until the next call.
+
+#define READER_BUF_SIZE 65536
+#define READER_MAX_BATCH 256
 
 struct dump978_reader {
     int fd;
-    char buf[4096];
-    uint8_t frame[UPLINK_FRAME_DATA_BYTES]; // max uplink frame size
-    int used;
+    int used;                   // bytes in buf
+    int parsed;                 // bytes of buf that have been parsed
+    const struct reader_simd_impl *simd;
+    struct dump978_frame batch[READER_MAX_BATCH];
+    char buf[READER_BUF_SIZE];
+    uint8_t frame_data[READER_BUF_SIZE / 2];
 };
 
-static int process_input(struct dump978_reader *reader, frame_handler_t handler, void *handler_data);
-static int process_line(struct dump978_reader *reader, frame_handler_t handler, void *handler_data, char *p, char *end);
-static int hexbyte(char *buf);
+static int parse_batch(struct dump978_reader *reader);
+static int parse_line(const struct reader_simd_impl *simd, const char *p, const char *delim, const char *newline,
+                      uint8_t *out, struct dump978_frame *frame);
 
 struct dump978_reader *dump978_reader_new(int fd, int nonblock)
 {
@@ -53,22 +68,43 @@ struct dump978_reader *dump978_reader_new(int fd, int nonblock)
         
     reader->fd = fd;
     reader->used = 0;
+    reader->simd = reader_simd_select();
     return reader;
 }
     
-int dump978_read_frames(struct dump978_reader *reader,
-                        frame_handler_t handler,
-                        void *handler_data)
+// Drop the lines that have been parsed
+static void discard_parsed(struct dump978_reader *reader)
+{
+    if (reader->parsed > 0) {
+        reader->used -= reader->parsed;
+        memmove(reader->buf, reader->buf + reader->parsed, reader->used);
+        reader->parsed = 0;
+    }
+}
+
+int dump978_reader_next_batch(struct dump978_reader *reader,
+                              const struct dump978_frame **frames)
 {
-    int framecount = 0;
     ssize_t bytes_read;
+    int n;
 
-    if (!reader) {
+    if (!reader || !frames) {
         errno = EINVAL;
         return -1;
     }
 
+    // the previous batch is no longer needed
+    discard_parsed(reader);
+
     for (;;) {
+        // there may be whole lines left over from the last read
+        n = parse_batch(reader);
+        if (n > 0) {
+            *frames = reader->batch;
+            return n;
+        }
+
+        discard_parsed(reader);
         if (reader->used == sizeof(reader->buf)) {
             // line too long, ditch input
             reader->used = 0;
@@ -77,15 +113,44 @@ int dump978_read_frames(struct dump978_reader *reader,
         bytes_read = read(reader->fd,
                           reader->buf + reader->used,
                           sizeof(reader->buf) - reader->used);
-        if (bytes_read <= 0)
-            break;
-        
+        if (bytes_read == 0)
+            return 0; // EOF
+        if (bytes_read < 0)
+            return -1;
+
         reader->used += bytes_read;
+    }
+}
+
+// Pass each frame to 'handler', or with its metadata to 'ext_handler'
+static int read_frames(struct dump978_reader *reader,
+                       frame_handler_t handler,
+                       frame_handler_ext_t ext_handler,
+                       void *handler_data)
+{
+    const struct dump978_frame *frames;
+    struct dump978_metadata meta;
+    int framecount = 0;
+    int n, i;
+
+    if (!reader) {
+        errno = EINVAL;
+        return -1;
+    }
 
-        framecount += process_input(reader, handler, handler_data);
+    while ((n = dump978_reader_next_batch(reader, &frames)) > 0) {
+        for (i = 0; i < n; ++i) {
+            if (ext_handler) {
+                dump978_parse_metadata(frames[i].metadata, frames[i].metadata_len, &meta);
+                ext_handler(frames[i].type, frames[i].data, frames[i].len, &meta, handler_data);
+            } else {
+                handler(frames[i].type, frames[i].data, frames[i].len, handler_data);
+            }
+        }
+        framecount += n;
     }
 
-    if (bytes_read == 0)
+    if (n == 0)
         return framecount; // EOF
 
     // only report EAGAIN et al if no frames were read
@@ -95,6 +160,20 @@ int dump978_read_frames(struct dump978_reader *reader,
     return -1; // propagate unexpected error
 }
 
+int dump978_read_frames(struct dump978_reader *reader,
+                        frame_handler_t handler,
+                        void *handler_data)
+{
+    return read_frames(reader, handler, NULL, handler_data);
+}
+
+int dump978_read_frames_ext(struct dump978_reader *reader,
+                            frame_handler_ext_t handler,
+                            void *handler_data)
+{
+    return read_frames(reader, NULL, handler, handler_data);
+}
+
 void dump978_reader_free(struct dump978_reader *reader)
 {
     if (!reader)
@@ -103,97 +182,210 @@ void dump978_reader_free(struct dump978_reader *reader)
     free(reader);
 }
 
-static int process_input(struct dump978_reader *reader, frame_handler_t handler, void *handler_data)
+void dump978_reader_use_simd(struct dump978_reader *reader, const struct reader_simd_impl *impl)
+{
+    reader->simd = impl;
+}
+
+// Parse complete lines from the unparsed part of the buffer into the
+// batch, until the batch is full. Returns the number of frames found.
+static int parse_batch(struct dump978_reader *reader)
 {
-    char *p = reader->buf;
-    char *end = reader->buf + reader->used;
+    return reader_parse_lines(reader->simd, reader->buf, reader->used, &reader->parsed,
+                              reader->frame_data, reader->batch, READER_MAX_BATCH);
+}
+
+int reader_parse_lines(const struct reader_simd_impl *simd, char *buf, int used, int *parsed,
+                       uint8_t *out, struct dump978_frame *batch, int max_frames)
+{
+    char *p = buf + *parsed;
+    char *end = buf + used;
     int framecount = 0;
 
-    while (p < end) {
-        char *newline;
+    while (p < end && framecount < max_frames) {
+        const char *delim, *newline;
 
-        newline = memchr(p, '\n', end - p);
-        if (newline == NULL)
+        // the hex data is scanned once, for either delimiter; only the
+        // (short) metadata is scanned again for the newline
+        delim = simd->find_delim(p, end);
+        if (delim == NULL)
             break;
-        
-        if (*p == '-' || *p == '+')
-            framecount += process_line(reader, handler, handler_data, p, newline);
-        
-        p = newline+1;
-    }
 
-    if (p >= end) {
-        reader->used = 0;
-    } else {
-        reader->used = end - p;
-        memmove(reader->buf, p, reader->used);
+        if (*delim == ';') {
+            newline = memchr(delim, '\n', end - delim);
+            if (newline == NULL)
+                break;
+        } else {
+            newline = delim;
+        }
+
+        if (parse_line(simd, p, delim, newline, out, &batch[framecount])) {
+            out += batch[framecount].len;
+            ++framecount;
+        }
+
+        p = (char *) newline + 1;
     }
 
+    *parsed = p - buf;
     return framecount;
 }
 
-static int process_line(struct dump978_reader *reader, frame_handler_t handler, void *handler_data, char *p, char *end)
+// Parse the line starting at 'p', where 'delim' is the first ';' or
+// newline in the line. The frame is the even number of hex digits
+// between the type character and a ';'; anything else is rejected.
+// On success, decodes the frame data into 'out', fills in 'frame',
+// and returns 1.
+static int parse_line(const struct reader_simd_impl *simd, const char *p, const char *delim, const char *newline,
+                      uint8_t *out, struct dump978_frame *frame)
 {
-    uint8_t *out;
-    int len = 0;
     frame_type_t frametype;
-    
+    int digits;
+
     if (*p == '-')
         frametype = UAT_DOWNLINK;
     else if (*p == '+')
         frametype = UAT_UPLINK;
     else
         return 0;
-    
-    out = reader->frame;
+
+    if (*delim != ';')
+        return 0; // ran off the end without seeing semicolon
+
     ++p;
-    while (p < end) {
-        int byte;
-                
-        if (p[0] == ';') {
-            // ignore rest of line
-            handler(frametype, reader->frame, len, handler_data);
-            return 1;
-        }
-        
-        if (len >= sizeof(reader->frame))
-            return 0; // oversized frame
-                
-        byte = hexbyte(p);
-        if (byte < 0)
-            return 0; // badly formatted byte
-                
-        ++len;
-        *out++ = byte;
-        p += 2;
+    digits = delim - p;
+    if (digits & 1)
+        return 0; // badly formatted byte
+    if (digits / 2 > UPLINK_FRAME_DATA_BYTES)
+        return 0; // oversized frame
+    if (!simd->hex_decode(p, digits, out))
+        return 0; // badly formatted byte
+
+    frame->type = frametype;
+    frame->data = out;
+    frame->len = digits / 2;
+    frame->metadata = delim + 1;
+    frame->metadata_len = newline - (delim + 1);
+    return 1;
+}
+
+// Known metadata keys. A value is copied into a buffer of
+// METADATA_MAX_VALUE characters (longer values are ignored) before it
+// is converted, so nothing reads past the end of the metadata.
+
+#define METADATA_MAX_VALUE 32
+
+enum metadata_type { META_INT, META_UINT32, META_DOUBLE, META_STRING };
+
+static const struct metadata_key {
+    const char *key;
+    int key_len;
+    enum metadata_type type;
+    unsigned flag;              // DUMP978_META_* bit
+    size_t offset;              // of the field in struct dump978_metadata
+    size_t size;                // of the field, for strings
+} metadata_keys[] = {
+    { "rs",   2, META_INT,    DUMP978_META_RS,        offsetof(struct dump978_metadata, rs), 0 },
+    { "t",    1, META_DOUBLE, DUMP978_META_TIMESTAMP, offsetof(struct dump978_metadata, timestamp), 0 },
+    { "rssi", 4, META_DOUBLE, DUMP978_META_RSSI,      offsetof(struct dump978_metadata, rssi), 0 },
+    { "rx",   2, META_STRING, DUMP978_META_RECEIVER,  offsetof(struct dump978_metadata, receiver_id),
+      sizeof(((struct dump978_metadata *) 0)->receiver_id) },
+    { "seq",  3, META_UINT32, DUMP978_META_SEQ,       offsetof(struct dump978_metadata, seq), 0 },
+    { NULL, 0, 0, 0, 0, 0 }
+};
+
+// Convert one value; returns 1 if it was valid
+static int parse_metadata_value(const struct metadata_key *key, const char *value, int len,
+                                struct dump978_metadata *meta)
+{
+    char buf[METADATA_MAX_VALUE + 1];
+    char *field = (char *) meta + key->offset;
+    char *end;
+
+    if (len <= 0 || len > METADATA_MAX_VALUE)
+        return 0;
+    memcpy(buf, value, len);
+    buf[len] = 0;
+
+    switch (key->type) {
+    case META_INT: {
+        long v;
+        if (buf[0] != '-' && (buf[0] < '0' || buf[0] > '9'))
+            return 0; // no leading spaces or '+'
+        errno = 0;
+        v = strtol(buf, &end, 10);
+        if (*end || errno || v < -65535 || v > 65535)
+            return 0;
+        *(int *) field = (int) v;
+        return 1;
+    }
+
+    case META_UINT32: {
+        unsigned long long v;
+        if (buf[0] < '0' || buf[0] > '9')
+            return 0; // no sign
+        errno = 0;
+        v = strtoull(buf, &end, 10);
+        if (*end || errno || v > UINT32_MAX)
+            return 0;
+        *(uint32_t *) field = (uint32_t) v;
+        return 1;
     }
 
-    return 0; // ran off the end without seeing semicolon
-}    
+    case META_DOUBLE: {
+        double v;
+        if (buf[0] != '-' && buf[0] != '.' && (buf[0] < '0' || buf[0] > '9'))
+            return 0;
+        v = strtod(buf, &end);
+        if (*end || !isfinite(v))
+            return 0;
+        *(double *) field = v;
+        return 1;
+    }
 
-static int hexbyte(char *buf)
+    case META_STRING:
+        if ((size_t) len >= key->size)
+            return 0;
+        memcpy(field, buf, len + 1);
+        return 1;
+    }
+
+    return 0;
+}
+
+int dump978_parse_metadata(const char *text, int len, struct dump978_metadata *meta)
 {
-    int i;
-    char c;
-
-    c = buf[0];
-    if (c >= '0' && c <= '9')
-        i = (c - '0');
-    else if (c >= 'a' && c <= 'f')
-        i = (c - 'a' + 10);
-    else if (c >= 'A' && c <= 'F')
-        i = (c - 'A' + 10);
-    else
-        return -1;
+    const char *p = text;
+    const char *end = text + len;
+    int found = 0;
 
-    i <<= 4;
-    c = buf[1];
-    if (c >= '0' && c <= '9')
-        return i | (c - '0');
-    else if (c >= 'a' && c <= 'f')
-        return i | (c - 'a' + 10);
-    else if (c >= 'A' && c <= 'F')
-        return i | (c - 'A' + 10);
-    else
-        return -1;
+    memset(meta, 0, sizeof(*meta));
+
+    while (p < end) {
+        const char *field_end = memchr(p, ';', end - p);
+        const char *equals;
+        const struct metadata_key *key;
+
+        if (!field_end)
+            field_end = end; // last field need not be terminated
+        equals = memchr(p, '=', field_end - p);
+
+        if (equals) {
+            for (key = metadata_keys; key->key; ++key) {
+                if (key->key_len == equals - p && !memcmp(key->key, p, key->key_len))
+                    break;
+            }
+
+            // a repeated field replaces the earlier one
+            if (key->key && parse_metadata_value(key, equals + 1, field_end - equals - 1, meta)) {
+                if (!(meta->present & key->flag))
+                    ++found;
+                meta->present |= key->flag;
+            }
+        }
+
+        p = field_end + 1;
+    }
+
+    return found;
 }
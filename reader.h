@@ -18,7 +18,9 @@
 #ifndef DUMP978_READER_H
 #define DUMP978_READER_H
 
+#include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 
 struct dump978_reader;
 
@@ -35,6 +37,50 @@ typedef enum { UAT_UPLINK, UAT_DOWNLINK } frame_type_t;
 // preserve the data after returning, it should take a copy.
 typedef void (*frame_handler_t)(frame_type_t t,uint8_t *f,int l,void *d);
 
+// Bits of dump978_metadata.present, one per known metadata field
+#define DUMP978_META_RS         0x0001
+#define DUMP978_META_TIMESTAMP  0x0002
+#define DUMP978_META_RSSI       0x0004
+#define DUMP978_META_RECEIVER   0x0008
+#define DUMP978_META_SEQ        0x0010
+
+#define DUMP978_RECEIVER_ID_MAX 15
+
+// The known fields of a frame's metadata. The metadata section of a
+// line (after the first ';') is a sequence of "key=value;" fields:
+//   rs=N      number of Reed-Solomon errors corrected (dump978 writes
+//             this when it is nonzero)
+//   t=S       receive time, seconds since the Unix epoch (may have a
+//             fractional part)
+//   rssi=X    signal level, dBFS
+//   rx=ID     receiver identifier, up to DUMP978_RECEIVER_ID_MAX characters
+//   seq=N     sequence number, 0..4294967295, counting up by one per frame
+//             from each sender (used to detect loss on UDP sources)
+// Fields with other keys, and fields with a malformed or out of range
+// value, are ignored. Fields not marked in 'present' are zero.
+struct dump978_metadata {
+    unsigned present;           // DUMP978_META_* bits of the fields found
+    int rs;
+    double timestamp;
+    double rssi;
+    char receiver_id[DUMP978_RECEIVER_ID_MAX + 1];  // NUL-terminated
+    uint32_t seq;
+};
+
+// Function pointer type for a handler called by dump978_read_frames_ext().
+// As frame_handler_t, with the parsed metadata of the frame in 'm'; the
+// metadata is only valid until the handler returns.
+typedef void (*frame_handler_ext_t)(frame_type_t t,uint8_t *f,int l,const struct dump978_metadata *m,void *d);
+
+// A frame returned by dump978_reader_next_batch().
+struct dump978_frame {
+    frame_type_t type;          // UAT_UPLINK or UAT_DOWNLINK
+    int len;                    // length of frame data
+    uint8_t *data;              // frame data
+    const char *metadata;       // the text after the first ';' of the line,
+    int metadata_len;           //   up to (not including) the newline
+};
+
 // Allocate a new reader that reads from file descriptor 'fd'.
 // If 'nonblock' is nonzero, the FD will be made nonblocking.
 // Returns the reader, or NULL on error with errno set.
@@ -57,7 +103,159 @@ int dump978_read_frames(struct dump978_reader *reader,
                         frame_handler_t handler,
                         void *handler_data);
 
-#endif
+// As dump978_read_frames(), but also parses the metadata of each frame
+// and passes it to 'handler'.
+int dump978_read_frames_ext(struct dump978_reader *reader,
+                            frame_handler_ext_t handler,
+                            void *handler_data);
+
+// Parse the 'len' characters of metadata at 'text' (which need not be
+// NUL-terminated; e.g. the metadata of a struct dump978_frame) into
+// 'meta'. Does not allocate. Returns the number of known fields found.
+int dump978_parse_metadata(const char *text, int len, struct dump978_metadata *meta);
+
+// Read the next batch of frames from the given reader, without copying
+// them anywhere: sets *frames to an array of frames owned by the reader,
+// which stay valid (and may be modified in place) until the next call
+// to dump978_reader_next_batch(), dump978_read_frames() or
+// dump978_reader_free(). Reads input only when no complete frames are
+// buffered.
+//
+// Returns a positive number of frames on success.
+// Returns 0 on EOF.
+// Returns <0 on error with errno set.
+// If the underlying FD is nonblocking and no frames are
+// available, returns <0 with errno = EAGAIN/EINTR/EWOULDBLOCK.
+int dump978_reader_next_batch(struct dump978_reader *reader,
+                              const struct dump978_frame **frames);
+
+// Function pointer type for a handler called by dump978_read_parallel()
+// on its worker threads. As frame_handler_t, but anything the handler
+// writes should go to 'out', which collects the output of one chunk of
+// the file; several handler calls may be running at once.
+typedef void (*parallel_frame_handler_t)(frame_type_t t,uint8_t *f,int l,FILE *out,void *d);
+
+struct dump978_parallel_config {
+    int threads;                // worker threads, or 0 for one per CPU
+    int ordered;                // nonzero: dispatch frames / output in file order
+    size_t chunk_size;          // bytes per chunk, or 0 for the default (4MB)
+
+    // exactly one of these:
+    frame_handler_t handler;                    // called on the calling thread
+    parallel_frame_handler_t parallel_handler;  // called on the worker threads
+
+    FILE *output;               // where the output of parallel_handler goes
+    void *handler_data;         // passed to the handler
+};
+
+// Read all frames from 'fd', which must be a regular file, by mapping it
+// and parsing chunks of it (split at newlines) on several threads.
+//
+// With config->handler, the frames are passed to it exactly as
+// dump978_read_frames() would, one at a time and only on the calling
+// thread, so any frame handler works unchanged. Frames within a chunk
+// are always in file order; the chunks themselves are in file order if
+// config->ordered is set, and otherwise in the order they are parsed.
+//
+// With config->parallel_handler, the handler is called on the worker
+// threads, so it must be safe to run concurrently; the output of each
+// chunk is written to config->output by the calling thread, in file
+// order if config->ordered is set.
+//
+// Returns the number of frames read (0 for an empty file).
+// Returns <0 on error with errno set; ENODEV if 'fd' is not a regular
+// file.
+int dump978_read_parallel(int fd, const struct dump978_parallel_config *config);
+
+// A reader set reads frames from many sources at once (files, pipes,
+// and stream sockets, including listening sockets whose connections
+// are added as they arrive) on one thread, using epoll. Each source has
+// its own line buffer and counters. Every source that is ready gets one
+// read per call to dump978_reader_set_poll(), so a busy source can't
+// starve the others.
+struct dump978_reader_set;
+
+// Per-source counters, returned by dump978_reader_set_stats()
+struct dump978_source_stats {
+    int open;                   // nonzero until the source reaches EOF or fails
+    int error;                  // errno of the error that closed the source, or 0
+    uint64_t bytes;             // bytes read
+    uint64_t frames;            // frames passed to the handler
+    uint64_t accepted;          // connections accepted (listening sockets only)
+    uint64_t refused;           // connections closed at once for want of a
+                                // descriptor (listening sockets only)
+
+    // UDP sockets only:
+    uint64_t datagrams;         // datagrams received
+    uint64_t lost;              // frames missing from the sequence numbers that
+                                // have not arrived late since
+    uint64_t late;              // frames that arrived after later ones
+    uint64_t duplicates;        // frames that arrived twice (among the last
+                                // 256 numbers of their sender)
+    int senders;                // senders seen (up to a limit of 256)
+};
+
+// Function pointer type for a handler called by dump978_reader_set_poll().
+// It is called with the source id (as returned by dump978_reader_set_add()
+// etc), the frame, and the value of handler_data passed to
+// dump978_reader_set_poll(). The frame is only valid until the handler
+// returns.
+typedef void (*source_frame_handler_t)(int source, const struct dump978_frame *frame, void *d);
+
+// Allocate a new, empty reader set.
+// Returns the set, or NULL on error with errno set.
+struct dump978_reader_set *dump978_reader_set_new(void);
+
+// Free a reader set, closing all of its sources that are still open.
+void dump978_reader_set_free(struct dump978_reader_set *set);
 
+// Add a source that frames are read from. The set takes ownership of
+// 'fd', makes it nonblocking, and closes it at EOF, on a read error, or
+// when the set is freed.
+// Returns the source id (>= 0), or <0 on error with errno set (in which
+// case 'fd' is not closed). Once a source has closed, its id (and its
+// counters) may be reused by a source added later.
+int dump978_reader_set_add(struct dump978_reader_set *set, int fd);
 
-                         
+// As dump978_reader_set_add(), for a listening stream socket; each
+// connection accepted on it is added as a new source.
+int dump978_reader_set_add_listener(struct dump978_reader_set *set, int fd);
+
+// As dump978_reader_set_add(), for a bound UDP (or other datagram)
+// socket. Each datagram holds one or more complete lines (the newline
+// after the last one is optional), and many are received per system
+// call. If a sender numbers its frames with seq=N metadata, gaps and
+// reordering in the numbers of each sender (by address) are counted.
+int dump978_reader_set_add_udp(struct dump978_reader_set *set, int fd);
+
+// Open the source described by 'spec' and add it:
+//   -                      standard input
+//   tcp:HOST:PORT          connect to a TCP server
+//   listen:[HOST:]PORT     accept TCP connections
+//   unix:PATH              connect to a Unix stream socket
+//   unix-listen:PATH       accept connections on a Unix stream socket
+//   udp:[HOST:]PORT        receive UDP datagrams
+//   anything else          a file or FIFO to open
+// Returns the source id, or <0 on error with errno set.
+int dump978_reader_set_open(struct dump978_reader_set *set, const char *spec);
+
+// Wait up to 'timeout_ms' milliseconds (-1: indefinitely) for input on
+// any source, read from every source that is ready, and pass each
+// complete frame read to 'handler', passing 'handler_data' as the last
+// argument.
+//
+// Returns the number of frames passed to the handler (0 if nothing
+// arrived in time).
+// Returns <0 on error with errno set, including EINTR if interrupted.
+int dump978_reader_set_poll(struct dump978_reader_set *set, int timeout_ms,
+                            source_frame_handler_t handler,
+                            void *handler_data);
+
+// Return the number of sources that are still open. Once this is zero,
+// dump978_reader_set_poll() will never return any more frames.
+int dump978_reader_set_active(struct dump978_reader_set *set);
+
+// Return the counters for a source, or NULL if there is no such source.
+const struct dump978_source_stats *dump978_reader_set_stats(struct dump978_reader_set *set, int source);
+
+#endif
@@ -0,0 +1,289 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Message reader benchmark: times dump978_read_frames() with each hex
+// decoding / line scanning implementation in reader_simd.c on messages
+// read from stdin (e.g. the decompressed sample data) replayed many
+// times, then compares the callback and batch APIs with consumers that do
+// what uat2text and uat2json do with each frame.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "uat.h"
+#include "reader.h"
+#include "reader_simd.h"
+#include "uat_decode.h"
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct frame_log {
+    int frames;
+    uint32_t hash;
+};
+
+static void log_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    struct frame_log *log = d;
+    int i;
+
+    ++log->frames;
+    log->hash = log->hash * 31 + t;
+    log->hash = log->hash * 31 + l;
+    for (i = 0; i < l; ++i)
+        log->hash = log->hash * 31 + f[i];
+}
+
+// Feed 'data' through a reader using 'impl', from a file
+static struct frame_log read_all(FILE *f, const struct reader_simd_impl *impl)
+{
+    struct dump978_reader *reader;
+    struct frame_log log = { 0, 0 };
+
+    rewind(f);
+    reader = dump978_reader_new(fileno(f), 0);
+    dump978_reader_use_simd(reader, impl);
+    while (dump978_read_frames(reader, log_frame, &log) > 0)
+        ;
+    dump978_reader_free(reader);
+    return log;
+}
+
+static FILE *make_file(const char *data, size_t len, int repeat)
+{
+    FILE *f = tmpfile();
+    int i;
+
+    if (!f) {
+        perror("tmpfile");
+        exit(1);
+    }
+
+    for (i = 0; i < repeat; ++i)
+        fwrite(data, 1, len, f);
+    fflush(f);
+    return f;
+}
+
+// What uat2text and uat2json do with a frame
+static FILE *null_output;
+
+static void text_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    int i;
+
+    for (i = 0; i < l; i++)
+        fprintf(null_output, "%02x", f[i]);
+    fprintf(null_output, "\n");
+    if (t == UAT_DOWNLINK) {
+        struct uat_adsb_mdb mdb;
+        uat_decode_adsb_mdb(f, &mdb);
+        uat_display_adsb_mdb(&mdb, null_output);
+    } else {
+        struct uat_uplink_mdb mdb;
+        uat_decode_uplink_mdb(f, &mdb);
+        uat_display_uplink_mdb(&mdb, null_output);
+    }
+    fprintf(null_output, "\n");
+}
+
+static void text_frame_flush(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    text_frame(t, f, l, d);
+    fflush(null_output);
+}
+
+static void json_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    struct uat_adsb_mdb mdb;
+
+    if (t != UAT_DOWNLINK)
+        return;
+    uat_decode_adsb_mdb(f, &mdb);
+    *(uint32_t *) d += mdb.address;
+}
+
+static void count_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    ++*(uint32_t *) d;
+}
+
+// Time reading 'f' with each API and consumer. The callback consumers
+// flush per frame, as uat2text used to; the batch ones per batch.
+static void bench_apis(FILE *f)
+{
+    static const struct {
+        const char *name;
+        frame_handler_t callback;
+        frame_handler_t batch;
+        int flush;
+    } consumers[] = {
+        { "parse only", count_frame, count_frame, 0 },
+        { "uat2text", text_frame_flush, text_frame, 1 },
+        { "uat2json", json_frame, json_frame, 0 },
+        { NULL, NULL, NULL, 0 }
+    };
+    int c;
+
+    null_output = fopen("/dev/null", "w");
+    printf("\n%-12s %18s %18s %8s\n", "consumer", "callback kframes/s", "batch kframes/s", "speedup");
+
+    for (c = 0; consumers[c].name; ++c) {
+        struct dump978_reader *reader;
+        const struct dump978_frame *frames;
+        uint32_t sink = 0;
+        double start, callback_time, batch_time;
+        int frame_count = 0, n, i;
+
+        rewind(f);
+        reader = dump978_reader_new(fileno(f), 0);
+        start = now();
+        while ((n = dump978_read_frames(reader, consumers[c].callback, &sink)) > 0)
+            frame_count += n;
+        callback_time = now() - start;
+        dump978_reader_free(reader);
+
+        rewind(f);
+        reader = dump978_reader_new(fileno(f), 0);
+        start = now();
+        while ((n = dump978_reader_next_batch(reader, &frames)) > 0) {
+            for (i = 0; i < n; ++i)
+                consumers[c].batch(frames[i].type, frames[i].data, frames[i].len, &sink);
+            if (consumers[c].flush)
+                fflush(null_output);
+        }
+        batch_time = now() - start;
+        dump978_reader_free(reader);
+
+        printf("%-12s %18.1f %18.1f %7.2fx\n", consumers[c].name,
+               frame_count / callback_time / 1e3, frame_count / batch_time / 1e3,
+               callback_time / batch_time);
+    }
+
+    fclose(null_output);
+}
+
+static void usage(int argc, char **argv)
+{
+    fprintf(stderr,
+            "Syntax: %s [-n REPEAT]\n"
+            "\n"
+            "Benchmarks reading the messages on stdin with each of the reader's hex\n"
+            "decoding and line scanning implementations, e.g.:\n"
+            "  zcat sample-data.txt.gz | %s\n"
+            "\n"
+            "  -n REPEAT  Times to replay the input (default 200)\n"
+            "  -h         Show this usage message\n",
+            argv[0], argv[0]);
+}
+
+int main(int argc, char **argv)
+{
+    const struct reader_simd_impl *impl, *ref;
+    struct frame_log ref_log = { 0, 0 };
+    double ref_time = 0;
+    char *input = NULL;
+    size_t len = 0, size = 0;
+    int repeat = 200;
+    FILE *f;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hn:")) > 0) {
+        switch (opt) {
+        case 'h':
+            usage(argc, argv);
+            return 0;
+        case 'n':
+            repeat = atoi(optarg);
+            if (repeat <= 0) {
+                fprintf(stderr, "repeat count must be positive\n");
+                return 1;
+            }
+            break;
+        default:
+            usage(argc, argv);
+            return 1;
+        }
+    }
+
+    for (;;) {
+        ssize_t n;
+
+        if (len == size) {
+            size = (size ? size * 2 : 65536);
+            input = realloc(input, size);
+        }
+        if ((n = read(0, input + len, size - len)) <= 0)
+            break;
+        len += n;
+    }
+
+    // the last entry is the scalar version
+    for (ref = reader_simd_impls; ref[1].name; ++ref)
+        ;
+
+    if (len == 0) {
+        fprintf(stderr, "no input to benchmark\n");
+        return 1;
+    }
+
+    f = make_file(input, len, repeat);
+    printf("reading %.1fMB (%d copies of the input):\n", (double) len * repeat / 1e6, repeat);
+    printf("%-8s %10s %10s %8s\n", "impl", "MB/s", "kframes/s", "speedup");
+
+    // scalar (the reference) first
+    for (impl = ref; ; --impl) {
+        struct frame_log log;
+        double start, elapsed;
+
+        if (impl->supported()) {
+            read_all(f, impl); // warm the page cache
+            start = now();
+            log = read_all(f, impl);
+            elapsed = now() - start;
+
+            if (impl == ref) {
+                ref_log = log;
+                ref_time = elapsed;
+            } else if (log.frames != ref_log.frames || log.hash != ref_log.hash) {
+                fprintf(stderr, "%s: FAIL: frames differ from the scalar reader\n", impl->name);
+                return 1;
+            }
+
+            printf("%-8s %10.1f %10.1f %7.2fx\n", impl->name,
+                   len * repeat / elapsed / 1e6, log.frames / elapsed / 1e3, ref_time / elapsed);
+        }
+
+        if (impl == reader_simd_impls)
+            break;
+    }
+
+    bench_apis(f);
+
+    fclose(f);
+    free(input);
+    return 0;
+}
@@ -0,0 +1,345 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Reading a large file of frames on several threads.
+//
+// The file is mapped, and split into chunks that end at newlines. Worker
+// threads take chunks in file order and parse them; with a plain
+// handler the frames of each chunk are kept until the calling thread
+// passes them to the handler, and with a parallel handler the worker
+// calls it directly, with a memory stream for the chunk's output that
+// the calling thread then writes out. The calling thread takes finished
+// chunks either in file order, or in the order they finish.
+//
+// Workers only run a limited number of chunks ahead of the oldest one
+// that hasn't been dispatched, so memory use doesn't depend on the size
+// of the file.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "uat.h"
+#include "reader.h"
+#include "reader_simd.h"
+
+#define PARALLEL_CHUNK_SIZE (4 * 1024 * 1024)
+#define PARALLEL_MAX_CHUNK_SIZE (1024 * 1024 * 1024)
+#define PARALLEL_MAX_BATCH 256
+#define PARALLEL_WINDOW 4       // chunks in flight per thread
+
+struct chunk {
+    char *start;
+    int len;
+    int done;
+    int framecount;
+
+    // plain handler: the parsed frames
+    struct dump978_frame *frames;
+    uint8_t *data;
+
+    // parallel handler: what it wrote
+    char *output;
+    size_t output_len;
+};
+
+struct parallel_state {
+    const struct dump978_parallel_config *config;
+    const struct reader_simd_impl *simd;
+    struct chunk *chunks;
+    int n_chunks;
+    int window;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;   // a chunk was dispatched
+    pthread_cond_t done_cond;   // a chunk was parsed
+    int next_claim;             // next chunk for a worker to take
+    int dispatched;             // number of chunks dispatched
+    int *done_queue;            // finished chunks, in the order they finished
+    int done_head, done_tail;
+    int error;                  // errno of a failure in a worker, or 0
+};
+
+// Parse a chunk's frames into arrays that are kept until it is dispatched
+static int parse_chunk_frames(struct parallel_state *state, struct chunk *c)
+{
+    int parsed = 0, max_frames = 0, n;
+    uint8_t *out;
+
+    if (!(c->data = malloc(c->len / 2 + 1)))
+        return ENOMEM;
+    out = c->data;
+
+    do {
+        if (c->framecount + PARALLEL_MAX_BATCH > max_frames) {
+            struct dump978_frame *frames;
+
+            max_frames = (max_frames ? max_frames * 2 : 1024);
+            if (!(frames = realloc(c->frames, max_frames * sizeof(*frames))))
+                return ENOMEM;
+            c->frames = frames;
+        }
+
+        n = reader_parse_lines(state->simd, c->start, c->len, &parsed,
+                               out, c->frames + c->framecount, PARALLEL_MAX_BATCH);
+        if (n > 0) {
+            struct dump978_frame *last = &c->frames[c->framecount + n - 1];
+            out = last->data + last->len;
+        }
+        c->framecount += n;
+    } while (n == PARALLEL_MAX_BATCH);
+
+    return 0;
+}
+
+// Parse a chunk and pass its frames straight to the parallel handler
+static int run_chunk_parallel(struct parallel_state *state, struct chunk *c)
+{
+    const struct dump978_parallel_config *config = state->config;
+    struct dump978_frame batch[PARALLEL_MAX_BATCH];
+    uint8_t data[PARALLEL_MAX_BATCH * UPLINK_FRAME_DATA_BYTES];
+    FILE *out = open_memstream(&c->output, &c->output_len);
+    int parsed = 0, n, i;
+
+    if (!out)
+        return errno;
+
+    do {
+        n = reader_parse_lines(state->simd, c->start, c->len, &parsed,
+                               data, batch, PARALLEL_MAX_BATCH);
+        for (i = 0; i < n; ++i)
+            config->parallel_handler(batch[i].type, batch[i].data, batch[i].len, out, config->handler_data);
+        c->framecount += n;
+    } while (n == PARALLEL_MAX_BATCH);
+
+    if (fclose(out) != 0)
+        return errno;
+    return 0;
+}
+
+static void *worker(void *arg)
+{
+    struct parallel_state *state = arg;
+
+    pthread_mutex_lock(&state->lock);
+    for (;;) {
+        struct chunk *c;
+        int k, error;
+
+        while (state->next_claim < state->n_chunks && !state->error &&
+               state->next_claim - state->dispatched >= state->window)
+            pthread_cond_wait(&state->work_cond, &state->lock);
+        if (state->next_claim >= state->n_chunks || state->error)
+            break;
+
+        k = state->next_claim++;
+        c = &state->chunks[k];
+        pthread_mutex_unlock(&state->lock);
+
+        if (state->config->parallel_handler)
+            error = run_chunk_parallel(state, c);
+        else
+            error = parse_chunk_frames(state, c);
+
+        pthread_mutex_lock(&state->lock);
+        if (error && !state->error)
+            state->error = error;
+        c->done = 1;
+        state->done_queue[state->done_tail++] = k;
+        pthread_cond_signal(&state->done_cond);
+    }
+    pthread_mutex_unlock(&state->lock);
+
+    return NULL;
+}
+
+// Split the mapped file into chunks of about 'chunk_size' bytes that end
+// just after a newline (or at the end of the file)
+static int split_chunks(struct parallel_state *state, char *map, size_t size, size_t chunk_size)
+{
+    size_t start = 0;
+
+    state->chunks = calloc(size / chunk_size + 1, sizeof(*state->chunks));
+    if (!state->chunks)
+        return 0;
+
+    while (start < size) {
+        size_t end = start + chunk_size;
+        struct chunk *c = &state->chunks[state->n_chunks++];
+
+        if (end >= size) {
+            end = size;
+        } else {
+            char *newline = memchr(map + end - 1, '\n', size - end + 1);
+            end = (newline ? (size_t) (newline - map) + 1 : size);
+        }
+
+        if (end - start > PARALLEL_MAX_CHUNK_SIZE) {
+            // a huge run of garbage without newlines; the reader would
+            // discard it too
+            end = start + PARALLEL_MAX_CHUNK_SIZE;
+        }
+
+        c->start = map + start;
+        c->len = end - start;
+        start = end;
+    }
+
+    return 1;
+}
+
+static void dispatch_chunk(struct parallel_state *state, struct chunk *c)
+{
+    const struct dump978_parallel_config *config = state->config;
+    int i;
+
+    if (config->parallel_handler) {
+        if (c->output_len > 0)
+            fwrite(c->output, 1, c->output_len, config->output);
+    } else {
+        for (i = 0; i < c->framecount; ++i)
+            config->handler(c->frames[i].type, c->frames[i].data, c->frames[i].len, config->handler_data);
+    }
+
+    free(c->frames);
+    free(c->data);
+    free(c->output);
+    c->frames = NULL;
+    c->data = NULL;
+    c->output = NULL;
+}
+
+int dump978_read_parallel(int fd, const struct dump978_parallel_config *config)
+{
+    struct parallel_state state;
+    pthread_t *threads = NULL;
+    struct stat st;
+    char *map = NULL;
+    size_t chunk_size;
+    int n_threads, started = 0, framecount = 0, error = 0, i;
+
+    if (!config || (!config->handler == !config->parallel_handler) ||
+        (config->parallel_handler && !config->output)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (fstat(fd, &st) < 0)
+        return -1;
+    if (!S_ISREG(st.st_mode)) {
+        errno = ENODEV; // as mmap() would
+        return -1;
+    }
+    if (st.st_size == 0)
+        return 0;
+
+    chunk_size = (config->chunk_size ? config->chunk_size : PARALLEL_CHUNK_SIZE);
+    if (chunk_size > PARALLEL_MAX_CHUNK_SIZE)
+        chunk_size = PARALLEL_MAX_CHUNK_SIZE;
+    n_threads = config->threads;
+    if (n_threads <= 0 && (n_threads = sysconf(_SC_NPROCESSORS_ONLN)) <= 0)
+        n_threads = 1;
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+        return -1;
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    memset(&state, 0, sizeof(state));
+    state.config = config;
+    state.simd = reader_simd_select();
+    state.window = n_threads * PARALLEL_WINDOW;
+    pthread_mutex_init(&state.lock, NULL);
+    pthread_cond_init(&state.work_cond, NULL);
+    pthread_cond_init(&state.done_cond, NULL);
+
+    if (!split_chunks(&state, map, st.st_size, chunk_size) ||
+        !(state.done_queue = malloc(state.n_chunks * sizeof(int))) ||
+        !(threads = malloc(n_threads * sizeof(pthread_t)))) {
+        error = ENOMEM;
+        goto out;
+    }
+
+    for (started = 0; started < n_threads; ++started) {
+        if ((error = pthread_create(&threads[started], NULL, worker, &state)) != 0)
+            break;
+    }
+    if (started == 0)
+        goto out;
+    error = 0;
+
+    pthread_mutex_lock(&state.lock);
+    while (state.dispatched < state.n_chunks && !state.error) {
+        struct chunk *c;
+
+        if (config->ordered) {
+            c = &state.chunks[state.dispatched];
+            if (!c->done) {
+                pthread_cond_wait(&state.done_cond, &state.lock);
+                continue;
+            }
+        } else {
+            if (state.done_head == state.done_tail) {
+                pthread_cond_wait(&state.done_cond, &state.lock);
+                continue;
+            }
+            c = &state.chunks[state.done_queue[state.done_head++]];
+        }
+
+        // the handler runs without the lock, so workers can carry on
+        pthread_mutex_unlock(&state.lock);
+        dispatch_chunk(&state, c);
+        framecount += c->framecount;
+        pthread_mutex_lock(&state.lock);
+
+        ++state.dispatched;
+        pthread_cond_broadcast(&state.work_cond);
+    }
+    error = state.error;
+    pthread_cond_broadcast(&state.work_cond);
+    pthread_mutex_unlock(&state.lock);
+
+ out:
+    for (i = 0; i < started; ++i)
+        pthread_join(threads[i], NULL);
+
+    if (state.chunks) {
+        for (i = 0; i < state.n_chunks; ++i) {
+            free(state.chunks[i].frames);
+            free(state.chunks[i].data);
+            free(state.chunks[i].output);
+        }
+    }
+    free(state.chunks);
+    free(state.done_queue);
+    free(threads);
+    pthread_mutex_destroy(&state.lock);
+    pthread_cond_destroy(&state.work_cond);
+    pthread_cond_destroy(&state.done_cond);
+    munmap(map, st.st_size);
+
+    if (error) {
+        errno = error;
+        return -1;
+    }
+    return framecount;
+}
@@ -0,0 +1,742 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#define _GNU_SOURCE // for accept4
+
+// Reading frames from many sources on one thread.
+//
+// Sources are registered level-triggered with epoll. Each call to
+// dump978_reader_set_poll() does one read() of at most one buffer's
+// worth from each source that epoll reports ready, then parses and
+// dispatches the complete lines in it before moving on; a source with
+// more input stays ready and is read again next time. When more sources
+// are ready than fit in one epoll_wait(), the kernel moves the ones it
+// reported to the back of its ready list, so every source gets its turn.
+//
+// Regular files can't be registered with epoll (they are always
+// readable), so they are read on every call instead, and the call does
+// not wait while there are any.
+//
+// Each source has a small line buffer of its own, which only needs to
+// hold the longest valid line plus whatever was read after it; frames
+// are decoded into buffers shared by the whole set, as they are handed
+// to the handler before the next source is read.
+//
+// A UDP source receives up to UDP_BATCH datagrams per recvmmsg() call
+// into buffers of its own, and each datagram is parsed as a separate
+// buffer of complete lines. Loss is tracked per sender address in a
+// small open-addressed table; senders beyond its size are not tracked.
+// Each sender also has a bitmap of which of the last UDP_WINDOW sequence
+// numbers have arrived, to tell late frames (which were counted as lost)
+// from duplicates (which were not).
+//
+// A set with listeners keeps a spare descriptor open on /dev/null. When
+// accept() fails because the process (or system) is out of descriptors,
+// the spare is closed to accept the pending connection and close it
+// straight away, as otherwise it would stay pending and keep the
+// listener ready for ever. If even that fails, the listeners are taken
+// out of epoll until some source closes.
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "uat.h"
+#include "reader.h"
+#include "reader_simd.h"
+
+#define READER_SET_BUF_SIZE 8192
+#define READER_SET_MAX_BATCH 256
+#define READER_SET_MAX_EVENTS 64
+#define READER_SET_MAX_ACCEPTS 64   // per listener per poll
+
+#define UDP_BATCH 64                // datagrams per recvmmsg()
+#define UDP_MAX_DATAGRAM 4096       // longer datagrams are dropped
+#define UDP_MAX_SENDERS 256         // power of two
+#define UDP_RESYNC 65536            // sequence jumps treated as a sender restart
+#define UDP_WINDOW 256              // sequence numbers remembered per sender
+
+enum source_kind { SOURCE_STREAM, SOURCE_LISTENER, SOURCE_UDP };
+
+struct udp_sender {
+    struct sockaddr_storage addr;   // ss_family is 0 for an empty slot
+    socklen_t addrlen;
+    int have_seq;
+    uint32_t next_seq;
+    uint32_t missing;               // frames counted as lost that may yet arrive late
+    uint64_t seen[UDP_WINDOW / 64]; // bit seq % UDP_WINDOW, for next_seq - UDP_WINDOW <= seq < next_seq
+};
+
+struct udp_state {
+    struct mmsghdr msgs[UDP_BATCH];
+    struct iovec iov[UDP_BATCH];
+    struct sockaddr_storage addrs[UDP_BATCH];
+    char bufs[UDP_BATCH][UDP_MAX_DATAGRAM + 1];     // room to add a newline
+    struct udp_sender senders[UDP_MAX_SENDERS];
+};
+
+struct reader_source {
+    int id;
+    int fd;
+    enum source_kind kind;
+    int always_ready;           // not in epoll (a regular file)
+    int paused;                 // a listener out of epoll until a source closes
+    int next_free;              // once closed: the slot closed before it, or -1
+    int used;                   // bytes in buf
+    char *buf;                  // READER_SET_BUF_SIZE bytes while open
+    struct udp_state *udp;      // UDP sources only, while open
+    struct dump978_source_stats stats;
+};
+
+struct dump978_reader_set {
+    int epfd;
+    const struct reader_simd_impl *simd;
+    struct reader_source **sources;     // indexed by source id
+    int n_sources;                      // entries in sources
+    int max_sources;                    // entries allocated
+    int free_slot;                      // the last slot closed, or -1
+    int active;                         // sources that are open
+    int always_ready;                   // open sources with always_ready set
+    int paused;                         // nonzero if any listener is paused
+    int spare_fd;                       // see above; -1 if not open
+    struct dump978_frame batch[READER_SET_MAX_BATCH];
+    uint8_t frame_data[READER_SET_BUF_SIZE / 2];
+};
+
+struct dump978_reader_set *dump978_reader_set_new(void)
+{
+    struct dump978_reader_set *set = calloc(1, sizeof(*set));
+    if (!set)
+        return NULL;
+
+    set->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (set->epfd < 0) {
+        int save_errno = errno;
+        free(set);
+        errno = save_errno;
+        return NULL;
+    }
+
+    set->simd = reader_simd_select();
+    set->spare_fd = -1;
+    set->free_slot = -1;
+    return set;
+}
+
+// Put paused listeners back in epoll, once a descriptor has been freed
+static void resume_listeners(struct dump978_reader_set *set)
+{
+    struct epoll_event ev;
+    int i;
+
+    for (i = 0; i < set->n_sources; ++i) {
+        struct reader_source *src = set->sources[i];
+
+        if (src->paused && src->stats.open) {
+            memset(&ev, 0, sizeof(ev));
+            ev.events = EPOLLIN;
+            ev.data.u32 = i;
+            epoll_ctl(set->epfd, EPOLL_CTL_MOD, src->fd, &ev);
+        }
+        src->paused = 0;
+    }
+
+    set->paused = 0;
+    if (set->spare_fd < 0)
+        set->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+static void free_slot(struct dump978_reader_set *set, struct reader_source *src)
+{
+    src->next_free = set->free_slot;
+    set->free_slot = src->id;
+}
+
+static void close_source(struct dump978_reader_set *set, struct reader_source *src, int error)
+{
+    if (src->always_ready)
+        --set->always_ready;
+    else
+        epoll_ctl(set->epfd, EPOLL_CTL_DEL, src->fd, NULL);
+
+    close(src->fd);
+    free(src->buf);
+    free(src->udp);
+    src->buf = NULL;
+    src->udp = NULL;
+    src->stats.open = 0;
+    src->stats.error = error;
+    free_slot(set, src);
+    --set->active;
+
+    if (set->paused)
+        resume_listeners(set);
+}
+
+void dump978_reader_set_free(struct dump978_reader_set *set)
+{
+    int i;
+
+    if (!set)
+        return;
+
+    for (i = 0; i < set->n_sources; ++i) {
+        if (set->sources[i]->stats.open)
+            close_source(set, set->sources[i], 0);
+        free(set->sources[i]);
+    }
+
+    free(set->sources);
+    if (set->spare_fd >= 0)
+        close(set->spare_fd);
+    close(set->epfd);
+    free(set);
+}
+
+// Find a slot for a new source: the last one closed, or a new one.
+// The slot is cleared, apart from its id.
+static int allocate_slot(struct dump978_reader_set *set)
+{
+    struct reader_source *src;
+    int id = set->free_slot;
+
+    if (id >= 0) {
+        src = set->sources[id];
+        set->free_slot = src->next_free;
+    } else {
+        if (set->n_sources == set->max_sources) {
+            int max = set->max_sources ? set->max_sources * 2 : 16;
+            struct reader_source **sources = realloc(set->sources, max * sizeof(*sources));
+
+            if (!sources)
+                return -1;
+            set->sources = sources;
+            set->max_sources = max;
+        }
+
+        if (!(src = malloc(sizeof(*src))))
+            return -1;
+        id = set->n_sources++;
+        set->sources[id] = src;
+    }
+
+    memset(src, 0, sizeof(*src));
+    src->id = id;
+    return id;
+}
+
+static int add_source(struct dump978_reader_set *set, int fd, enum source_kind kind)
+{
+    struct reader_source *src;
+    struct epoll_event ev;
+    int flags, id, save_errno;
+
+    if (!set || fd < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        return -1;
+
+    if ((id = allocate_slot(set)) < 0)
+        return -1;
+    if (kind == SOURCE_LISTENER && set->spare_fd < 0)
+        set->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    src = set->sources[id];
+    src->fd = fd;
+    src->kind = kind;
+    if ((kind == SOURCE_STREAM && !(src->buf = malloc(READER_SET_BUF_SIZE))) ||
+        (kind == SOURCE_UDP && !(src->udp = calloc(1, sizeof(*src->udp)))))
+        goto fail;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = id;
+    if (epoll_ctl(set->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        if (errno != EPERM || kind != SOURCE_STREAM)
+            goto fail;
+
+        // a regular file
+        src->always_ready = 1;
+        ++set->always_ready;
+    }
+
+    src->stats.open = 1;
+    ++set->active;
+    return id;
+
+ fail:
+    save_errno = errno;
+    free(src->buf);
+    free(src->udp);
+    src->buf = NULL;
+    src->udp = NULL;
+    free_slot(set, src);
+    errno = save_errno;
+    return -1;
+}
+
+int dump978_reader_set_add(struct dump978_reader_set *set, int fd)
+{
+    return add_source(set, fd, SOURCE_STREAM);
+}
+
+int dump978_reader_set_add_listener(struct dump978_reader_set *set, int fd)
+{
+    return add_source(set, fd, SOURCE_LISTENER);
+}
+
+int dump978_reader_set_add_udp(struct dump978_reader_set *set, int fd)
+{
+    return add_source(set, fd, SOURCE_UDP);
+}
+
+// Connect to, or listen on, "[host:]port"; for UDP, bind to it
+static int open_inet(const char *address, int socktype, int listening)
+{
+    struct addrinfo hints, *result, *ai;
+    char host[256];
+    const char *port = strrchr(address, ':');
+    int fd = -1, gai, one = 1;
+
+    if (port) {
+        if ((size_t) (port - address) >= sizeof(host)) {
+            errno = EINVAL;
+            return -1;
+        }
+        memcpy(host, address, port - address);
+        host[port - address] = 0;
+        ++port;
+    } else if (listening) {
+        host[0] = 0;
+        port = address;
+    } else {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = socktype;
+    hints.ai_flags = (listening ? AI_PASSIVE : 0);
+    if ((gai = getaddrinfo(host[0] ? host : NULL, port, &hints, &result)) != 0) {
+        errno = (gai == EAI_SYSTEM ? errno : EHOSTUNREACH);
+        return -1;
+    }
+
+    for (ai = result; ai; ai = ai->ai_next) {
+        if ((fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol)) < 0)
+            continue;
+
+        if (listening && socktype == SOCK_DGRAM) {
+            // bursts from many senders shouldn't overflow the socket
+            int rcvbuf = 4 * 1024 * 1024;
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+            if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+                break;
+        } else if (listening) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0)
+                break;
+        } else if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(result);
+    return fd;
+}
+
+static int open_unix(const char *path, int listening)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        return -1;
+
+    if (listening ? (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0)
+                  : connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        int save_errno = errno;
+        close(fd);
+        errno = save_errno;
+        return -1;
+    }
+
+    return fd;
+}
+
+int dump978_reader_set_open(struct dump978_reader_set *set, const char *spec)
+{
+    enum source_kind kind = SOURCE_STREAM;
+    int fd, id;
+
+    if (!set || !spec) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (!strcmp(spec, "-")) {
+        fd = 0;
+    } else if (!strncmp(spec, "tcp:", 4)) {
+        fd = open_inet(spec + 4, SOCK_STREAM, 0);
+    } else if (!strncmp(spec, "listen:", 7)) {
+        fd = open_inet(spec + 7, SOCK_STREAM, 1);
+        kind = SOURCE_LISTENER;
+    } else if (!strncmp(spec, "udp:", 4)) {
+        fd = open_inet(spec + 4, SOCK_DGRAM, 1);
+        kind = SOURCE_UDP;
+    } else if (!strncmp(spec, "unix:", 5)) {
+        fd = open_unix(spec + 5, 0);
+    } else if (!strncmp(spec, "unix-listen:", 12)) {
+        fd = open_unix(spec + 12, 1);
+        kind = SOURCE_LISTENER;
+    } else {
+        // nonblocking, so that opening a FIFO doesn't wait for a writer
+        fd = open(spec, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    }
+
+    if (fd < 0)
+        return -1;
+
+    if ((id = add_source(set, fd, kind)) < 0) {
+        int save_errno = errno;
+        if (fd != 0)
+            close(fd);
+        errno = save_errno;
+    }
+
+    return id;
+}
+
+// Out of descriptors: use the spare one to accept a pending connection,
+// and close it. Returns 0 if a connection was refused, <0 with errno set
+// otherwise (EMFILE if there is no spare).
+static int refuse_connection(struct dump978_reader_set *set, struct reader_source *listener)
+{
+    int fd, save_errno;
+
+    if (set->spare_fd < 0) {
+        errno = EMFILE;
+        return -1;
+    }
+
+    close(set->spare_fd);
+    fd = accept4(listener->fd, NULL, NULL, SOCK_CLOEXEC);
+    save_errno = errno;
+    if (fd >= 0) {
+        close(fd);
+        ++listener->stats.refused;
+    }
+
+    set->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    errno = save_errno;
+    return fd < 0 ? -1 : 0;
+}
+
+// Stop polling a listener until a source closes (see resume_listeners())
+static void pause_listener(struct dump978_reader_set *set, int id)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.data.u32 = id;
+    if (epoll_ctl(set->epfd, EPOLL_CTL_MOD, set->sources[id]->fd, &ev) == 0) {
+        set->sources[id]->paused = 1;
+        set->paused = 1;
+    }
+}
+
+static void accept_connections(struct dump978_reader_set *set, int id)
+{
+    struct reader_source *listener = set->sources[id];
+    int i, fd;
+
+    for (i = 0; i < READER_SET_MAX_ACCEPTS; ++i) {
+        fd = accept4(listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0 && (errno == EMFILE || errno == ENFILE) && refuse_connection(set, listener) == 0)
+            continue;
+
+        if (fd < 0) {
+            if (errno == EMFILE || errno == ENFILE)
+                pause_listener(set, id);    // even the spare didn't help
+            else if (errno == EBADF || errno == EINVAL || errno == ENOTSOCK)
+                close_source(set, listener, errno);     // it would be ready for ever
+            return; // EAGAIN, or a connection that went away; try again next time
+        }
+
+        if (add_source(set, fd, SOURCE_STREAM) < 0)
+            close(fd);
+        else
+            ++listener->stats.accepted;
+    }
+}
+
+// Find (or add) the table entry for a sender; NULL if the table is full
+static struct udp_sender *find_sender(struct reader_source *src, const struct sockaddr_storage *addr, socklen_t addrlen)
+{
+    const unsigned char *p = (const unsigned char *) addr;
+    uint32_t hash = 2166136261u;
+    socklen_t i;
+    int probe;
+
+    for (i = 0; i < addrlen; ++i)
+        hash = (hash ^ p[i]) * 16777619u;
+
+    for (probe = 0; probe < UDP_MAX_SENDERS; ++probe) {
+        struct udp_sender *sender = &src->udp->senders[(hash + probe) & (UDP_MAX_SENDERS - 1)];
+
+        if (sender->addr.ss_family == 0) {
+            memcpy(&sender->addr, addr, addrlen);
+            sender->addrlen = addrlen;
+            ++src->stats.senders;
+            return sender;
+        }
+        if (sender->addrlen == addrlen && !memcmp(&sender->addr, addr, addrlen))
+            return sender;
+    }
+
+    return NULL;
+}
+
+// Check a frame's sequence number against what its sender sent last
+static void check_sequence(struct reader_source *src, struct udp_sender *sender, const struct dump978_frame *frame)
+{
+    struct dump978_metadata meta;
+    int32_t gap;
+
+    if (!sender || frame->metadata_len < 5)
+        return;
+    dump978_parse_metadata(frame->metadata, frame->metadata_len, &meta);
+    if (!(meta.present & DUMP978_META_SEQ))
+        return;
+
+    gap = (int32_t) (meta.seq - sender->next_seq);
+    if (sender->have_seq && gap < 0 && gap > -UDP_RESYNC) {
+        uint64_t bit = (uint64_t) 1 << (meta.seq % 64);
+        uint64_t *word = &sender->seen[meta.seq % UDP_WINDOW / 64];
+
+        if (gap < -UDP_WINDOW) {
+            // too old to tell from a duplicate; leave it counted as lost
+            ++src->stats.late;
+        } else if (*word & bit) {
+            ++src->stats.duplicates;
+        } else {
+            // it was counted as lost when the frames after it arrived
+            *word |= bit;
+            ++src->stats.late;
+            if (sender->missing) {
+                --sender->missing;
+                --src->stats.lost;
+            }
+        }
+        return;
+    }
+
+    if (sender->have_seq && gap > 0 && gap < UDP_RESYNC) {
+        src->stats.lost += gap;
+        sender->missing += gap;
+    } else {
+        sender->missing = 0;
+    }
+
+    // forget the sequence numbers that drop out of the window
+    if (!sender->have_seq || gap < 0 || gap >= UDP_WINDOW) {
+        memset(sender->seen, 0, sizeof(sender->seen));
+    } else {
+        uint32_t seq;
+        for (seq = sender->next_seq; seq != meta.seq; ++seq)
+            sender->seen[seq % UDP_WINDOW / 64] &= ~((uint64_t) 1 << (seq % 64));
+    }
+    sender->seen[meta.seq % UDP_WINDOW / 64] |= (uint64_t) 1 << (meta.seq % 64);
+
+    sender->have_seq = 1;
+    sender->next_seq = meta.seq + 1;
+}
+
+// Receive a batch of datagrams, and dispatch the frames in them.
+// Returns the number of frames dispatched.
+static int read_udp(struct dump978_reader_set *set, int id,
+                    source_frame_handler_t handler, void *handler_data)
+{
+    struct reader_source *src = set->sources[id];
+    struct udp_state *udp = src->udp;
+    int framecount = 0, received, i, j;
+
+    for (i = 0; i < UDP_BATCH; ++i) {
+        udp->iov[i].iov_base = udp->bufs[i];
+        udp->iov[i].iov_len = UDP_MAX_DATAGRAM;
+        memset(&udp->msgs[i].msg_hdr, 0, sizeof(udp->msgs[i].msg_hdr));
+        udp->msgs[i].msg_hdr.msg_iov = &udp->iov[i];
+        udp->msgs[i].msg_hdr.msg_iovlen = 1;
+        udp->msgs[i].msg_hdr.msg_name = &udp->addrs[i];
+        udp->msgs[i].msg_hdr.msg_namelen = sizeof(udp->addrs[i]);
+    }
+
+    received = recvmmsg(src->fd, udp->msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+    if (received < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            close_source(set, src, errno);
+        return 0;
+    }
+
+    for (i = 0; i < received; ++i) {
+        struct msghdr *hdr = &udp->msgs[i].msg_hdr;
+        struct udp_sender *sender;
+        char *buf = udp->bufs[i];
+        int len = udp->msgs[i].msg_len;
+        int parsed = 0, n;
+
+        ++src->stats.datagrams;
+        src->stats.bytes += len;
+        if (hdr->msg_flags & MSG_TRUNC)
+            continue;
+
+        if (len > 0 && buf[len - 1] != '\n')
+            buf[len++] = '\n';
+
+        sender = find_sender(src, &udp->addrs[i], hdr->msg_namelen);
+        do {
+            n = reader_parse_lines(set->simd, buf, len, &parsed,
+                                   set->frame_data, set->batch, READER_SET_MAX_BATCH);
+            for (j = 0; j < n; ++j) {
+                check_sequence(src, sender, &set->batch[j]);
+                handler(id, &set->batch[j], handler_data);
+            }
+            framecount += n;
+        } while (n == READER_SET_MAX_BATCH);
+    }
+
+    src->stats.frames += framecount;
+    return framecount;
+}
+
+// Do one read from a source, and dispatch the complete frames in its
+// buffer. Returns the number of frames dispatched.
+static int read_source(struct dump978_reader_set *set, int id,
+                       source_frame_handler_t handler, void *handler_data)
+{
+    struct reader_source *src = set->sources[id];
+    ssize_t bytes_read;
+    int parsed = 0, framecount = 0, n, i;
+
+    if (src->kind == SOURCE_LISTENER) {
+        accept_connections(set, id);
+        return 0;
+    }
+    if (src->kind == SOURCE_UDP)
+        return read_udp(set, id, handler, handler_data);
+
+    bytes_read = read(src->fd, src->buf + src->used, READER_SET_BUF_SIZE - src->used);
+    if (bytes_read == 0) {
+        close_source(set, src, 0);
+        return 0;
+    }
+    if (bytes_read < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            close_source(set, src, errno);
+        return 0;
+    }
+
+    src->used += bytes_read;
+    src->stats.bytes += bytes_read;
+
+    do {
+        n = reader_parse_lines(set->simd, src->buf, src->used, &parsed,
+                               set->frame_data, set->batch, READER_SET_MAX_BATCH);
+        for (i = 0; i < n; ++i)
+            handler(id, &set->batch[i], handler_data);
+        framecount += n;
+    } while (n == READER_SET_MAX_BATCH);
+
+    src->used -= parsed;
+    memmove(src->buf, src->buf + parsed, src->used);
+    if (src->used == READER_SET_BUF_SIZE) {
+        // line too long, ditch input
+        src->used = 0;
+    }
+
+    src->stats.frames += framecount;
+    return framecount;
+}
+
+int dump978_reader_set_poll(struct dump978_reader_set *set, int timeout_ms,
+                            source_frame_handler_t handler,
+                            void *handler_data)
+{
+    struct epoll_event events[READER_SET_MAX_EVENTS];
+    int framecount = 0, n, i;
+
+    if (!set || !handler) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (set->active == 0)
+        return 0;
+
+    n = epoll_wait(set->epfd, events, READER_SET_MAX_EVENTS, set->always_ready ? 0 : timeout_ms);
+    if (n < 0)
+        return -1;
+
+    for (i = 0; i < n; ++i) {
+        int id = events[i].data.u32;
+        if (set->sources[id]->stats.open)
+            framecount += read_source(set, id, handler, handler_data);
+    }
+
+    if (set->always_ready) {
+        for (i = 0; i < set->n_sources; ++i) {
+            if (set->sources[i]->stats.open && set->sources[i]->always_ready)
+                framecount += read_source(set, i, handler, handler_data);
+        }
+    }
+
+    return framecount;
+}
+
+int dump978_reader_set_active(struct dump978_reader_set *set)
+{
+    return set ? set->active : 0;
+}
+
+const struct dump978_source_stats *dump978_reader_set_stats(struct dump978_reader_set *set, int source)
+{
+    if (!set || source < 0 || source >= set->n_sources)
+        return NULL;
+    return &set->sources[source]->stats;
+}
@@ -0,0 +1,226 @@
+//
+// Copyright 2015, Oliver Jowett <oliver@mutability.co.uk>
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Hex decoding and line scanning for reader.c.
+//
+// The SIMD versions classify 16 (SSE2) or 32 (AVX2) characters at once:
+// c - '0' is a digit if it is at most 9 as an unsigned byte, and
+// (c | 0x20) - 'a' is a letter if it is at most 5, which folds 'A'..'F'
+// onto 'a'..'f' without admitting anything else. The selected nibble
+// values are then paired up within 16-bit lanes (high nibble in the low
+// byte, as the characters appear) and packed down to bytes. Validity is
+// accumulated over the whole frame and checked once at the end.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "reader_simd.h"
+
+static int always_supported(void)
+{
+    return 1;
+}
+
+static int hexbyte(const char *buf)
+{
+    int i;
+    char c;
+
+    c = buf[0];
+    if (c >= '0' && c <= '9')
+        i = (c - '0');
+    else if (c >= 'a' && c <= 'f')
+        i = (c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+        i = (c - 'A' + 10);
+    else
+        return -1;
+
+    i <<= 4;
+    c = buf[1];
+    if (c >= '0' && c <= '9')
+        return i | (c - '0');
+    else if (c >= 'a' && c <= 'f')
+        return i | (c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+        return i | (c - 'A' + 10);
+    else
+        return -1;
+}
+
+static int hex_decode_scalar(const char *hex, int n, uint8_t *out)
+{
+    for (; n > 0; n -= 2, hex += 2) {
+        int byte = hexbyte(hex);
+        if (byte < 0)
+            return 0;
+        *out++ = byte;
+    }
+
+    return 1;
+}
+
+static const char *find_delim_scalar(const char *p, const char *end)
+{
+    const char *newline = memchr(p, '\n', end - p);
+    const char *semicolon = memchr(p, ';', (newline ? newline : end) - p);
+
+    return (semicolon ? semicolon : newline);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#define HAVE_X86_SIMD
+
+// Convert 16 hex digits to 8 bytes; returns a mask with 0xFF in each
+// byte that held a valid hex digit
+__attribute__((target("sse2")))
+static inline __m128i hex_decode_16_sse2(const char *hex, uint8_t *out)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *) hex);
+    __m128i d = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    __m128i l = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+    __m128i nibbles = _mm_or_si128(_mm_and_si128(is_digit, d),
+                                   _mm_and_si128(is_letter, _mm_add_epi8(l, _mm_set1_epi8(10))));
+    __m128i words = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4),
+                                 _mm_srli_epi16(nibbles, 8));
+
+    _mm_storel_epi64((__m128i *) out, _mm_packus_epi16(words, words));
+    return _mm_or_si128(is_digit, is_letter);
+}
+
+__attribute__((target("sse2")))
+static int hex_decode_sse2(const char *hex, int n, uint8_t *out)
+{
+    __m128i valid = _mm_set1_epi8(-1);
+
+    for (; n >= 16; n -= 16, hex += 16, out += 8)
+        valid = _mm_and_si128(valid, hex_decode_16_sse2(hex, out));
+
+    if (_mm_movemask_epi8(valid) != 0xFFFF)
+        return 0;
+    return hex_decode_scalar(hex, n, out);
+}
+
+__attribute__((target("sse2")))
+static const char *find_delim_sse2(const char *p, const char *end)
+{
+    const __m128i semicolon = _mm_set1_epi8(';');
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *) p);
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, semicolon), _mm_cmpeq_epi8(v, newline)));
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+
+    return find_delim_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static int hex_decode_avx2(const char *hex, int n, uint8_t *out)
+{
+    __m256i valid = _mm256_set1_epi8(-1);
+    __m128i valid16 = _mm_set1_epi8(-1);
+
+    for (; n >= 32; n -= 32, hex += 32, out += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) hex);
+        __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+        __m256i l = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+        __m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+        __m256i nibbles = _mm256_or_si256(_mm256_and_si256(is_digit, d),
+                                          _mm256_and_si256(is_letter, _mm256_add_epi8(l, _mm256_set1_epi8(10))));
+        // high nibble * 16 + low nibble, for each pair of characters
+        __m256i words = _mm256_maddubs_epi16(nibbles, _mm256_set1_epi16(0x0110));
+        // packing works within 128-bit lanes; gather the two results
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0x08);
+
+        _mm_storeu_si128((__m128i *) out, _mm256_castsi256_si128(packed));
+        valid = _mm256_and_si256(valid, _mm256_or_si256(is_digit, is_letter));
+    }
+
+    if (n >= 16) {
+        valid16 = hex_decode_16_sse2(hex, out);
+        n -= 16;
+        hex += 16;
+        out += 8;
+    }
+
+    if ((unsigned) _mm256_movemask_epi8(valid) != 0xFFFFFFFF || _mm_movemask_epi8(valid16) != 0xFFFF)
+        return 0;
+    return hex_decode_scalar(hex, n, out);
+}
+
+__attribute__((target("avx2")))
+static const char *find_delim_avx2(const char *p, const char *end)
+{
+    const __m256i semicolon = _mm256_set1_epi8(';');
+    const __m256i newline = _mm256_set1_epi8('\n');
+
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *) p);
+        unsigned mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, semicolon),
+                                                             _mm256_cmpeq_epi8(v, newline)));
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+
+    return find_delim_sse2(p, end);
+}
+
+static int sse2_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+static int avx2_supported(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif /* x86 */
+
+const struct reader_simd_impl reader_simd_impls[] = {
+#ifdef HAVE_X86_SIMD
+    { "avx2", hex_decode_avx2, find_delim_avx2, avx2_supported },
+    { "sse2", hex_decode_sse2, find_delim_sse2, sse2_supported },
+#endif
+    { "scalar", hex_decode_scalar, find_delim_scalar, always_supported },
+    { NULL, NULL, NULL, NULL }
+};
+
+const struct reader_simd_impl *reader_simd_select(void)
+{
+    const struct reader_simd_impl *impl;
+
+    for (impl = reader_simd_impls; impl->name; ++impl) {
+        if (impl->supported())
+            return impl;
+    }
+
+    // not reached, scalar is always supported
+    return NULL;
+}
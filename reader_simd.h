@@ -0,0 +1,65 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DUMP978_READER_SIMD_H
+#define DUMP978_READER_SIMD_H
+
+#include <stdint.h>
+
+struct dump978_reader;
+struct dump978_frame;
+
+/* Convert 'n' hex digits (upper or lower case) at 'hex' to n/2 bytes at
+ * 'out'. 'n' must be even.
+ * Returns 1 on success, or 0 if any of the characters is not a hex digit,
+ * in which case the contents of 'out' are unspecified.
+ */
+typedef int (*hex_decode_fn)(const char *hex, int n, uint8_t *out);
+
+/* Return a pointer to the first ';' or '\n' in [p, end), or NULL if
+ * there is none. */
+typedef const char *(*find_delim_fn)(const char *p, const char *end);
+
+/* One implementation of the above */
+struct reader_simd_impl {
+    const char *name;
+    hex_decode_fn hex_decode;
+    find_delim_fn find_delim;
+    int (*supported)(void);                 /* nonzero if usable on this CPU */
+};
+
+/* All implementations, fastest first, terminated by an entry with a NULL
+ * name. The last real entry is the portable scalar version, which is
+ * always supported. */
+extern const struct reader_simd_impl reader_simd_impls[];
+
+/* Return the fastest implementation supported by this CPU. */
+const struct reader_simd_impl *reader_simd_select(void);
+
+/* Make 'reader' use 'impl' rather than the one reader_simd_select()
+ * picked, for testing and benchmarking. */
+void dump978_reader_use_simd(struct dump978_reader *reader, const struct reader_simd_impl *impl);
+
+/* Parse the complete lines in buf[*parsed, used) into 'batch', decoding
+ * frame data to 'out' (which needs room for half as many bytes as are
+ * parsed), until 'max_frames' frames are found. Advances *parsed past
+ * the lines consumed, including rejected ones, and returns the number
+ * of frames found. Shared by reader.c and reader_set.c. */
+int reader_parse_lines(const struct reader_simd_impl *simd, char *buf, int used, int *parsed,
+                       uint8_t *out, struct dump978_frame *batch, int max_frames);
+
+#endif
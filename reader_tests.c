@@ -0,0 +1,1098 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Tests for the message reader, the reader set and the parallel file
+// reader.
+//
+// Every hex decoding / line scanning implementation in reader_simd.c
+// must behave exactly like the scalar one, on random strings and on a
+// set of malformed and oversized lines. Metadata fields must be parsed,
+// or ignored when malformed, as documented.
+//
+// The same messages are fed to a reader set through pipes, Unix and TCP
+// sockets and a regular file in random sized pieces, and every source
+// must see exactly the frames a single reader sees; a source with a
+// large backlog must not hold up the others; and a set with thousands
+// of connections is timed.
+//
+// UDP datagrams from several senders, some with frames deliberately
+// dropped or reordered, must give the right frames and loss counts.
+//
+// The parallel reader must produce the same frames (or, with a parallel
+// handler, the same output) as a single reader, with any number of
+// threads and chunk size, in file order or (in some order) unordered.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "reader.h"
+#include "reader_simd.h"
+#include "uat_decode.h"
+
+#define TEST_PIPES 16
+#define TEST_UNIX 16
+#define TEST_TCP 8
+#define TEST_WRITERS (TEST_PIPES + TEST_UNIX + TEST_TCP)
+#define TEST_MAX_SOURCES 4096
+
+#define FAIR_SOURCES 200
+#define SCALE_SOURCES 2000
+#define SCALE_BYTES 16384
+
+static char *input;
+static size_t input_len;
+
+struct frame_log {
+    int frames;
+    uint32_t hash;
+};
+
+static struct frame_log logs[TEST_MAX_SOURCES];
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void log_frame(struct frame_log *log, frame_type_t t, const uint8_t *f, int l)
+{
+    int i;
+
+    ++log->frames;
+    log->hash = log->hash * 31 + t;
+    log->hash = log->hash * 31 + l;
+    for (i = 0; i < l; ++i)
+        log->hash = log->hash * 31 + f[i];
+}
+
+static void reader_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    log_frame(d, t, f, l);
+}
+
+static void source_frame(int source, const struct dump978_frame *frame, void *d)
+{
+    if (source < TEST_MAX_SOURCES)
+        log_frame(&logs[source], frame->type, frame->data, frame->len);
+}
+
+static int load_input(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    size_t size = 0;
+    size_t n;
+
+    if (!f) {
+        perror(path);
+        return 0;
+    }
+
+    for (;;) {
+        if (input_len == size) {
+            size = (size ? size * 2 : 65536);
+            input = realloc(input, size);
+        }
+        if ((n = fread(input + input_len, 1, size - input_len, f)) == 0)
+            break;
+        input_len += n;
+    }
+
+    fclose(f);
+    return (input_len > 0);
+}
+
+// What a single reader makes of 'len' bytes of the input
+static struct frame_log reference_log(size_t len)
+{
+    struct frame_log log = { 0, 0 };
+    struct dump978_reader *reader;
+    FILE *f = tmpfile();
+
+    fwrite(input, 1, len, f);
+    fflush(f);
+    rewind(f);
+    reader = dump978_reader_new(fileno(f), 0);
+    while (dump978_read_frames(reader, reader_frame, &log) > 0)
+        ;
+    dump978_reader_free(reader);
+    fclose(f);
+    return log;
+}
+
+static uint32_t test_rng = 1;
+
+// xorshift32, so the random tests are repeatable
+static uint32_t random_u32(void)
+{
+    test_rng ^= test_rng << 13;
+    test_rng ^= test_rng >> 17;
+    test_rng ^= test_rng << 5;
+    return test_rng;
+}
+
+// Mostly hex digits, sometimes something that isn't
+static char random_char(int hex_only)
+{
+    static const char hex[] = "0123456789abcdefABCDEF";
+    static const char other[] = ";\n/:@G`g \x80\xff";
+
+    if (hex_only || random_u32() % 64)
+        return hex[random_u32() % (sizeof(hex) - 1)];
+    return other[random_u32() % (sizeof(other) - 1)];
+}
+
+// Compare each implementation's functions against the scalar ones
+static int test_simd_functions(const struct reader_simd_impl *ref)
+{
+    const struct reader_simd_impl *impl;
+    int ok = 1;
+
+    for (impl = reader_simd_impls; impl->name; ++impl) {
+        char buf[1200];
+        int i;
+
+        if (impl == ref || !impl->supported())
+            continue;
+
+        fprintf(stderr, "hex decoding (%s): ", impl->name);
+        for (i = 0; ok && i < 100000; ++i) {
+            uint8_t out[600], ref_out[600];
+            int n = random_u32() % sizeof(buf);
+            int hex_only = random_u32() % 2;
+            int j, result, ref_result;
+
+            for (j = 0; j < n; ++j)
+                buf[j] = random_char(hex_only);
+
+            result = impl->hex_decode(buf, n & ~1, out);
+            ref_result = ref->hex_decode(buf, n & ~1, ref_out);
+            if (result != ref_result || (result && memcmp(out, ref_out, n / 2) != 0)) {
+                fprintf(stderr, "FAIL: hex_decode differs on %d characters\n", n & ~1);
+                ok = 0;
+            } else if (impl->find_delim(buf, buf + n) != ref->find_delim(buf, buf + n)) {
+                fprintf(stderr, "FAIL: find_delim differs on %d characters\n", n);
+                ok = 0;
+            }
+        }
+
+        if (ok)
+            fprintf(stderr, "PASS\n");
+    }
+
+    return ok;
+}
+
+// What a single reader using 'impl' makes of 'len' bytes of 'data'
+static struct frame_log read_with_simd(const char *data, size_t len, const struct reader_simd_impl *impl)
+{
+    struct frame_log log = { 0, 0 };
+    struct dump978_reader *reader;
+    FILE *f = tmpfile();
+
+    fwrite(data, 1, len, f);
+    fflush(f);
+    rewind(f);
+    reader = dump978_reader_new(fileno(f), 0);
+    dump978_reader_use_simd(reader, impl);
+    while (dump978_read_frames(reader, reader_frame, &log) > 0)
+        ;
+    dump978_reader_free(reader);
+    fclose(f);
+    return log;
+}
+
+// Lines that must be rejected or accepted as the original parser did
+static int test_lines(void)
+{
+    static const struct {
+        const char *line;
+        int accepted;
+    } tests[] = {
+        { "-00a66ef135445d525a0c0519119021204800;", 1 },
+        { "-00A66EF135445D525A0C0519119021204800;rs=3;", 1 },
+        { "-00a66ef135445d525a0c051911902120480;", 0 },        // odd number of digits
+        { "-00a66ef135445d525a0c0519119021204g00;", 0 },       // bad digit
+        { "-00a66ef135445d525a0c0519119021204800", 0 },        // no semicolon
+        { "+;", 1 },                                            // empty frame
+        { "x00a66ef135445d525a0c0519119021204800;", 0 },       // not a frame
+        { "-00a66ef135445d525a0c0519119021204800;\x80\xff;", 1 }, // metadata is not checked
+        { NULL, 0 }
+    };
+    char big[2 * UPLINK_FRAME_DATA_BYTES + 16];
+    const struct reader_simd_impl *impl;
+    char *data = NULL;
+    size_t len = 0;
+    FILE *mem = open_memstream(&data, &len);
+    int i, expected = 0, ok = 1;
+
+    for (i = 0; tests[i].line; ++i) {
+        fprintf(mem, "%s\n", tests[i].line);
+        expected += tests[i].accepted;
+    }
+
+    // largest possible frame, and one byte more
+    memset(big, '5', sizeof(big));
+    big[0] = '+';
+    big[1 + 2 * UPLINK_FRAME_DATA_BYTES] = ';';
+    big[2 + 2 * UPLINK_FRAME_DATA_BYTES] = 0;
+    fprintf(mem, "%s\n", big);
+    ++expected;
+    big[1 + 2 * UPLINK_FRAME_DATA_BYTES] = '5';
+    big[3 + 2 * UPLINK_FRAME_DATA_BYTES] = ';';
+    big[4 + 2 * UPLINK_FRAME_DATA_BYTES] = 0;
+    fprintf(mem, "%s\n", big);
+    fclose(mem);
+
+    for (impl = reader_simd_impls; impl->name; ++impl) {
+        struct frame_log log;
+
+        if (!impl->supported())
+            continue;
+
+        fprintf(stderr, "malformed lines (%s): ", impl->name);
+        log = read_with_simd(data, len, impl);
+
+        if (log.frames != expected) {
+            fprintf(stderr, "FAIL: %d frames accepted, expected %d\n", log.frames, expected);
+            ok = 0;
+        } else {
+            fprintf(stderr, "PASS\n");
+        }
+    }
+
+    free(data);
+    return ok;
+}
+
+struct meta_log {
+    int frames;
+    int rs;
+    int fields;
+};
+
+static void log_meta(frame_type_t t, uint8_t *f, int l, const struct dump978_metadata *m, void *d)
+{
+    struct meta_log *log = d;
+
+    ++log->frames;
+    log->rs += m->rs;
+    log->fields += __builtin_popcount(m->present);
+}
+
+// Metadata fields, valid and otherwise
+static int test_metadata(void)
+{
+    static const struct {
+        const char *text;
+        int found;
+        unsigned present;
+        int rs;
+        double timestamp;
+        double rssi;
+        const char *receiver_id;
+        uint32_t seq;
+    } tests[] = {
+        { "", 0, 0, 0, 0, 0, "" },
+        { "rs=3;", 1, DUMP978_META_RS, 3, 0, 0, "" },
+        { "rs=3", 1, DUMP978_META_RS, 3, 0, 0, "" },      // unterminated last field
+        { "t=1433073412.125;rssi=-12.5;rx=site-1;", 3,
+          DUMP978_META_TIMESTAMP | DUMP978_META_RSSI | DUMP978_META_RECEIVER, 0, 1433073412.125, -12.5, "site-1" },
+        { "rs=1;rs=7;", 1, DUMP978_META_RS, 7, 0, 0, "" }, // last one wins
+        { "foo=bar;;=;rs;rs=;x", 0, 0, 0, 0, 0, "" },     // unknown or empty
+        { "rs=3x;rs= 3;rs=+3;rs=99999999999;", 0, 0, 0, 0, 0, "" },
+        { "rssi=nan;rssi=inf;rssi=1e999;rssi=-;t=.;", 0, 0, 0, 0, 0, "" },
+        { "rx=0123456789abcde;", 1, DUMP978_META_RECEIVER, 0, 0, 0, "0123456789abcde" },
+        { "rx=0123456789abcdef;", 0, 0, 0, 0, 0, "" },    // too long
+        { "rssi=-000000000000000000000000000001.5;", 0, 0, 0, 0, 0, "" }, // value too long
+        { "RS=3;rs=3=4;\x80\xff;rs=2", 1, DUMP978_META_RS, 2, 0, 0, "" },
+        { "seq=4294967295;", 1, DUMP978_META_SEQ, 0, 0, 0, "", 4294967295u },
+        { "seq=4294967296;seq=-1;seq=+1;", 0, 0, 0, 0, 0, "" },
+        { NULL, 0, 0, 0, 0, 0, NULL }
+    };
+    struct dump978_metadata meta;
+    int i, ok = 1;
+
+    fprintf(stderr, "metadata parsing: ");
+    for (i = 0; tests[i].text; ++i) {
+        int found = dump978_parse_metadata(tests[i].text, strlen(tests[i].text), &meta);
+        if (found != tests[i].found || meta.present != tests[i].present || meta.rs != tests[i].rs ||
+            meta.timestamp != tests[i].timestamp || meta.rssi != tests[i].rssi ||
+            strcmp(meta.receiver_id, tests[i].receiver_id) != 0 || meta.seq != tests[i].seq) {
+            if (ok)
+                fprintf(stderr, "FAIL:\n");
+            fprintf(stderr, "  \"%s\": found %d, present %x, rs %d, t %f, rssi %f, rx \"%s\"\n",
+                    tests[i].text, found, meta.present, meta.rs, meta.timestamp, meta.rssi, meta.receiver_id);
+            ok = 0;
+        }
+    }
+
+    // and through dump978_read_frames_ext()
+    if (ok) {
+        static const char lines[] =
+            "-00a66ef135445d525a0c0519119021204800;\n"
+            "-00a66ef135445d525a0c0519119021204800;rs=2;rssi=-3.5;\n"
+            "+;rx=abc;rs=4\n";
+        struct dump978_reader *reader;
+        struct meta_log log = { 0, 0, 0 };
+        FILE *f = tmpfile();
+
+        fwrite(lines, 1, sizeof(lines) - 1, f);
+        fflush(f);
+        rewind(f);
+        reader = dump978_reader_new(fileno(f), 0);
+        while (dump978_read_frames_ext(reader, log_meta, &log) > 0)
+            ;
+        dump978_reader_free(reader);
+        fclose(f);
+
+        if (log.frames != 3 || log.rs != 6 || log.fields != 4) {
+            fprintf(stderr, "FAIL: dump978_read_frames_ext saw %d frames, rs total %d, %d fields\n",
+                    log.frames, log.rs, log.fields);
+            ok = 0;
+        }
+    }
+
+    if (ok)
+        fprintf(stderr, "PASS\n");
+    return ok;
+}
+
+static int tcp_listener(struct sockaddr_in *addr)
+{
+    socklen_t addrlen = sizeof(*addr);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || bind(fd, (struct sockaddr *) addr, sizeof(*addr)) < 0 || listen(fd, 64) < 0 ||
+        getsockname(fd, (struct sockaddr *) addr, &addrlen) < 0) {
+        perror("tcp listener");
+        exit(1);
+    }
+    return fd;
+}
+
+static void make_nonblocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+// Every kind of source at once, written in random pieces
+static int test_sources(const struct frame_log *ref)
+{
+    struct dump978_reader_set *set = dump978_reader_set_new();
+    struct sockaddr_in addr;
+    int writers[TEST_WRITERS];
+    size_t written[TEST_WRITERS];
+    uint32_t rng = 1;
+    FILE *file;
+    int listener_id, file_id, fds[2];
+    int i, open_writers, matched = 0, polls = 0, ok = 1;
+
+    memset(logs, 0, sizeof(logs));
+    fprintf(stderr, "reader set, %d pipes, %d Unix sockets, %d TCP connections and a file: ",
+            TEST_PIPES, TEST_UNIX, TEST_TCP);
+
+    for (i = 0; i < TEST_PIPES + TEST_UNIX; ++i) {
+        if ((i < TEST_PIPES ? pipe(fds) : socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) < 0) {
+            perror("pipe/socketpair");
+            return 0;
+        }
+        // socketpair ends are interchangeable; pipes read from fds[0]
+        writers[i] = fds[1];
+        dump978_reader_set_add(set, fds[0]);
+    }
+
+    listener_id = dump978_reader_set_add_listener(set, tcp_listener(&addr));
+    for (i = TEST_PIPES + TEST_UNIX; i < TEST_WRITERS; ++i) {
+        writers[i] = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(writers[i], (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+            perror("connect");
+            return 0;
+        }
+    }
+
+    // accept everything before any source can close and free its id
+    while (dump978_reader_set_stats(set, listener_id)->accepted < TEST_TCP && polls++ < 1000)
+        dump978_reader_set_poll(set, 10, source_frame, NULL);
+
+    file = tmpfile();
+    fwrite(input, 1, input_len, file);
+    fflush(file);
+    rewind(file);
+    file_id = dump978_reader_set_add(set, dup(fileno(file)));
+    fclose(file);
+
+    for (i = 0; i < TEST_WRITERS; ++i) {
+        make_nonblocking(writers[i]);
+        written[i] = 0;
+    }
+
+    open_writers = TEST_WRITERS;
+    for (polls = 0; dump978_reader_set_active(set) > 1 && polls < 1000000; ++polls) {
+        for (i = 0; i < TEST_WRITERS; ++i) {
+            size_t n;
+            ssize_t w;
+
+            if (writers[i] < 0)
+                continue;
+
+            rng = rng * 1103515245 + 12345;
+            n = 1 + (rng >> 8) % 5000;
+            if (n > input_len - written[i])
+                n = input_len - written[i];
+            if ((w = write(writers[i], input + written[i], n)) > 0)
+                written[i] += w;
+
+            if (written[i] == input_len) {
+                close(writers[i]);
+                writers[i] = -1;
+                --open_writers;
+            }
+        }
+
+        if (dump978_reader_set_poll(set, open_writers ? 0 : 100, source_frame, NULL) < 0 && errno != EINTR) {
+            perror("dump978_reader_set_poll");
+            ok = 0;
+            break;
+        }
+    }
+
+    for (i = 0; i < TEST_MAX_SOURCES; ++i) {
+        const struct dump978_source_stats *stats = dump978_reader_set_stats(set, i);
+
+        if (!stats || i == listener_id)
+            continue;
+        if (logs[i].frames != ref->frames || logs[i].hash != ref->hash ||
+            stats->frames != (uint64_t) ref->frames || stats->bytes != input_len ||
+            stats->open || stats->error) {
+            fprintf(stderr, "%ssource %d: %d frames (stats %llu, %llu bytes), expected %d%s\n",
+                    ok ? "FAIL:\n  " : "  ", i, logs[i].frames, (unsigned long long) stats->frames,
+                    (unsigned long long) stats->bytes, ref->frames,
+                    logs[i].hash != ref->hash ? ", contents differ" : "");
+            ok = 0;
+        } else {
+            ++matched;
+        }
+    }
+
+    if (ok && matched != TEST_WRITERS + 1) {
+        fprintf(stderr, "FAIL: %d sources complete, expected %d\n", matched, TEST_WRITERS + 1);
+        ok = 0;
+    }
+    if (ok && dump978_reader_set_stats(set, file_id)->frames != (uint64_t) ref->frames) {
+        fprintf(stderr, "FAIL: file source incomplete\n");
+        ok = 0;
+    }
+
+    if (ok)
+        fprintf(stderr, "PASS\n");
+    dump978_reader_set_free(set);
+    return ok;
+}
+
+// Connections that arrive when the process is out of descriptors are
+// closed instead of being left pending (with the listener ready for
+// ever), and connections are accepted again once there is room
+static int test_refused(void)
+{
+    struct dump978_reader_set *set = dump978_reader_set_new();
+    const struct dump978_source_stats *stats;
+    struct sockaddr_in addr;
+    struct rlimit rl, saved;
+    int clients[TEST_TCP + 1];
+    char c;
+    int listener_id, fd, i, ok = 1;
+
+    fprintf(stderr, "reader set, %d connections with no descriptors left: ", TEST_TCP);
+
+    listener_id = dump978_reader_set_add_listener(set, tcp_listener(&addr));
+    for (i = 0; i < TEST_TCP + 1; ++i) {
+        clients[i] = socket(AF_INET, SOCK_STREAM, 0);
+        if (i < TEST_TCP && connect(clients[i], (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+            perror("connect");
+            return 0;
+        }
+    }
+
+    // the lowest free descriptor is the first one over the limit
+    if ((fd = open("/dev/null", O_RDONLY)) < 0 || getrlimit(RLIMIT_NOFILE, &saved) < 0) {
+        perror("open/getrlimit");
+        return 0;
+    }
+    close(fd);
+    rl = saved;
+    rl.rlim_cur = fd;
+    setrlimit(RLIMIT_NOFILE, &rl);
+
+    for (i = 0; i < 10; ++i)
+        dump978_reader_set_poll(set, 10, source_frame, NULL);
+    stats = dump978_reader_set_stats(set, listener_id);
+    if (stats->refused != TEST_TCP || stats->accepted != 0) {
+        fprintf(stderr, "FAIL: %llu refused, %llu accepted, expected %d and 0\n",
+                (unsigned long long) stats->refused, (unsigned long long) stats->accepted, TEST_TCP);
+        ok = 0;
+    }
+    for (i = 0; ok && i < TEST_TCP; ++i) {
+        if (read(clients[i], &c, 1) > 0) {
+            fprintf(stderr, "FAIL: refused connection still open\n");
+            ok = 0;
+        }
+    }
+
+    setrlimit(RLIMIT_NOFILE, &saved);
+    if (ok && connect(clients[TEST_TCP], (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+        perror("connect");
+        ok = 0;
+    }
+    for (i = 0; ok && i < 100 && !stats->accepted; ++i)
+        dump978_reader_set_poll(set, 10, source_frame, NULL);
+    if (ok && stats->accepted != 1) {
+        fprintf(stderr, "FAIL: no connection accepted after the limit was raised\n");
+        ok = 0;
+    }
+
+    if (ok)
+        fprintf(stderr, "PASS\n");
+    for (i = 0; i < TEST_TCP + 1; ++i)
+        close(clients[i]);
+    dump978_reader_set_free(set);
+    return ok;
+}
+
+// One source with far more input than the others must not hold them up:
+// every quiet source is read within the first few polls, one round of
+// epoll events after another.
+static int test_fairness(void)
+{
+    struct dump978_reader_set *set = dump978_reader_set_new();
+    const char *line = strchr(input, '\n') + 1;
+    size_t line_len = line - input;
+    char *backlog = malloc(65536);
+    int quiet[FAIR_SOURCES];
+    int busy[2], fds[2];
+    int i, polls, max_polls, busy_id, quiet_frames, ok = 1;
+
+    fprintf(stderr, "reader set fairness, one busy source and %d quiet ones: ", FAIR_SOURCES);
+    memset(logs, 0, sizeof(logs));
+
+    for (i = 0; i + line_len <= 65536; i += line_len)
+        memcpy(backlog + i, input, line_len);
+
+    if (pipe(busy) < 0) {
+        perror("pipe");
+        return 0;
+    }
+    make_nonblocking(busy[1]);
+    busy_id = dump978_reader_set_add(set, busy[0]);
+    while (write(busy[1], backlog, 65536 - 65536 % line_len) > 0)
+        ;
+
+    for (i = 0; i < FAIR_SOURCES; ++i) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+            perror("socketpair");
+            return 0;
+        }
+        dump978_reader_set_add(set, fds[0]);
+        if (write(fds[1], input, line_len) != (ssize_t) line_len)
+            ok = 0;
+        quiet[i] = fds[1];
+    }
+
+    // 64 events per epoll_wait()
+    max_polls = (FAIR_SOURCES + 1 + 63) / 64 + 1;
+    for (polls = 0; polls < max_polls; ++polls) {
+        dump978_reader_set_poll(set, 0, source_frame, NULL);
+        // keep the busy source busy
+        while (write(busy[1], backlog, 65536 - 65536 % line_len) > 0)
+            ;
+    }
+
+    quiet_frames = 0;
+    for (i = 0; i < TEST_MAX_SOURCES; ++i) {
+        if (i != busy_id)
+            quiet_frames += logs[i].frames;
+    }
+
+    if (!ok || quiet_frames != FAIR_SOURCES || logs[busy_id].frames == 0) {
+        fprintf(stderr, "FAIL: after %d polls, %d of %d quiet sources were read, busy source %d frames\n",
+                max_polls, quiet_frames, FAIR_SOURCES, logs[busy_id].frames);
+        ok = 0;
+    } else {
+        fprintf(stderr, "PASS (%d polls, busy source %d frames)\n", max_polls, logs[busy_id].frames);
+    }
+
+    for (i = 0; i < FAIR_SOURCES; ++i)
+        close(quiet[i]);
+    close(busy[1]);
+    dump978_reader_set_free(set);
+    free(backlog);
+    return ok;
+}
+
+// Thousands of connections on one thread
+static int test_scale(void)
+{
+    struct dump978_reader_set *set = dump978_reader_set_new();
+    struct frame_log ref;
+    struct rlimit rl;
+    size_t len = SCALE_BYTES;
+    int sources = SCALE_SOURCES;
+    int i, fds[2], total = 0, ok = 1;
+    double start, elapsed;
+
+    // whole lines only
+    if (len > input_len)
+        len = input_len;
+    while (len > 0 && input[len - 1] != '\n')
+        --len;
+    ref = reference_log(len);
+
+    getrlimit(RLIMIT_NOFILE, &rl);
+    if (rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    if (rl.rlim_cur < (rlim_t) (2 * sources + 64))
+        sources = (rl.rlim_cur - 64) / 2;
+
+    fprintf(stderr, "reader set, %d connections: ", sources);
+    memset(logs, 0, sizeof(logs));
+
+    for (i = 0; i < sources; ++i) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0 ||
+            write(fds[1], input, len) != (ssize_t) len) {
+            perror("socketpair");
+            return 0;
+        }
+        close(fds[1]);
+        dump978_reader_set_add(set, fds[0]);
+    }
+
+    start = now();
+    while (dump978_reader_set_active(set) > 0) {
+        int n = dump978_reader_set_poll(set, 100, source_frame, NULL);
+        if (n < 0 && errno != EINTR) {
+            perror("dump978_reader_set_poll");
+            return 0;
+        }
+        total += (n > 0 ? n : 0);
+    }
+    elapsed = now() - start;
+
+    for (i = 0; i < sources; ++i) {
+        if (logs[i].frames != ref.frames || logs[i].hash != ref.hash)
+            ok = 0;
+    }
+
+    if (!ok || total != sources * ref.frames) {
+        fprintf(stderr, "FAIL: %d frames, expected %d\n", total, sources * ref.frames);
+        ok = 0;
+    } else {
+        fprintf(stderr, "%.1f kframes/s, %.1f MB/s: PASS\n",
+                total / elapsed / 1e3, (double) sources * len / elapsed / 1e6);
+    }
+
+    dump978_reader_set_free(set);
+    return ok;
+}
+
+#define UDP_LINES 600
+
+// Send datagrams of 'lines' lines each, numbered from 'first' if
+// 'seq' is set; the last datagram of a batch has no final newline
+static int send_lines(int fd, char **line_starts, int *line_lens, int first, int count, int lines, int seq)
+{
+    char buf[4096];
+    int i, len = 0, in_datagram = 0, datagrams = 0;
+
+    for (i = first; i < first + count; ++i) {
+        len += sprintf(buf + len, "%.*s;", line_lens[i], line_starts[i]);
+        if (seq)
+            len += sprintf(buf + len, "seq=%d;", i);
+        if (++in_datagram == lines || i == first + count - 1) {
+            if (send(fd, buf, len, 0) != len)
+                return -1;
+            ++datagrams;
+            len = 0;
+            in_datagram = 0;
+        } else {
+            buf[len++] = '\n';
+        }
+    }
+
+    return datagrams;
+}
+
+static int test_udp(void)
+{
+    struct dump978_reader_set *set = dump978_reader_set_new();
+    struct sockaddr_in addr;
+    socklen_t addrlen = sizeof(addr);
+    char *line_starts[UDP_LINES];
+    int line_lens[UDP_LINES];
+    int senders[3];
+    const struct dump978_source_stats *stats;
+    char *p = input;
+    int fd, id, i, n, datagrams = 0, expected, ok = 1;
+    double start, elapsed;
+
+    fprintf(stderr, "reader set, UDP from 3 senders: ");
+    memset(logs, 0, sizeof(logs));
+
+    for (i = 0; i < UDP_LINES; ++i) {
+        line_starts[i] = p;
+        line_lens[i] = strchr(p, ';') - p;
+        p = strchr(p, '\n') + 1;
+    }
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+        getsockname(fd, (struct sockaddr *) &addr, &addrlen) < 0) {
+        perror("udp socket");
+        return 0;
+    }
+    id = dump978_reader_set_add_udp(set, fd);
+
+    for (i = 0; i < 3; ++i) {
+        senders[i] = socket(AF_INET, SOCK_DGRAM, 0);
+        if (connect(senders[i], (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+            perror("connect");
+            return 0;
+        }
+    }
+
+    // in small steps, so the socket buffer never overflows
+    for (i = 0; i < UDP_LINES; i += 20) {
+        // sender 0: everything, in order, 1..4 lines per datagram
+        datagrams += send_lines(senders[0], line_starts, line_lens, i, 20, 1 + (i / 20) % 4, 1);
+
+        // sender 1: drops frames 100-104, swaps 200 and 201, and sends
+        // 305 and 310 twice
+        if (i == 100) {
+            datagrams += send_lines(senders[1], line_starts, line_lens, 105, 15, 3, 1);
+        } else if (i == 200) {
+            datagrams += send_lines(senders[1], line_starts, line_lens, 201, 1, 1, 1);
+            datagrams += send_lines(senders[1], line_starts, line_lens, 200, 1, 1, 1);
+            datagrams += send_lines(senders[1], line_starts, line_lens, 202, 18, 3, 1);
+        } else if (i == 300) {
+            datagrams += send_lines(senders[1], line_starts, line_lens, 300, 20, 3, 1);
+            datagrams += send_lines(senders[1], line_starts, line_lens, 310, 1, 1, 1);
+            datagrams += send_lines(senders[1], line_starts, line_lens, 305, 1, 1, 1);
+        } else {
+            datagrams += send_lines(senders[1], line_starts, line_lens, i, 20, 3, 1);
+        }
+
+        // sender 2: no sequence numbers
+        datagrams += send_lines(senders[2], line_starts, line_lens, i, 20, 2, 0);
+
+        while (dump978_reader_set_poll(set, 0, source_frame, NULL) > 0)
+            ;
+    }
+
+    expected = 3 * UDP_LINES - 5 + 2;
+    stats = dump978_reader_set_stats(set, id);
+    if (logs[id].frames != expected || stats->frames != (uint64_t) expected ||
+        stats->datagrams != (uint64_t) datagrams || stats->lost != 5 || stats->late != 1 ||
+        stats->duplicates != 2 || stats->senders != 3) {
+        fprintf(stderr, "FAIL: %d frames (expected %d), %llu datagrams (expected %d), %llu lost (expected 5), %llu late (expected 1), %llu duplicates (expected 2), %d senders\n",
+                logs[id].frames, expected, (unsigned long long) stats->datagrams, datagrams,
+                (unsigned long long) stats->lost, (unsigned long long) stats->late,
+                (unsigned long long) stats->duplicates, stats->senders);
+        ok = 0;
+    } else {
+        fprintf(stderr, "PASS\n");
+    }
+
+    // throughput, sending in bursts that fit in the socket buffer
+    if (ok) {
+        uint64_t received = stats->datagrams;
+
+        fprintf(stderr, "reader set, UDP throughput: ");
+        start = now();
+        for (n = 0; n < 200; ++n) {
+            for (i = 0; i < UDP_LINES; i += 60) {
+                send_lines(senders[0], line_starts, line_lens, i, 60, 4, 0);
+                while (dump978_reader_set_poll(set, 0, source_frame, NULL) > 0)
+                    ;
+            }
+        }
+        elapsed = now() - start;
+        received = stats->datagrams - received;
+        fprintf(stderr, "%.1f kdatagrams/s, %.1f kframes/s (sending included), %.1f%% received\n",
+                received / elapsed / 1e3, (logs[id].frames - expected) / elapsed / 1e3,
+                100.0 * received / (200 * ((UDP_LINES + 3) / 4)));
+    }
+
+    for (i = 0; i < 3; ++i)
+        close(senders[i]);
+    dump978_reader_set_free(set);
+    return ok;
+}
+
+// What uat2text does with a frame
+static void text_frame(frame_type_t t, uint8_t *f, int l, FILE *out, void *d)
+{
+    int i;
+
+    for (i = 0; i < l; i++)
+        fprintf(out, "%02x", f[i]);
+    fprintf(out, "\n");
+    if (t == UAT_DOWNLINK) {
+        struct uat_adsb_mdb mdb;
+        uat_decode_adsb_mdb(f, &mdb);
+        uat_display_adsb_mdb(&mdb, out);
+    } else {
+        struct uat_uplink_mdb mdb;
+        uat_decode_uplink_mdb(f, &mdb);
+        uat_display_uplink_mdb(&mdb, out);
+    }
+    fprintf(out, "\n");
+}
+
+struct serial_log {
+    pthread_t thread;           // the only thread the handler may run on
+    int ok;
+    struct frame_log ordered;   // depends on the order of the frames
+    struct frame_log unordered; // sum of the hashes of each frame
+};
+
+static void serial_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    struct serial_log *log = d;
+    struct frame_log one = { 0, 0 };
+
+    if (!pthread_equal(pthread_self(), log->thread))
+        log->ok = 0;
+    log_frame(&log->ordered, t, f, l);
+    log_frame(&one, t, f, l);
+    ++log->unordered.frames;
+    log->unordered.hash += one.hash;
+}
+
+static void text_reader_frame(frame_type_t t, uint8_t *f, int l, void *d)
+{
+    text_frame(t, f, l, d, NULL);
+}
+
+static int compare_lines(const void *a, const void *b)
+{
+    return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+// Whether two texts have the same lines, in any order
+static int same_lines(const char *a, size_t a_len, const char *b, size_t b_len)
+{
+    char *texts[2], **lines[2];
+    size_t counts[2], i;
+    int t, same = 1;
+
+    if (a_len != b_len)
+        return 0;
+
+    for (t = 0; t < 2; ++t) {
+        char *p;
+
+        texts[t] = strndup(t ? b : a, a_len);
+        counts[t] = 0;
+        lines[t] = malloc((a_len + 1) * sizeof(char *));
+        for (p = strtok(texts[t], "\n"); p; p = strtok(NULL, "\n"))
+            lines[t][counts[t]++] = p;
+        qsort(lines[t], counts[t], sizeof(char *), compare_lines);
+    }
+
+    if (counts[0] != counts[1])
+        same = 0;
+    for (i = 0; same && i < counts[0]; ++i)
+        same = !strcmp(lines[0][i], lines[1][i]);
+
+    for (t = 0; t < 2; ++t) {
+        free(texts[t]);
+        free(lines[t]);
+    }
+    return same;
+}
+
+// Every combination of threads, chunk size, handler and order
+static int test_parallel(void)
+{
+    static const int thread_counts[] = { 1, 3, 8, 0 };
+    static const size_t chunk_sizes[] = { 1000, 65536, 0 };
+    static const char junk[] = "x1234;\n-123;\n+zz;\n\n-00a66ef135445d525a0c0519119021204800;rs=1;\n";
+    struct serial_log ref;
+    struct dump978_reader *reader;
+    char *ref_text = NULL;
+    size_t ref_text_len = 0;
+    FILE *f = tmpfile(), *out;
+    int i, ti, ci, mode, frames, ok = 1;
+    double start, serial_time = 0, parallel_time = 0;
+
+    // the input replayed, with some junk in between and an unterminated
+    // last line
+    for (i = 0; i < 3; ++i) {
+        fwrite(input, 1, input_len, f);
+        fputs(junk, f);
+    }
+    fputs("-00a66ef135445d525a0c0519119021204800;", f);
+    fflush(f);
+
+    memset(&ref, 0, sizeof(ref));
+    ref.thread = pthread_self();
+    rewind(f);
+    reader = dump978_reader_new(fileno(f), 0);
+    while (dump978_read_frames(reader, serial_frame, &ref) > 0)
+        ;
+    dump978_reader_free(reader);
+
+    out = open_memstream(&ref_text, &ref_text_len);
+    rewind(f);
+    start = now();
+    reader = dump978_reader_new(fileno(f), 0);
+    while (dump978_read_frames(reader, text_reader_frame, out) > 0)
+        ;
+    dump978_reader_free(reader);
+    fclose(out);
+    serial_time = now() - start;
+
+    for (ti = 0; thread_counts[ti]; ++ti) {
+        for (ci = 0; ci < 3; ++ci) {
+            for (mode = 0; mode < 4; ++mode) {
+                struct dump978_parallel_config config;
+                struct serial_log log;
+                char *text = NULL;
+                size_t text_len = 0;
+                int ordered = mode & 1, parallel = mode & 2, pass;
+
+                memset(&config, 0, sizeof(config));
+                config.threads = thread_counts[ti];
+                config.chunk_size = chunk_sizes[ci];
+                config.ordered = ordered;
+
+                memset(&log, 0, sizeof(log));
+                log.thread = pthread_self();
+                log.ok = 1;
+
+                if (parallel) {
+                    out = open_memstream(&text, &text_len);
+                    config.parallel_handler = text_frame;
+                    config.output = out;
+                } else {
+                    config.handler = serial_frame;
+                    config.handler_data = &log;
+                }
+
+                start = now();
+                frames = dump978_read_parallel(fileno(f), &config);
+                if (parallel) {
+                    fclose(out);
+                    if (ti == 2 && ci == 2 && ordered)
+                        parallel_time = now() - start;
+                }
+
+                if (frames != ref.ordered.frames) {
+                    pass = 0;
+                } else if (parallel) {
+                    pass = (ordered ? (text_len == ref_text_len && !memcmp(text, ref_text, text_len))
+                            : same_lines(text, text_len, ref_text, ref_text_len));
+                } else {
+                    pass = (log.ok && log.unordered.frames == ref.unordered.frames &&
+                            log.unordered.hash == ref.unordered.hash &&
+                            (!ordered || log.ordered.hash == ref.ordered.hash));
+                }
+
+                if (!pass) {
+                    fprintf(stderr, "parallel reader, %d threads, %zu byte chunks, %s handler, %s: FAIL (%d frames, expected %d)\n",
+                            thread_counts[ti], chunk_sizes[ci], parallel ? "parallel" : "plain",
+                            ordered ? "ordered" : "unordered", frames, ref.ordered.frames);
+                    ok = 0;
+                }
+                free(text);
+            }
+        }
+    }
+
+    // a pipe can't be mapped
+    {
+        struct dump978_parallel_config config;
+        int fds[2];
+
+        memset(&config, 0, sizeof(config));
+        config.handler = serial_frame;
+        config.handler_data = &ref;
+        if (pipe(fds) < 0 || dump978_read_parallel(fds[0], &config) >= 0 || errno != ENODEV) {
+            fprintf(stderr, "parallel reader on a pipe: FAIL\n");
+            ok = 0;
+        }
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    if (ok)
+        fprintf(stderr, "parallel reader, %d configurations: PASS (decoding to text: %.1f kframes/s on one thread, %.1f kframes/s on 8)\n",
+                3 * 3 * 4, ref.ordered.frames / serial_time / 1e3, ref.ordered.frames / parallel_time / 1e3);
+
+    free(ref_text);
+    fclose(f);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const struct reader_simd_impl *simd_ref;
+    struct frame_log ref;
+    int ok = 1;
+
+    if (!load_input(argc > 1 ? argv[1] : "scripts/samples.txt"))
+        return 1;
+
+    signal(SIGPIPE, SIG_IGN);
+    ref = reference_log(input_len);
+
+    // the last entry is the scalar version
+    for (simd_ref = reader_simd_impls; simd_ref[1].name; ++simd_ref)
+        ;
+
+    ok = test_simd_functions(simd_ref) && ok;
+    ok = test_lines() && ok;
+    ok = test_metadata() && ok;
+    ok = test_sources(&ref) && ok;
+    ok = test_refused() && ok;
+    ok = test_fairness() && ok;
+    ok = test_scale() && ok;
+    ok = test_udp() && ok;
+    ok = test_parallel() && ok;
+
+    return ok ? 0 : 1;
+}
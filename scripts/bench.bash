@@ -0,0 +1,54 @@
+#!/bin/bash
+#
+# Demodulator throughput benchmark.
+#
+# Generates a synthetic I/Q signal from the sample data with uat2iq,
+# feeds it through dump978, and reports the demodulator throughput
+# (in millions of samples per second of CPU time, i.e. per core) and
+# the fraction of the modulated messages that were decoded correctly.
+#
+# The signal parameters can be overridden from the environment, e.g.
+#   SNR=12 FREQ_OFFSET=20000 make bench
+#
+scripts_dir=$(dirname "$0")
+repo_dir=$(dirname "$scripts_dir")
+
+SNR=${SNR:-20}
+FREQ_OFFSET=${FREQ_OFFSET:-0}
+TIMING_OFFSET=${TIMING_OFFSET:-0}
+RATE=${RATE:-1000}
+REPEAT=${REPEAT:-10}
+SEED=${SEED:-1}
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+zcat -f "$repo_dir/sample-data.txt.gz" | \
+    "$repo_dir/uat2iq" -s "$SNR" -f "$FREQ_OFFSET" -T "$TIMING_OFFSET" -r "$RATE" -n "$REPEAT" -x "$SEED" \
+                       -t "$tmp/truth.txt" > "$tmp/signal.cu8" || exit 1
+
+TIMEFORMAT='%U %S'
+{ time "$repo_dir/dump978" < "$tmp/signal.cu8" > "$tmp/decoded.txt" ; } 2> "$tmp/time.txt" || exit 1
+
+samples=$(( $(stat -c %s "$tmp/signal.cu8") / 2 ))
+sent=$(wc -l < "$tmp/truth.txt")
+# strip metadata (e.g. rs=N) and compare as multisets
+sed 's/;.*$/;/' "$tmp/decoded.txt" | sort > "$tmp/decoded.sorted"
+sort "$tmp/truth.txt" > "$tmp/truth.sorted"
+decoded=$(wc -l < "$tmp/decoded.sorted")
+matched=$(comm -12 "$tmp/truth.sorted" "$tmp/decoded.sorted" | wc -l)
+
+read user sys < "$tmp/time.txt"
+awk -v samples="$samples" -v user="$user" -v sys="$sys" \
+    -v sent="$sent" -v decoded="$decoded" -v matched="$matched" \
+    -v snr="$SNR" -v foff="$FREQ_OFFSET" -v toff="$TIMING_OFFSET" -v rate="$RATE" '
+BEGIN {
+    cpu = user + sys;
+    printf "signal:      %d samples (%.1f s), SNR %s dB, freq offset %s Hz, timing offset %s, %s msg/s\n",
+           samples, samples / 2083334, snr, foff, toff, rate;
+    printf "cpu time:    %.3f s (user %.3f s, sys %.3f s)\n", cpu, user, sys;
+    if (cpu > 0)
+        printf "throughput:  %.2f Msps/core (%.1fx realtime)\n", samples / cpu / 1e6, samples / 2083334 / cpu;
+    printf "decoded:     %d of %d messages (%.2f%%), %d spurious\n",
+           matched, sent, (sent ? 100.0 * matched / sent : 0), decoded - matched;
+}'
@@ -0,0 +1,32 @@
+#!/bin/bash
+#
+# Startup time benchmark.
+#
+# Compares the time to launch dump978 on empty input when its lookup
+# tables are generated at build time (dump978) against computing them
+# at startup (dump978-runtime-tables, built with -DRUNTIME_TABLES).
+#
+# The number of launches can be overridden from the environment, e.g.
+#   LAUNCHES=5000 make bench-startup
+#
+scripts_dir=$(dirname "$0")
+repo_dir=$(dirname "$scripts_dir")
+
+LAUNCHES=${LAUNCHES:-1000}
+
+launch_time() {
+    local binary="$1"
+    local start end i
+
+    start=$(date +%s%N)
+    for (( i = 0; i < LAUNCHES; ++i )); do
+        "$binary" < /dev/null > /dev/null || exit 1
+    done
+    end=$(date +%s%N)
+
+    awk -v ns=$(( end - start )) -v n="$LAUNCHES" 'BEGIN { printf "%.3f", ns / n / 1e6 }'
+}
+
+echo "$LAUNCHES launches each on empty input:"
+echo "  build-time tables: $(launch_time "$repo_dir/dump978") ms per launch"
+echo "  runtime tables:    $(launch_time "$repo_dir/dump978-runtime-tables") ms per launch"
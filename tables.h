@@ -0,0 +1,101 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef DUMP978_TABLES_H
+#define DUMP978_TABLES_H
+
+#include <stdint.h>
+#include <math.h>
+
+// Lookup tables. These are generated at build time by gen_tables
+// (see the Makefile) and end up as const data in read-only pages that are
+// shared between processes. Build with -DRUNTIME_TABLES to compute the
+// phase table and RS control blocks at startup instead.
+
+// Phase angle of an 8-bit I/Q sample, scaled so [0..65536) -> [0, 2*pi)
+static inline uint16_t iq_to_phase(unsigned i, unsigned q)
+{
+    double d_i = (i - 127.5);
+    double d_q = (q - 127.5);
+    double ang = atan2(d_q, d_i) + M_PI; // atan2 returns [-pi..pi], normalize to [0..2*pi]
+    double scaled_ang = round(32768 * ang / M_PI);
+
+    return (scaled_ang < 0 ? 0 : scaled_ang > 65535 ? 65535 : (uint16_t)scaled_ang);
+}
+
+// The Galois field shared by all the UAT Reed-Solomon codes (poly 0x187),
+// as alpha_to / index_of tables in the usual libfec format. Each table
+// is cache-line aligned, so together they occupy exactly 8 lines.
+extern const uint8_t rs_alpha_to[256];
+extern const uint8_t rs_index_of[256];
+
+// Split-nibble multiplication tables for computing syndromes with
+// SIMD shuffles; see gen_tables.c and fec_simd.c
+#define RS_SYNDROME_FCR (120)
+#define RS_SYNDROME_ROOTS (20)
+#define RS_SYNDROME_STEPS (6)  // multipliers r^32, r^16, r^8, r^4, r^2, r^1
+extern const uint8_t rs_syndrome_mul[RS_SYNDROME_ROOTS][RS_SYNDROME_STEPS][32];
+
+// The same, for multiplying by alpha^1 .. alpha^RS_SYNDROME_ROOTS
+// in the Chien search
+extern const uint8_t rs_chien_mul[RS_SYNDROME_ROOTS][32];
+
+// rs_quadratic_root[c] is a root of y^2 + y = c, or 0 if there is none
+extern const uint8_t rs_quadratic_root[256];
+
+// PSHUFB masks for deinterleaving uplink frames with SIMD shuffles;
+// see gen_tables.c and fec_simd.c. The dimensions are
+// [UPLINK_FRAME_BLOCKS][UPLINK_FRAME_BLOCKS]
+extern const uint8_t uplink_deinterleave_shuffle[6][6][16];
+
+// Parity update tables for the table-driven Reed-Solomon encoders of
+// the three UAT codes; see gen_tables.c and fec_decoders.c
+#define RS_ENCODE_WIDTH (24)
+extern const uint8_t rs_encode_adsb_short[256][RS_ENCODE_WIDTH];
+extern const uint8_t rs_encode_adsb_long[256][RS_ENCODE_WIDTH];
+extern const uint8_t rs_encode_uplink[256][RS_ENCODE_WIDTH];
+
+// The base 40 alphabet of callsigns in ADS-B MS elements, and for each
+// v = 0..1599 its two low base 40 digits (v / 40, v % 40) as characters
+#define BASE40_ALPHABET "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ  .."
+extern const char base40_pairs[1600][2];
+
+// iqphase[] is indexed by i | (q << 8) for an I/Q sample as read from
+// the input (I first, then Q). That is the sample's 16-bit value on a
+// little-endian machine; IQPHASE_INDEX() turns the 16-bit value read on
+// the target into the index, so the table doesn't depend on the byte
+// order of the machine that generated it.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define IQPHASE_INDEX(iq16) ((uint16_t) (((iq16) >> 8) | ((iq16) << 8)))
+#else
+#define IQPHASE_INDEX(iq16) (iq16)
+#endif
+
+#ifndef RUNTIME_TABLES
+
+extern const uint16_t iqphase[65536];
+
+// Reed-Solomon control blocks, as returned by init_rs_char()
+// for the three UAT codes
+struct rs;
+extern const struct rs rs_adsb_short_table;
+extern const struct rs rs_adsb_long_table;
+extern const struct rs rs_uplink_table;
+
+#endif
+
+#endif
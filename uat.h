@@ -18,6 +18,12 @@
 #ifndef UAT_H
 #define UAT_H
 
+// Sync words
+
+#define SYNC_BITS (36)
+#define ADSB_SYNC_WORD   0xEACDDA4E2UL
+#define UPLINK_SYNC_WORD 0x153225B1DUL
+
 // Frame size constants
 
 #define SHORT_FRAME_DATA_BITS (144)
@@ -20,6 +20,7 @@
 #include <math.h>
 #include <string.h>
 #include <getopt.h>
+#include <errno.h>
 
 #include "uat.h"
 #include "uat_decode.h"
@@ -660,7 +661,8 @@ static void handle_frame(frame_type_t type, uint8_t *frame, int len, void *extra
 {
     if (type == UAT_DOWNLINK) {
         struct uat_adsb_mdb mdb;
-        uat_decode_adsb_mdb(frame, &mdb);
+        // nothing here uses the aircraft dimensions
+        uat_decode_adsb_mdb_fields(frame, &mdb, UAT_DECODE_ALL & ~UAT_DECODE_DIMENSIONS);
 
         if (should_send(&mdb)) {
             generate_esnt(&mdb);
@@ -668,26 +670,44 @@ static void handle_frame(frame_type_t type, uint8_t *frame, int len, void *extra
     }
 }        
 
+static void handle_source_frame(int source, const struct dump978_frame *frame, void *d)
+{
+    handle_frame(frame->type, frame->data, frame->len, d);
+}
+
 void usage(int argc, char **argv)
 {
     fprintf(stderr,
-            "usage: %s [-t]\n"
+            "usage: %s [-t] [-i SOURCE]...\n"
             "\n"
-            "Reads UAT downlink messages from stdin and writes ADS-B ES/NT messages\n"
-            "(1090MHz-style) to stdout.\n"
+            "Reads UAT downlink messages from stdin, or from each SOURCE, and writes\n"
+            "ADS-B ES/NT messages (1090MHz-style) to stdout.\n"
             "\n"
-            "  -t   Disable forwarding of TIS-B traffic\n"
-            "  -h   Show this usage message\n",
+            "  -t         Disable forwarding of TIS-B traffic\n"
+            "  -i SOURCE  Read messages from SOURCE, which is one of:\n"
+            "               -                      standard input\n"
+            "               tcp:HOST:PORT          connect to a TCP server\n"
+            "               listen:[HOST:]PORT     accept TCP connections\n"
+            "               udp:[HOST:]PORT        receive UDP datagrams\n"
+            "               unix:PATH              connect to a Unix socket\n"
+            "               unix-listen:PATH       accept connections on a Unix socket\n"
+            "               PATH                   a file or FIFO\n"
+            "  -h         Show this usage message\n",
             argv[0]);
 }
 
 int main(int argc, char **argv)
 {
-    struct dump978_reader *reader;
-    int framecount;
+    struct dump978_reader_set *set;
     int opt;
 
-    while ((opt = getopt(argc, argv, "ht")) > 0) {
+    set = dump978_reader_set_new();
+    if (!set) {
+        perror("dump978_reader_set_new");
+        return 1;
+    }
+
+    while ((opt = getopt(argc, argv, "hti:")) > 0) {
         switch (opt) {
         case 'h':
             usage(argc, argv);
@@ -697,6 +717,13 @@ int main(int argc, char **argv)
             use_tisb = 0;
             break;
 
+        case 'i':
+            if (dump978_reader_set_open(set, optarg) < 0) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+
         default:
             usage(argc, argv);
             return 1;
@@ -708,22 +735,20 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    initCrcTables();
-
-    reader = dump978_reader_new(0,0);
-    if (!reader) {
-        perror("dump978_reader_new");
+    if (dump978_reader_set_active(set) == 0 && dump978_reader_set_open(set, "-") < 0) {
+        perror("stdin");
         return 1;
     }
-    
-    while ((framecount = dump978_read_frames(reader, handle_frame, NULL)) > 0)
-        ;
 
-    if (framecount < 0) {
-        perror("dump978_read_frames");
-        return 1;
+    initCrcTables();
+
+    while (dump978_reader_set_active(set) > 0) {
+        if (dump978_reader_set_poll(set, -1, handle_source_frame, NULL) < 0 && errno != EINTR) {
+            perror("dump978_reader_set_poll");
+            return 1;
+        }
     }
 
+    dump978_reader_set_free(set);
     return 0;
 }
-
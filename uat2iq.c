@@ -0,0 +1,257 @@
+//
+// Copyright 2026, the dump978 contributors
+//
+
+// This file is free software: you may copy, redistribute and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 2 of the License, or (at your
+// option) any later version.
+//
+// This file is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// Reads demodulated messages on stdin (in the format written by dump978)
+// and writes a synthetic 8-bit I/Q signal containing those messages to
+// stdout, suitable for feeding back into dump978 for benchmarking.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "uat.h"
+#include "fec.h"
+#include "reader.h"
+#include "modulator.h"
+
+struct input_frame {
+    frame_type_t type;
+    int len;
+    uint8_t data[UPLINK_FRAME_DATA_BYTES];
+};
+
+static struct input_frame *frames;
+static int num_frames;
+static int max_frames;
+
+static void handle_frame(frame_type_t type, uint8_t *frame, int len, void *extra)
+{
+    struct input_frame *f;
+
+    if (type == UAT_DOWNLINK) {
+        int expected = ((frame[0]>>3) == 0 ? SHORT_FRAME_DATA_BYTES : LONG_FRAME_DATA_BYTES);
+        if (len != expected) {
+            fprintf(stderr, "skipping downlink frame with bad length %d\n", len);
+            return;
+        }
+    } else if (len != UPLINK_FRAME_DATA_BYTES) {
+        fprintf(stderr, "skipping uplink frame with bad length %d\n", len);
+        return;
+    }
+
+    if (num_frames == max_frames) {
+        max_frames = (max_frames ? max_frames * 2 : 1024);
+        frames = realloc(frames, max_frames * sizeof(*frames));
+        if (!frames) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+
+    f = &frames[num_frames++];
+    f->type = type;
+    f->len = len;
+    memcpy(f->data, frame, len);
+}
+
+static void write_truth(FILE *truth, const struct input_frame *f)
+{
+    int i;
+
+    fprintf(truth, "%c", f->type == UAT_UPLINK ? '+' : '-');
+    for (i = 0; i < f->len; ++i)
+        fprintf(truth, "%02x", f->data[i]);
+    fprintf(truth, ";\n");
+}
+
+static void write_samples(const uint8_t *samples, int n)
+{
+    if (fwrite(samples, 2, n, stdout) != n) {
+        perror("fwrite");
+        exit(1);
+    }
+}
+
+// write 'n' samples of noise in chunks
+static void write_noise(struct uat_modulator *mod, uint64_t n)
+{
+    static uint8_t noise[2 * 16384];
+
+    while (n > 0) {
+        int chunk = (n > 16384 ? 16384 : n);
+        modulate_noise(mod, noise, chunk);
+        write_samples(noise, chunk);
+        n -= chunk;
+    }
+}
+
+static void usage(int argc, char **argv)
+{
+    fprintf(stderr,
+            "Syntax: %s [-s SNR] [-f OFFSET] [-T OFFSET] [-r RATE] [-n COUNT] [-t FILE] [-x SEED]\n"
+            "\n"
+            "Reads UAT messages on stdin, writes a synthetic 8-bit I/Q signal\n"
+            "at 2.083334MHz containing those messages to stdout.\n"
+            "\n"
+            "  -s SNR     Signal to noise ratio, in dB (default 20)\n"
+            "  -f OFFSET  Carrier frequency offset, in Hz (default 0)\n"
+            "  -T OFFSET  Timing offset, as a fraction of a sample in [0, 1) (default 0)\n"
+            "  -r RATE    Mean traffic density, in messages per second (default 1000)\n"
+            "  -n COUNT   Repeat the input messages COUNT times (default 1)\n"
+            "  -t FILE    Write the messages, in the order they were modulated, to FILE\n"
+            "  -x SEED    Random seed (default 1)\n"
+            "  -h         Show this usage message\n",
+            argv[0]);
+}
+
+int main(int argc, char **argv)
+{
+    struct dump978_reader *reader;
+    struct uat_modulator mod;
+    int framecount;
+    int opt;
+    int i, rep;
+
+    double snr_db = 20.0;
+    double freq_offset = 0.0;
+    double timing_offset = 0.0;
+    double rate = 1000.0;
+    int repeat = 1;
+    FILE *truth = NULL;
+    uint64_t seed = 1;
+
+    // schedule, in samples
+    double next_start;
+    uint64_t position;
+
+    static uint8_t samples[2 * MODULATOR_SAMPLES(UPLINK_FRAME_BITS)];
+
+    while ((opt = getopt(argc, argv, "hs:f:T:r:n:t:x:")) > 0) {
+        switch (opt) {
+        case 'h':
+            usage(argc, argv);
+            return 0;
+        case 's':
+            snr_db = atof(optarg);
+            break;
+        case 'f':
+            freq_offset = atof(optarg);
+            break;
+        case 'T':
+            timing_offset = atof(optarg);
+            if (timing_offset < 0 || timing_offset >= 1) {
+                fprintf(stderr, "timing offset must be in the range [0, 1)\n");
+                return 1;
+            }
+            break;
+        case 'r':
+            rate = atof(optarg);
+            if (rate <= 0) {
+                fprintf(stderr, "message rate must be positive\n");
+                return 1;
+            }
+            break;
+        case 'n':
+            repeat = atoi(optarg);
+            break;
+        case 't':
+            truth = fopen(optarg, "w");
+            if (!truth) {
+                perror(optarg);
+                return 1;
+            }
+            break;
+        case 'x':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        default:
+            usage(argc, argv);
+            return 1;
+        }
+    }
+
+    if (optind < argc) {
+        usage(argc, argv);
+        return 1;
+    }
+
+    reader = dump978_reader_new(0, 0);
+    if (!reader) {
+        perror("dump978_reader_new");
+        return 1;
+    }
+
+    while ((framecount = dump978_read_frames(reader, handle_frame, NULL)) > 0)
+        ;
+
+    if (framecount < 0) {
+        perror("dump978_read_frames");
+        return 1;
+    }
+
+    dump978_reader_free(reader);
+
+    init_fec();
+    modulator_init(&mod, snr_db, freq_offset, timing_offset, seed);
+
+    // Messages start at exponentially distributed intervals (a Poisson
+    // process) with the requested mean rate. A message that would overlap
+    // the previous one is delayed until the previous message ends.
+    position = 0;
+    next_start = 0;
+    for (rep = 0; rep < repeat; ++rep) {
+        for (i = 0; i < num_frames; ++i) {
+            struct input_frame *f = &frames[i];
+            uint8_t encoded[UPLINK_FRAME_BYTES];
+            int n;
+
+            next_start += -log(modulator_random(&mod)) * MODULATOR_SAMPLE_RATE / rate;
+            if (next_start > position) {
+                write_noise(&mod, (uint64_t)next_start - position);
+                position = (uint64_t)next_start;
+            }
+
+            if (f->type == UAT_DOWNLINK) {
+                int frametype;
+                memcpy(encoded, f->data, f->len);
+                frametype = encode_adsb_frame(encoded);
+                n = modulate_adsb_frame(&mod, encoded, frametype, samples);
+            } else {
+                encode_uplink_frame(f->data, encoded);
+                n = modulate_uplink_frame(&mod, encoded, samples);
+            }
+
+            write_samples(samples, n);
+            position += n;
+
+            if (truth)
+                write_truth(truth, f);
+        }
+    }
+
+    // trailing noise, so the demodulator has enough lookahead
+    // to find the last message
+    write_noise(&mod, 2 * MODULATOR_SAMPLES(UPLINK_FRAME_BITS));
+
+    if (truth)
+        fclose(truth);
+
+    return 0;
+}
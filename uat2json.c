@@ -22,8 +22,8 @@
 #include <limits.h>
 
 #include <time.h>
-#include <sys/select.h>
 #include <errno.h>
+#include <getopt.h>
 
 #include "uat.h"
 #include "uat_decode.h"
@@ -333,78 +333,105 @@ static void handle_frame(frame_type_t type, uint8_t *frame, int len, void *extra
         return;
     }
 
-    uat_decode_adsb_mdb(frame, &mdb);
+    // the map doesn't show aircraft dimensions
+    uat_decode_adsb_mdb_fields(frame, &mdb, UAT_DECODE_ALL & ~UAT_DECODE_DIMENSIONS);
     // uat_display_adsb_mdb(&mdb, stdout);
     process_mdb(&mdb);
 }
 
-static void read_loop()
+static void handle_source_frame(int source, const struct dump978_frame *frame, void *d)
 {
-    struct dump978_reader *reader;
-
-    reader = dump978_reader_new(0, 1);
-    if (!reader)
-    {
-        perror("dump978_reader_new");
-        return;
-    }
+    handle_frame(frame->type, frame->data, frame->len, d);
+}
 
-    for (;;)
+static void read_loop(struct dump978_reader_set *set)
+{
+    while (dump978_reader_set_active(set) > 0)
     {
-        fd_set readset, writeset, excset;
-        struct timeval timeout;
-        int framecount;
-
-        FD_ZERO(&readset);
-        FD_ZERO(&writeset);
-        FD_ZERO(&excset);
-        FD_SET(0, &readset);
-        FD_SET(0, &excset);
-        timeout.tv_sec = 0;
-        timeout.tv_usec = 500000;
-
-        select(1, &readset, &writeset, &excset, &timeout);
-
         NOW = time(NULL);
-        framecount = dump978_read_frames(reader, handle_frame, NULL);
-
-        if (framecount == 0)
-            break;
-
-        if (framecount < 0 && errno != EAGAIN && errno != EINTR && errno != EWOULDBLOCK)
+        if (dump978_reader_set_poll(set, 500, handle_source_frame, NULL) < 0 && errno != EINTR)
         {
-            perror("dump978_read_frames");
+            perror("dump978_reader_set_poll");
             break;
         }
 
         periodic_work();
     }
+}
 
-    dump978_reader_free(reader);
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "Syntax: %s [-i SOURCE]... <dir>\n"
+            "\n"
+            "Reads UAT messages on stdin, or from each SOURCE:\n"
+            "  -                      standard input\n"
+            "  tcp:HOST:PORT          connect to a TCP server\n"
+            "  listen:[HOST:]PORT     accept TCP connections\n"
+            "  udp:[HOST:]PORT        receive UDP datagrams\n"
+            "  unix:PATH              connect to a Unix socket\n"
+            "  unix-listen:PATH       accept connections on a Unix socket\n"
+            "  PATH                   a file or FIFO\n"
+            "Periodically writes aircraft state to <dir>/aircraft.json\n"
+            "Also writes <dir>/receiver.json once on startup\n",
+            argv0);
 }
 
 int main(int argc, char **argv)
 {
-    if (argc < 2)
+    struct dump978_reader_set *set;
+    int opt;
+
+    set = dump978_reader_set_new();
+    if (!set)
     {
-        fprintf(stderr,
-                "Syntax: %s <dir>\n"
-                "\n"
-                "Reads UAT messages on stdin.\n"
-                "Periodically writes aircraft state to <dir>/aircraft.json\n"
-                "Also writes <dir>/receiver.json once on startup\n",
-                argv[0]);
+        perror("dump978_reader_set_new");
         return 1;
     }
 
-    json_dir = argv[1];
+    while ((opt = getopt(argc, argv, "hi:")) > 0)
+    {
+        switch (opt)
+        {
+        case 'i':
+            if (dump978_reader_set_open(set, optarg) < 0)
+            {
+                perror(optarg);
+                return 1;
+            }
+            break;
+
+        case 'h':
+            usage(argv[0]);
+            return 0;
+
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind + 1 != argc)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    json_dir = argv[optind];
+
+    if (dump978_reader_set_active(set) == 0 && dump978_reader_set_open(set, "-") < 0)
+    {
+        perror("stdin");
+        return 1;
+    }
 
     if (!write_receiver_json(json_dir))
     {
         fprintf(stderr, "Failed to write receiver.json - check permissions?\n");
         return 1;
     }
-    read_loop();
+    read_loop(set);
     write_aircraft_json(json_dir);
+    dump978_reader_set_free(set);
     return 0;
 }
@@ -16,39 +16,107 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "uat.h"
 #include "uat_decode.h"
 #include "reader.h"
 
-void handle_frame(frame_type_t type, uint8_t *frame, int len, void *extra)
+static void write_frame(frame_type_t type, uint8_t *frame, int len, FILE *out, void *extra)
 {
     for (uint16_t i = 0; i < len; i++)
     {
-        printf("%02x", frame[i]);
+        fprintf(out, "%02x", frame[i]);
     }
-    printf("\n");
+    fprintf(out, "\n");
     if (type == UAT_DOWNLINK)
     {
         struct uat_adsb_mdb mdb;
         uat_decode_adsb_mdb(frame, &mdb);
-        uat_display_adsb_mdb(&mdb, stdout);
+        uat_display_adsb_mdb(&mdb, out);
     }
     else
     {
         struct uat_uplink_mdb mdb;
         uat_decode_uplink_mdb(frame, &mdb);
-        uat_display_uplink_mdb(&mdb, stdout);
+        uat_display_uplink_mdb(&mdb, out);
     }
 
-    fprintf(stdout, "\n");
-    fflush(stdout);
+    fprintf(out, "\n");
+}
+
+void handle_frame(frame_type_t type, uint8_t *frame, int len, void *extra)
+{
+    write_frame(type, frame, len, stdout, extra);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-j THREADS [-u]]\n"
+            "\n"
+            "Reads UAT messages from stdin and writes them in a readable form to stdout.\n"
+            "\n"
+            "  -j THREADS  If stdin is a file, decode it on THREADS threads\n"
+            "  -u          With -j, write messages in the order they are decoded\n"
+            "              rather than the order they are in the file\n"
+            "  -h          Show this usage message\n",
+            argv0);
 }
 
 int main(int argc, char **argv)
 {
     struct dump978_reader *reader;
+    const struct dump978_frame *frames;
+    struct stat st;
     int framecount;
+    int threads = 0, ordered = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "hj:u")) > 0)
+    {
+        switch (opt)
+        {
+        case 'j':
+            threads = atoi(optarg);
+            break;
+        case 'u':
+            ordered = 0;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind < argc)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (threads > 0 && fstat(0, &st) == 0 && S_ISREG(st.st_mode))
+    {
+        struct dump978_parallel_config config;
+
+        memset(&config, 0, sizeof(config));
+        config.threads = threads;
+        config.ordered = ordered;
+        config.parallel_handler = write_frame;
+        config.output = stdout;
+        if (dump978_read_parallel(0, &config) < 0)
+        {
+            perror("dump978_read_parallel");
+            return 1;
+        }
+        return 0;
+    }
 
     reader = dump978_reader_new(0, 0);
     if (!reader)
@@ -57,12 +125,17 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    while ((framecount = dump978_read_frames(reader, handle_frame, NULL)) > 0)
-        ;
+    // flush once per batch rather than once per frame
+    while ((framecount = dump978_reader_next_batch(reader, &frames)) > 0)
+    {
+        for (int i = 0; i < framecount; i++)
+            handle_frame(frames[i].type, frames[i].data, frames[i].len, NULL);
+        fflush(stdout);
+    }
 
     if (framecount < 0)
     {
-        perror("dump978_read_frames");
+        perror("dump978_reader_next_batch");
         return 1;
     }
 
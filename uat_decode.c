@@ -21,6 +21,7 @@
 
 #include "uat.h"
 #include "uat_decode.h"
+#include "tables.h"
 #include "math.h" // For rounding and stuff.
 
 static void uat_decode_hdr(uint8_t *frame, struct uat_adsb_mdb *mdb)
@@ -54,11 +55,88 @@ static void uat_display_hdr(const struct uat_adsb_mdb *mdb, FILE *to)
 static double dimensions_widths[16] = {
     11.5, 23, 28.5, 34, 33, 38, 39.5, 45, 45, 52, 59.5, 67, 72.5, 80, 80, 90};
 
-static void uat_decode_sv(uint8_t *frame, struct uat_adsb_mdb *mdb)
+// Boundaries between rounded track angles: tan((k + 0.5) degrees) * 2^32,
+// rounded, for k = 0..44. A vector (x, y) with 0 <= y <= x, x > 0 is at an
+// angle that rounds to the number of these boundaries that y * 2^32 lies
+// beyond (x times the table entry). These are exact constants rather than
+// generated with the build machine's tan(); none of them is within 0.001
+// of a rounding tie.
+#define TRACK_BOUNDARIES (45)
+static const uint32_t track_tan_boundaries[TRACK_BOUNDARIES] = {
+    37481612, 112467677, 187522322, 262691453, 338021257, 413558313,
+    489349712, 565443172, 641887163, 718731033, 796025137, 873820972,
+    952171326, 1031130419, 1110754067, 1191099847, 1272227273, 1354197987,
+    1437075955, 1520927688, 1605822471, 1691832610, 1779033704, 1867504930,
+    1957329363, 2048594314, 2141391701, 2235818457, 2331976973, 2429975579,
+    2529929081, 2631959344, 2736195935, 2842776839, 2951849240, 3063570399,
+    3178108618, 3295644319, 3416371248, 3540497818, 3668248612, 3799866077,
+    3935612425, 4075771779, 4220652607u
+};
+
+// Number of track boundaries above that y / x lies beyond, i.e.
+// atan2(y, x) in degrees, rounded, for 0 <= y <= x, x > 0. There are no
+// ties to worry about: tan() of a half degree is irrational.
+static unsigned octant_degrees(uint32_t y, uint32_t x)
 {
-    uint32_t raw_lat, raw_lon, raw_alt;
+    uint64_t scaled = (uint64_t) y << 32;
+    unsigned k = 0, step;
 
-    mdb->has_sv = 1;
+    for (step = 32; step > 0; step >>= 1) {
+        if (k + step <= TRACK_BOUNDARIES && (uint64_t) track_tan_boundaries[k + step - 1] * x < scaled)
+            k += step;
+    }
+
+    return k;
+}
+
+// Track in whole degrees clockwise from north, as
+// round(450 - atan2(ns, ew) * 180 / pi) % 360, without the floating point
+static uint16_t track_from_velocity(int ns, int ew)
+{
+    unsigned a = (ns < 0 ? -ns : ns);
+    unsigned b = (ew < 0 ? -ew : ew);
+    unsigned r; // rounded angle from the north/south axis, 0..90
+
+    if (b <= a)
+        r = octant_degrees(b, a);
+    else
+        r = 90 - octant_degrees(a, b);
+
+    if (ns >= 0)
+        return (ew >= 0 ? r : (360 - r) % 360);
+    else
+        return (ew >= 0 ? 180 - r : 180 + r);
+}
+
+// round(sqrt(n)). There are no ties here either, since (r + 0.5)^2 is
+// never an integer
+static uint16_t isqrt_rounded(uint32_t n)
+{
+    uint32_t root = 0, bit = 1u << 30;
+
+    while (bit > n)
+        bit >>= 2;
+
+    while (bit) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    // n is now the remainder, n - root^2; round up past root + 0.5
+    return (n > root ? root + 1 : root);
+}
+
+// The SV element is decoded in three parts, so that uat_decode_adsb_mdb_fields()
+// can skip the ones it wasn't asked for
+
+static void uat_decode_sv_position(uint8_t *frame, struct uat_adsb_mdb *mdb)
+{
+    uint32_t raw_lat, raw_lon, raw_alt;
 
     mdb->nic = (frame[11] & 15);
 
@@ -83,6 +161,20 @@ static void uat_decode_sv(uint8_t *frame, struct uat_adsb_mdb *mdb)
         mdb->altitude = (raw_alt - 1) * 25 - 1000;
     }
 
+    if ((frame[0] & 7) == 2 || (frame[0] & 7) == 3)
+    {
+        mdb->utc_coupled = 0;
+        mdb->tisb_site_id = (frame[16] & 0x0f);
+    }
+    else
+    {
+        mdb->utc_coupled = (frame[16] & 0x08) ? 1 : 0;
+        mdb->tisb_site_id = 0;
+    }
+}
+
+static void uat_decode_sv_velocity(uint8_t *frame, struct uat_adsb_mdb *mdb)
+{
     mdb->airground_state = (frame[12] >> 6) & 0x03;
 
     switch (mdb->airground_state)
@@ -119,11 +211,11 @@ static void uat_decode_sv(uint8_t *frame, struct uat_adsb_mdb *mdb)
             if (mdb->ns_vel != 0 || mdb->ew_vel != 0)
             {
                 mdb->track_type = TT_TRACK;
-                mdb->track = (uint16_t)round((360.0 + 90.0 - atan2(mdb->ns_vel, mdb->ew_vel) * 180.0 / M_PI)) % 360;
+                mdb->track = track_from_velocity(mdb->ns_vel, mdb->ew_vel);
             }
 
             mdb->speed_valid = 1;
-            mdb->speed = (int)round(sqrt(mdb->ns_vel * mdb->ns_vel + mdb->ew_vel * mdb->ew_vel));
+            mdb->speed = isqrt_rounded(mdb->ns_vel * mdb->ns_vel + mdb->ew_vel * mdb->ew_vel);
         }
 
         raw_vvel = ((frame[15] & 0x7f) << 4) | ((frame[16] & 0xf0) >> 4);
@@ -164,11 +256,6 @@ static void uat_decode_sv(uint8_t *frame, struct uat_adsb_mdb *mdb)
 
         if (mdb->track_type != TT_INVALID)
             mdb->track = (raw_track & 0x1ff) * 360 / 512;
-
-        mdb->dimensions_valid = 1;
-        mdb->length = 15 + 10 * ((frame[15] & 0x38) >> 3);
-        mdb->width = dimensions_widths[(frame[15] & 0x78) >> 3];
-        mdb->position_offset = (frame[15] & 0x04) ? 1 : 0;
     }
     break;
 
@@ -176,17 +263,30 @@ static void uat_decode_sv(uint8_t *frame, struct uat_adsb_mdb *mdb)
         // nothing
         break;
     }
+}
 
-    if ((frame[0] & 7) == 2 || (frame[0] & 7) == 3)
-    {
-        mdb->utc_coupled = 0;
-        mdb->tisb_site_id = (frame[16] & 0x0f);
-    }
-    else
-    {
-        mdb->utc_coupled = (frame[16] & 0x08) ? 1 : 0;
-        mdb->tisb_site_id = 0;
-    }
+static void uat_decode_sv_dimensions(uint8_t *frame, struct uat_adsb_mdb *mdb)
+{
+    // only sent on the ground
+    if (((frame[12] >> 6) & 0x03) != AG_GROUND)
+        return;
+
+    mdb->dimensions_valid = 1;
+    mdb->length = 15 + 10 * ((frame[15] & 0x38) >> 3);
+    mdb->width = dimensions_widths[(frame[15] & 0x78) >> 3];
+    mdb->position_offset = (frame[15] & 0x04) ? 1 : 0;
+}
+
+static void uat_decode_sv(uint8_t *frame, struct uat_adsb_mdb *mdb, unsigned fields)
+{
+    mdb->has_sv = 1;
+
+    if (fields & UAT_DECODE_POSITION)
+        uat_decode_sv_position(frame, mdb);
+    if (fields & UAT_DECODE_VELOCITY)
+        uat_decode_sv_velocity(frame, mdb);
+    if (fields & UAT_DECODE_DIMENSIONS)
+        uat_decode_sv_dimensions(frame, mdb);
 }
 
 static void uat_display_sv(const struct uat_adsb_mdb *mdb, FILE *to)
@@ -287,26 +387,30 @@ static void uat_display_sv(const struct uat_adsb_mdb *mdb, FILE *to)
             mdb->tisb_site_id);
 }
 
-static char base40_alphabet[40] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ  ..";
+static char base40_alphabet[40] = BASE40_ALPHABET;
+
 static void uat_decode_ms(uint8_t *frame, struct uat_adsb_mdb *mdb)
 {
-    uint16_t v;
+    unsigned v, high;
     int i;
 
     mdb->has_ms = 1;
 
+    // each 16-bit value is three base 40 digits; the top digit can be 40
+    // in a corrupt message, which wraps around. base40_pairs[] gives the
+    // two low digits as characters without any more divisions
     v = (frame[17] << 8) | (frame[18]);
-    mdb->emitter_category = (v / 1600) % 40;
-    mdb->callsign[0] = base40_alphabet[(v / 40) % 40];
-    mdb->callsign[1] = base40_alphabet[v % 40];
+    high = v / 1600;
+    mdb->emitter_category = (high == 40 ? 0 : high);
+    memcpy(mdb->callsign + 0, base40_pairs[v - high * 1600], 2);
     v = (frame[19] << 8) | (frame[20]);
-    mdb->callsign[2] = base40_alphabet[(v / 1600) % 40];
-    mdb->callsign[3] = base40_alphabet[(v / 40) % 40];
-    mdb->callsign[4] = base40_alphabet[v % 40];
+    high = v / 1600;
+    mdb->callsign[2] = base40_alphabet[high == 40 ? 0 : high];
+    memcpy(mdb->callsign + 3, base40_pairs[v - high * 1600], 2);
     v = (frame[21] << 8) | (frame[22]);
-    mdb->callsign[5] = base40_alphabet[(v / 1600) % 40];
-    mdb->callsign[6] = base40_alphabet[(v / 40) % 40];
-    mdb->callsign[7] = base40_alphabet[v % 40];
+    high = v / 1600;
+    mdb->callsign[5] = base40_alphabet[high == 40 ? 0 : high];
+    memcpy(mdb->callsign + 6, base40_pairs[v - high * 1600], 2);
     mdb->callsign[8] = 0;
 
     // trim trailing spaces
@@ -464,11 +568,67 @@ static void uat_display_auxsv(const struct uat_adsb_mdb *mdb, FILE *to)
     }
 }
 
-void uat_decode_adsb_mdb(uint8_t *frame, struct uat_adsb_mdb *mdb)
+// Zero the presence bits, and the fields of the requested sections
+static void uat_clear_adsb_mdb(struct uat_adsb_mdb *mdb, unsigned fields)
 {
-    static struct uat_adsb_mdb mdb_zero;
+    mdb->has_sv = mdb->has_ms = mdb->has_auxsv = 0;
 
-    *mdb = mdb_zero;
+    if (fields & UAT_DECODE_POSITION)
+    {
+        mdb->position_valid = 0;
+        mdb->lat = mdb->lon = 0;
+        mdb->altitude_type = ALT_INVALID;
+        mdb->altitude = 0;
+        mdb->nic = 0;
+        mdb->utc_coupled = 0;
+        mdb->tisb_site_id = 0;
+    }
+
+    if (fields & UAT_DECODE_VELOCITY)
+    {
+        mdb->ns_vel_valid = mdb->ew_vel_valid = mdb->speed_valid = 0;
+        mdb->airground_state = AG_SUBSONIC;
+        mdb->ns_vel = mdb->ew_vel = 0;
+        mdb->track_type = TT_INVALID;
+        mdb->track = 0;
+        mdb->speed = 0;
+        mdb->vert_rate_source = ALT_INVALID;
+        mdb->vert_rate = 0;
+    }
+
+    if (fields & UAT_DECODE_DIMENSIONS)
+    {
+        mdb->dimensions_valid = 0;
+        mdb->length = mdb->width = 0;
+        mdb->position_offset = 0;
+    }
+
+    if (fields & UAT_DECODE_MS)
+    {
+        mdb->emitter_category = 0;
+        mdb->callsign_type = CS_INVALID;
+        memset(mdb->callsign, 0, sizeof(mdb->callsign));
+        mdb->emergency_status = mdb->uat_version = mdb->sil = mdb->transmit_mso = 0;
+        mdb->nac_p = mdb->nac_v = mdb->nic_baro = 0;
+        mdb->has_cdti = mdb->has_acas = mdb->acas_ra_active = mdb->ident_active = mdb->atc_services = 0;
+        mdb->heading_type = HT_INVALID;
+    }
+
+    if (fields & UAT_DECODE_AUXSV)
+    {
+        mdb->sec_altitude_type = ALT_INVALID;
+        mdb->sec_altitude = 0;
+    }
+}
+
+void uat_decode_adsb_mdb_fields(uint8_t *frame, struct uat_adsb_mdb *mdb, unsigned fields)
+{
+    unsigned sv_fields = fields & (UAT_DECODE_POSITION | UAT_DECODE_VELOCITY | UAT_DECODE_DIMENSIONS);
+
+    if ((fields & UAT_DECODE_ALL) == UAT_DECODE_ALL)
+        memset(mdb, 0, sizeof(*mdb));
+    else
+        uat_clear_adsb_mdb(mdb, fields);
 
     uat_decode_hdr(frame, mdb);
 
@@ -480,25 +640,33 @@ void uat_decode_adsb_mdb(uint8_t *frame, struct uat_adsb_mdb *mdb)
     case 8:  // HDR SV reserved
     case 9:  // HDR SV reserved
     case 10: // HDR SV reserved
-        uat_decode_sv(frame, mdb);
+        if (sv_fields)
+            uat_decode_sv(frame, mdb, fields);
         break;
 
     case 1: // HDR SV MS AUXSV
-        uat_decode_sv(frame, mdb);
-        uat_decode_ms(frame, mdb);
-        uat_decode_auxsv(frame, mdb);
+        if (sv_fields)
+            uat_decode_sv(frame, mdb, fields);
+        if (fields & UAT_DECODE_MS)
+            uat_decode_ms(frame, mdb);
+        if (fields & UAT_DECODE_AUXSV)
+            uat_decode_auxsv(frame, mdb);
         break;
 
     case 2: // HDR SV AUXSV
     case 5: // HDR SV (TC+1) AUXSV
     case 6: // HDR SV (TS) AUXSV
-        uat_decode_sv(frame, mdb);
-        uat_decode_auxsv(frame, mdb);
+        if (sv_fields)
+            uat_decode_sv(frame, mdb, fields);
+        if (fields & UAT_DECODE_AUXSV)
+            uat_decode_auxsv(frame, mdb);
         break;
 
     case 3: // HDR SV MS (TS)
-        uat_decode_sv(frame, mdb);
-        uat_decode_ms(frame, mdb);
+        if (sv_fields)
+            uat_decode_sv(frame, mdb, fields);
+        if (fields & UAT_DECODE_MS)
+            uat_decode_ms(frame, mdb);
         break;
 
     default:
@@ -506,6 +674,11 @@ void uat_decode_adsb_mdb(uint8_t *frame, struct uat_adsb_mdb *mdb)
     }
 }
 
+void uat_decode_adsb_mdb(uint8_t *frame, struct uat_adsb_mdb *mdb)
+{
+    uat_decode_adsb_mdb_fields(frame, mdb, UAT_DECODE_ALL);
+}
+
 void uat_display_adsb_mdb(const struct uat_adsb_mdb *mdb, FILE *to)
 {
     uat_display_hdr(mdb, to);
@@ -514,16 +687,38 @@ void uat_display_adsb_mdb(const struct uat_adsb_mdb *mdb, FILE *to)
     uat_display_auxsv(mdb, to);
 }
 
+// Length of the FIS-B APDU header of an info frame, or 0 if it is not
+// FIS-B (or is too short to be)
+static unsigned fisb_header_length(const struct uat_uplink_info_frame *frame)
+{
+    static const unsigned header_lengths[4] = { 4, 5, 5, 6 };
+    unsigned t_opt, len;
+
+    if (frame->type != 0)
+        return 0; // not FIS-B
+
+    if (frame->length < 4) // too short for FIS-B
+        return 0;
+
+    t_opt = ((frame->data[1] & 0x01) << 1) | (frame->data[2] >> 7);
+    len = header_lengths[t_opt];
+    return (frame->length < len ? 0 : len);
+}
+
+int uat_uplink_info_frame_product_id(const struct uat_uplink_info_frame *frame)
+{
+    if (!fisb_header_length(frame))
+        return -1;
+    return ((frame->data[0] & 0x1f) << 6) | (frame->data[1] >> 2);
+}
+
 static void uat_decode_info_frame(struct uat_uplink_info_frame *frame)
 {
     unsigned t_opt;
 
     frame->is_fisb = 0;
 
-    if (frame->type != 0)
-        return; // not FIS-B
-
-    if (frame->length < 4) // too short for FIS-B
+    if (!fisb_header_length(frame))
         return;
 
     t_opt = ((frame->data[1] & 0x01) << 1) | (frame->data[2] >> 7);
@@ -539,8 +734,6 @@ static void uat_decode_info_frame(struct uat_uplink_info_frame *frame)
         frame->fisb.data = frame->data + 4;
         break;
     case 1: // Hours, Minutes, Seconds
-        if (frame->length < 5)
-            return;
         frame->fisb.monthday_valid = 0;
         frame->fisb.seconds_valid = 1;
         frame->fisb.hours = (frame->data[2] & 0x7c) >> 2;
@@ -550,8 +743,6 @@ static void uat_decode_info_frame(struct uat_uplink_info_frame *frame)
         frame->fisb.data = frame->data + 5;
         break;
     case 2: // Month, Day, Hours, Minutes
-        if (frame->length < 5)
-            return;
         frame->fisb.monthday_valid = 1;
         frame->fisb.seconds_valid = 0;
         frame->fisb.month = (frame->data[2] & 0x78) >> 3;
@@ -562,8 +753,6 @@ static void uat_decode_info_frame(struct uat_uplink_info_frame *frame)
         frame->fisb.data = frame->data + 5;
         break;
     case 3: // Month, Day, Hours, Minutes, Seconds
-        if (frame->length < 6)
-            return;
         frame->fisb.monthday_valid = 1;
         frame->fisb.seconds_valid = 1;
         frame->fisb.month = (frame->data[2] & 0x78) >> 3;
@@ -584,6 +773,62 @@ static void uat_decode_info_frame(struct uat_uplink_info_frame *frame)
     frame->is_fisb = 1;
 }
 
+int uat_decode_info_frame_fisb(struct uat_uplink_info_frame *frame)
+{
+    uat_decode_info_frame(frame);
+    return frame->is_fisb;
+}
+
+static void uplink_iter_start(struct uat_uplink_iter *iter, uint8_t *app_data)
+{
+    iter->data = app_data;
+    iter->end = app_data + 424;
+    iter->count = 0;
+}
+
+int uat_uplink_iter_init(struct uat_uplink_iter *iter, uint8_t *frame)
+{
+    uplink_iter_start(iter, frame + 8);
+    if (!(frame[6] & 0x20))
+    {
+        // no application data
+        iter->data = iter->end;
+        return 0;
+    }
+
+    return 1;
+}
+
+int uat_uplink_iter_next(struct uat_uplink_iter *iter, struct uat_uplink_info_frame *frame)
+{
+    uint8_t *data = iter->data;
+
+    if (iter->count >= UPLINK_MAX_INFO_FRAMES || data + 2 > iter->end)
+        return 0;
+
+    frame->length = (data[0] << 1) | (data[1] >> 7);
+    frame->type = (data[1] & 0x0f);
+    if (data + frame->length + 2 > iter->end)
+    {
+        // overrun?
+        iter->data = iter->end;
+        return 0;
+    }
+
+    if (frame->length == 0 && frame->type == 0)
+    {
+        // no more frames
+        iter->data = iter->end;
+        return 0;
+    }
+
+    frame->is_fisb = 0;
+    frame->data = data + 2;
+    iter->data = data + frame->length + 2;
+    ++iter->count;
+    return 1;
+}
+
 void uat_decode_uplink_mdb(uint8_t *frame, struct uat_uplink_mdb *mdb)
 {
     mdb->position_valid = (frame[5] & 0x01) ? 1 : 0;
@@ -610,34 +855,15 @@ void uat_decode_uplink_mdb(uint8_t *frame, struct uat_uplink_mdb *mdb)
 
     if (mdb->app_data_valid)
     {
-        uint8_t *data, *end;
+        struct uat_uplink_iter iter;
 
         memcpy(mdb->app_data, frame + 8, 424);
         mdb->num_info_frames = 0;
 
-        data = mdb->app_data;
-        end = mdb->app_data + 424;
-        while (mdb->num_info_frames < UPLINK_MAX_INFO_FRAMES && data + 2 <= end)
+        uplink_iter_start(&iter, mdb->app_data);
+        while (uat_uplink_iter_next(&iter, &mdb->info_frames[mdb->num_info_frames]))
         {
-            struct uat_uplink_info_frame *frame = &mdb->info_frames[mdb->num_info_frames];
-            frame->length = (data[0] << 1) | (data[1] >> 7);
-            frame->type = (data[1] & 0x0f);
-            if (data + frame->length + 2 > end)
-            {
-                // overrun?
-                break;
-            }
-
-            if (frame->length == 0 && frame->type == 0)
-            {
-                break; // no more frames
-            }
-
-            frame->data = data + 2;
-
-            uat_decode_info_frame(frame);
-
-            data += frame->length + 2;
+            uat_decode_info_frame(&mdb->info_frames[mdb->num_info_frames]);
             ++mdb->num_info_frames;
         }
     }
@@ -678,11 +904,12 @@ static void display_generic_data(uint8_t *data, uint16_t length, FILE *to)
 static const char *dlac_alphabet = "\x03"
                                    "ABCDEFGHIJKLMNOPQRSTUVWXYZ\x1A\t\x1E\n| !\"#$%&'()*+,-./0123456789:;<=>?";
 
-static const char *decode_dlac(uint8_t *data, unsigned bytelen)
+// Decode DLAC text into 'buf' of 'bufsize' bytes, truncating if needed
+static const char *decode_dlac(uint8_t *data, unsigned bytelen, char *buf, size_t bufsize)
 {
-    static char buf[1024];
     uint8_t *end = data + bytelen;
     char *p = buf;
+    char *bufend = buf + bufsize - 1;
     int step = 0;
     int tab = 0;
 
@@ -712,7 +939,7 @@ static const char *decode_dlac(uint8_t *data, unsigned bytelen)
 
         if (tab)
         {
-            while (ch > 0)
+            while (ch > 0 && p < bufend)
                 *p++ = ' ', ch--;
             tab = 0;
         }
@@ -720,7 +947,7 @@ static const char *decode_dlac(uint8_t *data, unsigned bytelen)
         { // tab
             tab = 1;
         }
-        else
+        else if (p < bufend)
         {
             *p++ = dlac_alphabet[ch];
         }
@@ -970,7 +1197,8 @@ static void uat_display_fisb_frame(const struct fisb_apdu *apdu, FILE *to)
     case 413:
     {
         // Generic text, DLAC
-        const char *text = decode_dlac(apdu->data, apdu->length);
+        char text_buf[1024];
+        const char *text = decode_dlac(apdu->data, apdu->length, text_buf, sizeof(text_buf));
         const char *report = text;
 
         while (report)
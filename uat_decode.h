@@ -165,6 +165,23 @@ struct uat_adsb_mdb
 //
 
 void uat_decode_adsb_mdb(uint8_t *frame, struct uat_adsb_mdb *mdb);
+
+// Sections of a downlink message, for uat_decode_adsb_mdb_fields()
+#define UAT_DECODE_HDR        0x01 // mdb_type, address_qualifier, address (always decoded)
+#define UAT_DECODE_POSITION   0x02 // SV: position_valid, lat, lon, altitude, nic, utc_coupled, tisb_site_id
+#define UAT_DECODE_VELOCITY   0x04 // SV: airground_state, velocities, track, speed, vertical rate
+#define UAT_DECODE_DIMENSIONS 0x08 // SV: dimensions_valid, length, width, position_offset
+#define UAT_DECODE_MS         0x10 // MS: emitter category, callsign, status and capabilities
+#define UAT_DECODE_AUXSV      0x20 // AUXSV: secondary altitude
+#define UAT_DECODE_ALL        0x3f
+
+// As uat_decode_adsb_mdb(), but only decodes the sections in 'fields'
+// (UAT_DECODE_* bits), skipping the work for the rest. The fields of the
+// requested sections come out exactly as uat_decode_adsb_mdb() would set
+// them, and the rest are left as they were. has_sv, has_ms and has_auxsv
+// are only set for elements that are present and were (at least partly)
+// requested.
+void uat_decode_adsb_mdb_fields(uint8_t *frame, struct uat_adsb_mdb *mdb, unsigned fields);
 void uat_display_adsb_mdb(const struct uat_adsb_mdb *mdb, FILE *to);
 
 //
@@ -229,4 +246,37 @@ struct uat_uplink_mdb
 void uat_decode_uplink_mdb(uint8_t *frame, struct uat_uplink_mdb *mdb);
 void uat_display_uplink_mdb(const struct uat_uplink_mdb *mdb, FILE *to);
 
+// Iterating over the info frames of an uplink message in place, without
+// copying the application data or decoding every frame up front:
+//
+//   struct uat_uplink_iter iter;
+//   struct uat_uplink_info_frame info;
+//
+//   uat_uplink_iter_init(&iter, frame);
+//   while (uat_uplink_iter_next(&iter, &info)) {
+//       if (uat_uplink_info_frame_product_id(&info) == 63 && uat_decode_info_frame_fisb(&info))
+//           ... info.fisb ...
+//   }
+//
+// The info frames are the same ones uat_decode_uplink_mdb() finds; their
+// data points into 'frame', which must outlive them.
+struct uat_uplink_iter
+{
+    uint8_t *data;
+    uint8_t *end;
+    unsigned count;
+};
+
+// Start iterating over 'frame'; returns 0 (and an empty iterator) if the
+// message has no application data
+int uat_uplink_iter_init(struct uat_uplink_iter *iter, uint8_t *frame);
+// Fill in the length, type and data of the next info frame and return 1,
+// or return 0 at the end. is_fisb is cleared; the APDU is not decoded.
+int uat_uplink_iter_next(struct uat_uplink_iter *iter, struct uat_uplink_info_frame *frame);
+// The FIS-B product ID of an info frame, or -1 if it is not FIS-B
+int uat_uplink_info_frame_product_id(const struct uat_uplink_info_frame *frame);
+// Decode the FIS-B APDU header of an info frame into frame->fisb;
+// returns frame->is_fisb
+int uat_decode_info_frame_fisb(struct uat_uplink_info_frame *frame);
+
 #endif